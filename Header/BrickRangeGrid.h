@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "MinMaxOctree.h"
+
+namespace Nexus {
+
+	// The value range of every brick of the min/max octree, normalised like the volume texture, with a lookup
+	// from a continuous voxel position. Intensity projections use it to skip bricks: a MIP ray can jump over a
+	// brick whose maximum cannot beat the maximum found so far, a MinIP ray over a brick whose minimum is not
+	// below the current minimum. Octree bricks include the voxels on their far faces, so every trilinear sample
+	// taken inside a brick lies within its range.
+	class BrickRangeGrid {
+	public:
+		BrickRangeGrid() {}
+
+		// value_max 是上傳到 texture 時正規化用的最大值。
+		void Build(const MinMaxOctree& octree, glm::ivec3 resolution, float value_max);
+		void Clear();
+
+		bool IsEmpty() const { return this->Ranges.empty(); }
+		int GetBrickSize() const { return this->BrickSize; }
+		glm::ivec3 GetGridSize() const { return this->GridSize; }
+		// 每個 brick 的 (min, max)，順序與 octree 的 brick 相同（x 最快），可以直接上傳成 3D texture。
+		const std::vector<glm::vec2>& GetRanges() const { return this->Ranges; }
+		glm::vec2 GetRange(unsigned int brick) const { return this->Ranges[brick]; }
+		// 整個 volume 的範圍，光線已經找到這個最大（最小）值時就不必再前進。
+		glm::vec2 GetVolumeRange() const { return this->VolumeRange; }
+
+		// voxel 是 trilinear 取樣用的連續座標（與 GL_LINEAR 相同，0 是第一個 voxel 的中心），回傳 brick 在 grid 中的位置。
+		// 光線每跨過一個 brick 就查一次，放在 header 讓 ray caster 可以 inline。
+		glm::ivec3 GetBrick(glm::vec3 voxel) const {
+			// 與 trilinear 取樣相同：先 clamp 到 volume 內，cell 最多到倒數第二個 voxel。
+			voxel = glm::clamp(voxel, glm::vec3(0.0f), glm::vec3(this->Resolution - glm::ivec3(1)));
+			glm::ivec3 cell = glm::min(glm::ivec3(voxel), glm::max(this->Resolution - glm::ivec3(2), glm::ivec3(0)));
+			return glm::min(cell / this->BrickSize, this->GridSize - glm::ivec3(1));
+		}
+		unsigned int GetBrickIndex(glm::ivec3 brick) const {
+			return static_cast<unsigned int>((brick.z * this->GridSize.y + brick.y) * this->GridSize.x + brick.x);
+		}
+		// Brick 在 voxel 座標中的範圍 [box_min, box_max)，位於 volume 邊界的那一側延伸到無限遠，邊界外 clamp 的取樣也屬於它。
+		void GetBrickBounds(glm::ivec3 brick, glm::vec3& box_min, glm::vec3& box_max) const;
+
+	private:
+		int BrickSize = 8;
+		glm::ivec3 Resolution = glm::ivec3(0);
+		glm::ivec3 GridSize = glm::ivec3(0);
+		std::vector<glm::vec2> Ranges;
+		glm::vec2 VolumeRange = glm::vec2(0.0f);
+	};
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+namespace Nexus {
+
+	// Chunked level-of-detail iso-surface extraction for volumes that are too large to polygonise as a whole.
+	// The volume is split into chunks of ChunkSize^3 cells, every chunk is polygonised with a cell size of
+	// 2^level voxels where the level is chosen from its distance to the camera. Levels are balanced so that
+	// every chunk differs by at most one level from all of its 26 neighbours.
+	//
+	// Seams between levels are closed the way Transvoxel does it, with transition cells along the shared
+	// faces, but the cells live on the coarser side and are triangulated without the Transvoxel tables:
+	// a coarse cell touching a finer chunk takes the finer samples on that face (edge midpoints and face
+	// centres) and is contoured as a polyhedron. Every face of the polyhedron is contoured on its own,
+	// separating the samples above the iso value, the face segments are linked into closed loops and every
+	// loop is fanned into triangles. The finer side stays plain marching cubes, both sides build the points
+	// on the shared face from the same voxel pairs, so they are bit-identical and the seam has no cracks.
+	//
+	// Chunks are extracted on the thread pool and cached per (chunk, level, iso value, transition mask);
+	// only a bounded number of finished chunks is uploaded per frame, so the cost of a frame depends on the
+	// view and not on the size of the volume.
+	class ChunkedIsoSurface {
+	public:
+		ChunkedIsoSurface(const std::vector<float>& data, const std::vector<glm::vec3>& normals, glm::ivec3 resolution, glm::vec3 ratio, int chunk_size = 32, int max_level = 3);
+		~ChunkedIsoSurface();
+
+		ChunkedIsoSurface(const ChunkedIsoSurface&) = delete;
+		ChunkedIsoSurface& operator=(const ChunkedIsoSurface&) = delete;
+
+		void SetIsoValue(float iso_value) { this->IsoValue = iso_value; }
+		float GetIsoValue() const { return this->IsoValue; }
+
+		// 在這個距離（model space）以內使用完整解析度，之後距離每增加一倍就降一個 level。
+		void SetLevelDistance(float distance) { this->LevelDistance = std::max(distance, 0.000001f); }
+		float GetLevelDistance() const { return this->LevelDistance; }
+
+		// 每個 frame 最多上傳幾個抽取完成的 chunk 到 GPU。
+		void SetUploadBudget(unsigned int chunks_per_frame) { this->UploadBudget = std::max(chunks_per_frame, 1u); }
+		unsigned int GetUploadBudget() const { return this->UploadBudget; }
+
+		// 快取（CPU 與 GPU）的上限，超過時丟掉最久沒有被畫到的 chunk。
+		void SetCacheBudget(size_t bytes) { this->CacheBudget = bytes; }
+		size_t GetCacheBudget() const { return this->CacheBudget; }
+
+		// Call once per frame: selects the levels from the camera position, starts the extraction of missing
+		// chunks in the background and uploads the ones that have finished. Chunks whose new level is not
+		// ready yet keep drawing their previous mesh.
+		void Update(const glm::vec3& camera_position, const glm::mat4& model = glm::mat4(1.0f));
+		void Draw(Nexus::Shader* shader, glm::mat4 model = glm::mat4(1.0f));
+
+		// 依照目前相機位置選擇的 level，同步地在 CPU 上抽取整個表面（不會呼叫任何 OpenGL 函式），可以拿來輸出檔案。
+		void Extract(const glm::vec3& camera_position, const glm::mat4& model, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+		int GetChunkSize() const { return this->ChunkSize; }
+		int GetMaxLevel() const { return this->MaxLevel; }
+		unsigned int GetChunkCount() const { return (unsigned int)this->Chunks.size(); }
+		unsigned int GetActiveChunkCount() const { return this->ActiveChunkCount; }
+		unsigned int GetDrawnChunkCount() const { return this->DrawnChunkCount; }
+		unsigned int GetDrawnTriangleCount() const { return this->DrawnTriangleCount; }
+		unsigned int GetPendingJobCount() const { return (unsigned int)this->Pending.size(); }
+		unsigned int GetCachedChunkCount() const { return (unsigned int)this->Cache.size(); }
+		size_t GetCacheBytes() const { return this->CacheBytes; }
+
+	private:
+		struct ChunkKey {
+			unsigned int Chunk = 0;
+			int Level = 0;
+			float IsoValue = 0.0f;
+			// bit 0~5：六個面的鄰居比較細；bit 6~17：十二條邊上的其他 chunk 有比較細的。
+			uint32_t TransitionMask = 0;
+
+			bool operator==(const ChunkKey& other) const {
+				return this->Chunk == other.Chunk && this->Level == other.Level && this->IsoValue == other.IsoValue && this->TransitionMask == other.TransitionMask;
+			}
+		};
+
+		struct ChunkKeyHash {
+			size_t operator()(const ChunkKey& key) const;
+		};
+
+		struct ChunkGeometry {
+			std::vector<float> Vertices;
+			std::vector<unsigned int> Indices;
+		};
+
+		struct ChunkMesh {
+			GLuint VAO = 0;
+			GLuint VBO = 0;
+			GLuint EBO = 0;
+			unsigned int IndexCount = 0;
+			size_t Bytes = 0;
+			uint64_t LastUsedFrame = 0;
+		};
+
+		struct Chunk {
+			glm::ivec3 Origin = glm::ivec3(0);
+			glm::ivec3 Extent = glm::ivec3(0);
+			float MinValue = 0.0f;
+			float MaxValue = 0.0f;
+			float Distance = 0.0f;
+			int Level = 0;
+			bool HasDisplayed = false;
+			ChunkKey Displayed;
+		};
+
+		struct PendingJob {
+			ChunkKey Key;
+			std::future<ChunkGeometry> Result;
+		};
+
+		const std::vector<float>& Data;
+		const std::vector<glm::vec3>& Normals;
+		glm::ivec3 Resolution;
+		glm::vec3 Ratio;
+		int ChunkSize;
+		int MaxLevel;
+		glm::ivec3 ChunkCount = glm::ivec3(0);
+
+		float IsoValue = 80.0f;
+		float LevelDistance = 64.0f;
+		unsigned int UploadBudget = 8;
+		unsigned int MaxPendingJobs = 8;
+		size_t CacheBudget = static_cast<size_t>(256) << 20;
+		size_t CacheBytes = 0;
+		uint64_t Frame = 0;
+
+		std::vector<Chunk> Chunks;
+		std::unordered_map<ChunkKey, ChunkMesh, ChunkKeyHash> Cache;
+		std::vector<PendingJob> Pending;
+
+		unsigned int ActiveChunkCount = 0;
+		unsigned int DrawnChunkCount = 0;
+		unsigned int DrawnTriangleCount = 0;
+
+		unsigned int GetChunkIndex(int x, int y, int z) const { return static_cast<unsigned int>((z * this->ChunkCount.y + y) * this->ChunkCount.x + x); }
+		size_t GetVoxelIndex(glm::ivec3 voxel) const { return (static_cast<size_t>(voxel.z) * this->Resolution.y + voxel.y) * this->Resolution.x + voxel.x; }
+		bool IsInside(glm::ivec3 chunk) const { return chunk.x >= 0 && chunk.y >= 0 && chunk.z >= 0 && chunk.x < this->ChunkCount.x && chunk.y < this->ChunkCount.y && chunk.z < this->ChunkCount.z; }
+		bool IsActive(const Chunk& chunk) const { return chunk.MinValue <= this->IsoValue && chunk.MaxValue > this->IsoValue; }
+
+		void ComputeChunkRanges();
+		void SelectLevels(const glm::vec3& camera_position, const glm::mat4& model);
+		uint32_t GetTransitionMask(unsigned int index) const;
+		ChunkKey GetKey(unsigned int index) const;
+		bool IsPending(const ChunkKey& key) const;
+		void CollectFinishedJobs();
+		void Upload(const ChunkKey& key, const ChunkGeometry& geometry);
+		void EvictCache();
+		void Release(ChunkMesh& mesh);
+
+		ChunkGeometry ExtractChunk(glm::ivec3 origin, glm::ivec3 extent, int level, float iso_value, uint32_t transition_mask) const;
+	};
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+namespace Nexus {
+
+	struct ComponentFilterSettings {
+		// 三角形數量少於這個值的連通區塊會被丟掉，0 表示不限制。
+		unsigned int MinTriangles = 64;
+		// 只保留最大的幾個連通區塊，0 表示全部保留。
+		unsigned int KeepLargest = 0;
+	};
+
+	// Removes small disconnected pieces (noise blobs) from an extracted surface. Connectivity is found with a
+	// lock-free union-find over the vertices: every triangle unites its corners in parallel, roots always link
+	// to the smaller index so concurrent unions can never form a cycle. Components are measured in triangles
+	// and dropped when they are smaller than MinTriangles or not among the KeepLargest largest.
+	//
+	// Vertices are interleaved (position, normal), 6 floats per vertex. A triangle soup (empty index list) is
+	// connected through vertices at identical positions and stays a soup; an indexed mesh also loses the
+	// vertices that are no longer referenced.
+	class ComponentFilter {
+	public:
+		ComponentFilter(const ComponentFilterSettings& settings = ComponentFilterSettings()) : Settings(settings) {}
+
+		void Filter(std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+		unsigned int GetComponentCount() const { return this->ComponentCount; }
+		unsigned int GetKeptComponentCount() const { return this->KeptComponentCount; }
+		unsigned int GetRemovedTriangleCount() const { return this->RemovedTriangleCount; }
+
+	private:
+		ComponentFilterSettings Settings;
+		unsigned int ComponentCount = 0;
+		unsigned int KeptComponentCount = 0;
+		unsigned int RemovedTriangleCount = 0;
+
+		static unsigned int Find(std::vector<std::atomic<unsigned int>>& parent, unsigned int vertex);
+		static void Unite(std::vector<std::atomic<unsigned int>>& parent, unsigned int a, unsigned int b);
+	};
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Nexus {
+
+	// Classifies a block of voxels against one iso value before any cell is read. Every row of voxels along x
+	// is compared as a whole (four values per SSE compare when available) into a sign bitmask with one bit per
+	// voxel above the iso value. The marching cubes index of a whole row of cells is then assembled from the
+	// four mask rows around it (y and y + 1 in slices z and z + 1) with shifts, in the corner order of
+	// MarchingCubesTable. ORing and ANDing the masks shows at once whether a row or a slice of cells has no
+	// crossing, so those cells are skipped without touching the volume again.
+	class CubeClassifier {
+	public:
+		CubeClassifier() {}
+
+		// voxel_min 與 voxel_max 都包含在內，之後的 cell 座標都以 voxel_min 為原點。
+		void Classify(const std::vector<float>& data, glm::ivec3 resolution, glm::ivec3 voxel_min, glm::ivec3 voxel_max, float iso_value);
+
+		// 第 k 層 cell（介於 voxel slice k 與 k + 1 之間）是否可能有 cell 跨越 iso value。
+		bool IsSliceActive(int k) const;
+
+		// 組出第 (j, k) 列所有 cell 的 cube index（GetRowCellCount() 個），整列都沒有跨越 iso value 時回傳 false，cube_indices 不會被寫入。
+		bool GetCubeIndices(int j, int k, uint8_t* cube_indices) const;
+
+		int GetRowCellCount() const { return this->VoxelCount.x - 1; }
+
+		// 把一列 count 個數值與 iso value 比較，第 i 個數值大於 iso value 時設定 mask 的第 i 個 bit。
+		static void ClassifyRow(const float* values, unsigned int count, float iso_value, uint64_t* mask);
+
+	private:
+		enum SliceState : uint8_t {
+			SLICE_ANY_ABOVE = 1,
+			SLICE_ALL_ABOVE = 2
+		};
+
+		glm::ivec3 VoxelCount = glm::ivec3(0);
+		unsigned int WordsPerRow = 0;
+		std::vector<uint64_t> Masks;
+		std::vector<uint8_t> SliceStates;
+
+		const uint64_t* GetRow(int j, int k) const { return &this->Masks[(static_cast<size_t>(k) * this->VoxelCount.y + j) * this->WordsPerRow]; }
+	};
+}
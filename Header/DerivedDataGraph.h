@@ -0,0 +1,57 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Nexus {
+
+	// Dirty-flag dependency graph for data derived from a volume (gradients, histograms, spatial index,
+	// textures, ...). Every product is a node that knows which nodes it is computed from; Invalidate marks a
+	// node and everything downstream of it dirty, and Require recomputes only the dirty nodes the requested
+	// ones depend on. Nothing is computed until somebody asks for it.
+	//
+	// A node can only depend on nodes that were added before it, so the graph is acyclic and the node index
+	// is already a topological order. Require runs the dirty nodes in waves: all nodes whose inputs are up to
+	// date are computed at the same time on the ThreadPool, except nodes marked on_calling_thread (OpenGL
+	// uploads), which run afterwards on the thread that called Require.
+	class DerivedDataGraph {
+	public:
+		DerivedDataGraph() {}
+
+		// compute 為空的節點是資料來源（例如 RawData），只用來把 Invalidate 傳給下游。
+		unsigned int AddNode(const std::string& name, const std::vector<unsigned int>& dependencies, std::function<void()> compute, bool on_calling_thread = false);
+
+		// 標記 node 與所有依賴它的節點。
+		void Invalidate(unsigned int node);
+		void InvalidateAll();
+		// 只丟掉 node 本身的快取（例如上傳之後釋放的暫存資料），已經由它算出來的下游仍然有效。
+		void Discard(unsigned int node);
+
+		void Require(unsigned int node);
+		void Require(const std::vector<unsigned int>& nodes);
+
+		bool IsDirty(unsigned int node) const { return node < this->Nodes.size() && this->Nodes[node].IsDirty; }
+		unsigned int GetNodeCount() const { return (unsigned int)this->Nodes.size(); }
+		const std::string& GetName(unsigned int node) const { return this->Nodes[node].Name; }
+		unsigned int GetComputeCount(unsigned int node) const { return this->Nodes[node].ComputeCount; }
+		double GetSeconds(unsigned int node) const { return this->Nodes[node].Seconds; }
+
+	private:
+		struct Node {
+			std::string Name;
+			std::vector<unsigned int> Dependencies;
+			std::vector<unsigned int> Dependents;
+			std::function<void()> Compute;
+			bool OnCallingThread = false;
+			bool IsDirty = true;
+			unsigned int ComputeCount = 0;
+			// 最後一次計算花費的時間。
+			double Seconds = 0.0;
+		};
+
+		std::vector<Node> Nodes;
+
+		void Run(unsigned int node);
+	};
+}
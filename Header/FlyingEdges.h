@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Nexus {
+
+	// Flying Edges (Schroeder et al. 2015) iso-surface extraction. It runs in four passes over the rows of the volume:
+	//   1. classify the x-edges of every row and record where the row can intersect the surface (trim range),
+	//   2. walk the cells of every row of cells inside the trim range and count triangles and y/z-edge intersections,
+	//   3. prefix-sum the counts so every row knows exactly where its points and triangles go,
+	//   4. generate points and triangles directly into the final arrays.
+	// Every row writes to disjoint ranges, so passes 1, 2 and 4 run in parallel without any locking.
+	// Cells are triangulated with MarchingCubesTriangleTable, so the result matches IsoSurface::Polygonise
+	// triangle for triangle, except that points on shared edges are generated once and indexed.
+	class FlyingEdges {
+	public:
+		FlyingEdges(const std::vector<float>& data, const std::vector<glm::vec3>& normals, glm::ivec3 resolution, glm::vec3 ratio);
+
+		// 只抽取 [voxel_min, voxel_max]（包含兩端）這個範圍內的 cell，頂點座標仍然是整個 volume 的座標。
+		void SetRegion(glm::ivec3 voxel_min, glm::ivec3 voxel_max);
+
+		// Output vertices are interleaved (position, normal), 6 floats per vertex.
+		void Extract(float iso_value, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+	private:
+		struct RowMeta {
+			unsigned int XInts = 0;
+			unsigned int YInts = 0;
+			unsigned int ZInts = 0;
+			unsigned int PointOffset = 0;
+			// 此列 x-edge 與表面相交的範圍 [XMin, XMax)，沒有相交時 XMin = nx - 1, XMax = 0。
+			int XMin = 0;
+			int XMax = 0;
+		};
+
+		struct CellRowMeta {
+			int XMin = 0;
+			int XMax = 0;
+			unsigned int Triangles = 0;
+			unsigned int TriangleOffset = 0;
+		};
+
+		const std::vector<float>& Data;
+		const std::vector<glm::vec3>& Normals;
+		glm::ivec3 Resolution;
+		glm::vec3 Ratio;
+		// 實際處理的子區域，以下所有的列、cell 列都是相對於 Origin 的座標。
+		glm::ivec3 Origin = glm::ivec3(0);
+		glm::ivec3 Size;
+		float IsoValue = 0.0f;
+
+		std::vector<uint8_t> XCases;
+		std::vector<RowMeta> Rows;
+		std::vector<CellRowMeta> CellRows;
+		unsigned char TriangleCount[256];
+
+		unsigned int GetRowIndex(int y, int z) const { return static_cast<unsigned int>(z * this->Size.y + y); }
+		unsigned int GetCellRowIndex(int y, int z) const { return static_cast<unsigned int>(z * (this->Size.y - 1) + y); }
+		size_t GetVoxelIndex(int x, int y, int z) const { return (static_cast<size_t>(z + this->Origin.z) * this->Resolution.y + (y + this->Origin.y)) * this->Resolution.x + (x + this->Origin.x); }
+		const uint8_t* GetXCases(int y, int z) const { return this->XCases.data() + static_cast<size_t>(this->GetRowIndex(y, z)) * (this->Size.x - 1); }
+
+		void ClassifyXEdges(int y, int z);
+		void CountCellRow(int y, int z);
+		void GenerateCellRow(int y, int z, float* vertices, unsigned int* indices) const;
+		unsigned char GetCubeIndex(const uint8_t* row0, const uint8_t* row1, const uint8_t* row2, const uint8_t* row3, int x) const;
+		void GeneratePoint(glm::ivec3 a, glm::ivec3 b, float* vertex) const;
+	};
+}
@@ -2,12 +2,35 @@
 
 #include <glm/glm.hpp>
 #include "Shader.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
 
+#include "BrickRangeGrid.h"
+#include "Camera.h"
+#include "ChunkedIsoSurface.h"
+#include "ComponentFilter.h"
 #include "Cube.h"
+#include "DerivedDataGraph.h"
+#include "MarchingCubesTable.h"
+#include "MeshDecimator.h"
+#include "MinMaxOctree.h"
+#include "OccupancyGrid.h"
+#include "ProgressiveRenderer.h"
+#include "SoftwareRayCaster.h"
+#include "SpanSpaceIndex.h"
+#include "Texture2D.h"
+#include "TransferFunction2D.h"
+#include "VolumeSlicer.h"
+#include "VolumeTextureStreamer.h"
 
 namespace Nexus {
 
@@ -29,7 +52,49 @@ namespace Nexus {
 
 	enum RenderMode {
 		RENDER_MODE_ISO_SURFACE,
-		RENDER_MODE_RAY_CASTING
+		RENDER_MODE_RAY_CASTING,
+		// 沿著光線取最大值、最小值或平均值的灰階投影，與 ray casting 使用同一張 volume texture，不需要 transfer function。
+		RENDER_MODE_MAXIMUM_INTENSITY_PROJECTION,
+		RENDER_MODE_MINIMUM_INTENSITY_PROJECTION,
+		RENDER_MODE_AVERAGE_INTENSITY_PROJECTION
+	};
+
+	enum VolumeTextureFormat {
+		// 每個 voxel 16 bytes：(r, g, b) 是 gradient，a 是數值。
+		VOLUME_TEXTURE_FORMAT_RGBA32F,
+		// 只有數值（R8 或 R16），gradient 在 shader 中計算或放在另外一張低精度的 texture。
+		VOLUME_TEXTURE_FORMAT_SCALAR
+	};
+
+	enum ExtractionMethod {
+		EXTRACTION_METHOD_MARCHING_CUBES,
+		EXTRACTION_METHOD_FLYING_EDGES,
+		EXTRACTION_METHOD_SURFACE_NETS
+	};
+
+	// 由 RawData 衍生出來的資料，在 DerivedDataGraph 中的節點編號（加入的順序，相依的節點一定在前面）。
+	enum DerivedData {
+		// 來源：RawData 本身，改變之後 Invalidate 這個節點，所有衍生資料都會重新計算。
+		DERIVED_DATA_RAW_DATA,
+		// 數值的最大值，正規化 texture、histogram 與 occupancy 時使用。
+		DERIVED_DATA_VALUE_RANGE,
+		// GridNormals 與 GradientMagnitudes。
+		DERIVED_DATA_GRADIENTS,
+		// Min/max octree、span-space 索引與 occupancy grid 的 brick 範圍。
+		DERIVED_DATA_SPATIAL_INDEX,
+		DERIVED_DATA_ISO_VALUE_HISTOGRAM,
+		DERIVED_DATA_GRADIENT_HISTOGRAM,
+		DERIVED_DATA_GRADIENT_HEATMAP,
+		// RGBA32F 格式上傳用的 TextureData。
+		DERIVED_DATA_TEXTURE_DATA,
+		// GPU 上的 volume texture（與 gradient texture），只會在 OpenGL 的執行緒上更新。
+		DERIVED_DATA_VOLUME_TEXTURE,
+		// 以 VALUE_RANGE 正規化的每個 brick 的 (min, max)，MIP / MinIP 用來跳過 brick。
+		DERIVED_DATA_BRICK_RANGES,
+		// BrickRanges 的 RG32F texture，只會在 OpenGL 的執行緒上更新。
+		DERIVED_DATA_BRICK_RANGE_TEXTURE,
+		// Slice viewer 用的 VolumeSlicer（指向 RawData 與快取的 x slab）。
+		DERIVED_DATA_SLICER
 	};
 
 	struct IsoSurfaceAttributes {
@@ -49,15 +114,88 @@ namespace Nexus {
 		std::vector<Voxel> vertices;
 	};
 
+	// 抽取 iso surface 時的輸出緩衝區，平行化時每個工作各自擁有一份，最後再依序合併。
+	struct PolygonBuffer {
+		std::vector<float> Vertices;
+		std::vector<float> Position;
+		std::vector<float> Normal;
+
+		void AddPosition(float x, float y, float z);
+		void AddPosition(glm::vec3 position);
+		void AddNormal(float nx, float ny, float nz);
+		void AddNormal(glm::vec3 normal);
+		void Append(const PolygonBuffer& other);
+	};
+
+	// 壓縮後的頂點格式（12 bytes）：位置以 16-bit 定點數記錄在 volume 範圍內的比例，法向量以 GL_INT_2_10_10_10_REV 打包。
+	struct PackedVertex {
+		uint16_t Position[3];
+		uint16_t Padding;
+		uint32_t Normal;
+	};
+
+	// 同一個 volume 上的其中一層 iso surface，所有圖層共用同一份 vertex buffer，各自記錄自己的繪製範圍。
+	struct IsoSurfaceLayer {
+		float IsoValue = 80.0f;
+		bool Visible = true;
+
+		unsigned int FirstVertex = 0;
+		unsigned int VertexCount = 0;
+		unsigned int FirstIndex = 0;
+		unsigned int IndexCount = 0;
+	};
+
+	// 抽取範圍：一個軸對齊的 clip box 加上任意數量的 clip plane，座標與頂點相同（voxel 座標乘上 Ratio）。
+	// Plane 以 (normal, d) 表示，保留 dot(normal, p) + d >= 0 的一側。Clip box 以整個 cell 為單位限制走訪的範圍；
+	// clip plane 對所有抽取方法都以三角形為單位：bounding box 完全在某個 plane 外側的三角形被丟掉，不會把三角形切開。
+	struct ClipRegion {
+		bool EnableBox = false;
+		glm::vec3 BoxMin = glm::vec3(0.0f);
+		glm::vec3 BoxMax = glm::vec3(0.0f);
+		std::vector<glm::vec4> Planes;
+
+		bool IsEmpty() const {
+			return !this->EnableBox && this->Planes.empty();
+		}
+	};
+
+	// GPU 上的一組 iso surface buffer。容量只會成長，重新抽取時沿用同一組 buffer，以 glBufferSubData 更新內容。
+	struct SurfaceBuffer {
+		GLuint VAO = 0;
+		GLuint VBO = 0;
+		GLuint EBO = 0;
+		size_t VertexCapacity = 0;
+		size_t IndexCapacity = 0;
+		// 內容是否為 PackedVertex，VAO 的格式與 Draw 的 model matrix 都依照這個值，不看目前的設定。
+		bool IsCompressed = false;
+	};
+
+	// Progressive 模式下背景工作抽取完成的一個 slab（沿 z 軸一層 brick 的厚度），index 已經加上前面 slab 的頂點數量。
+	struct ProgressiveSlab {
+		std::vector<float> Vertices;
+		std::vector<PackedVertex> Packed;
+		std::vector<unsigned int> Indices;
+		// 抽取時的頂點格式，為 true 時上傳 Packed。
+		bool IsCompressed = false;
+	};
+
 	class IsoSurface {
 	public:
-		IsoSurface() {};
+		IsoSurface() {
+			this->BuildDerivedDataGraph();
+		};
 		IsoSurface(const std::string& info_path, const std::string& raw_path, float max_gradient = 1.0f);
 		
 		void Draw(Nexus::Shader* shader, glm::mat4 model = glm::mat4(1.0f));
 		void Debug();
 		
-		~IsoSurface() {}
+		~IsoSurface() {
+			this->StopProgressiveExtraction();
+			this->ReleaseGraphicsResources();
+		}
+
+		IsoSurface(const IsoSurface&) = delete;
+		IsoSurface& operator=(const IsoSurface&) = delete;
 
 		bool GetIsInitialize() const {
 			return this->IsInitialize;
@@ -83,24 +221,385 @@ namespace Nexus {
 			this->CurrentRenderMode = render_mode;
 		}
 
+		// Ray casting 使用的 volume texture 格式，下一次 ConvertToPolygon 時生效。
+		void SetVolumeTextureFormat(int format) {
+			if (format != this->CurrentVolumeTextureFormat) {
+				this->CurrentVolumeTextureFormat = format;
+				this->DerivedData.Invalidate(DERIVED_DATA_VOLUME_TEXTURE);
+			}
+		}
+
+		int GetVolumeTextureFormat() const {
+			return this->CurrentVolumeTextureFormat;
+		}
+
+		// 單通道格式時，另外上傳一張 RGB8_SNORM 的 gradient 方向 texture，shader 不需要再取樣六個鄰居。
+		void SetGradientTexture(bool enable) {
+			if (enable != this->EnableGradientTexture) {
+				this->EnableGradientTexture = enable;
+				this->DerivedData.Invalidate(DERIVED_DATA_VOLUME_TEXTURE);
+			}
+		}
+
+		bool GetGradientTextureEnabled() const {
+			return this->EnableGradientTexture;
+		}
+
+		// 開啟後 volume texture 以 brick 為單位經由 PBO 上傳，每個 frame 最多花 budget 毫秒，ConvertToPolygon 不會卡住。
+		void SetStreamingUpload(bool enable, float budget_milliseconds = 4.0f) {
+			if (enable != this->EnableStreamingUpload) {
+				this->EnableStreamingUpload = enable;
+				this->DerivedData.Invalidate(DERIVED_DATA_VOLUME_TEXTURE);
+			}
+			this->VolumeStreamer.SetBudget(budget_milliseconds);
+		}
+
+		bool GetStreamingUpload() const {
+			return this->EnableStreamingUpload;
+		}
+
+		bool GetIsStreamingVolume() const {
+			return this->VolumeStreamer.GetIsStreaming();
+		}
+
+		float GetStreamingProgress() const {
+			return this->VolumeStreamer.GetProgress();
+		}
+
+		// Slice viewer 的 window/level，下一次 UpdateSlice 時生效。
+		void SetSliceWindowLevel(const SliceWindowLevel& window_level) {
+			this->SliceWindow = window_level;
+			for (int& index : this->SliceIndices) {
+				index = -1;
+			}
+		}
+
+		const SliceWindowLevel& GetSliceWindowLevel() const {
+			return this->SliceWindow;
+		}
+
+		SoftwareRayCasterSettings& GetSoftwareRayCasterSettings() {
+			return this->SoftwareRayCasting;
+		}
+
+		// Ray casting 時以 brick 為單位跳過 transfer function 中完全透明的區域。
+		void SetEmptySpaceSkipping(bool enable) {
+			this->EnableEmptySpaceSkipping = enable;
+		}
+
+		bool GetEmptySpaceSkipping() const {
+			return this->EnableEmptySpaceSkipping;
+		}
+
+		// Transfer function 改變時呼叫（RGBA，每個 bin 4 個 float），只重新計算受影響的 brick，需要在 OpenGL 的執行緒上呼叫。
+		void SetTransferFunction(const std::vector<float>& transfer_function) {
+			this->TransferFunction = transfer_function;
+			if (this->EnableEmptySpaceSkipping && this->IsReadyToDraw && this->CurrentRenderMode == RENDER_MODE_RAY_CASTING) {
+				this->UpdateOccupancy();
+			}
+			if (this->EnablePreIntegration) {
+				this->UpdatePreIntegration();
+			}
+			this->ProgressiveRendering.Invalidate();
+		}
+
+		// 以前後兩個樣本查 pre-integration 表格，step_size（voxel）必須與 shader 的取樣間距相同。
+		void SetPreIntegration(bool enable, float step_size = 1.0f) {
+			this->EnablePreIntegration = enable;
+			this->PreIntegrationStepSize = step_size;
+			if (enable) {
+				this->UpdatePreIntegration();
+			}
+			this->ProgressiveRendering.Invalidate();
+		}
+
+		bool GetPreIntegration() const {
+			return this->EnablePreIntegration;
+		}
+
+		// 以（數值, gradient 長度）的 2D transfer function 分類，取代 1D transfer function。單通道的 volume texture
+		// 會多一個 gradient 長度的分量（RG8 / RG16），所以 ray casting 已經準備好時會重新上傳。
+		void SetTransferFunction2D(bool enable) {
+			if (enable == this->EnableTransferFunction2D) {
+				return;
+			}
+			this->EnableTransferFunction2D = enable;
+			// 單通道格式的第二個分量是 gradient 長度，texture 的格式跟著改變。
+			if (this->CurrentVolumeTextureFormat == VOLUME_TEXTURE_FORMAT_SCALAR) {
+				this->DerivedData.Invalidate(DERIVED_DATA_VOLUME_TEXTURE);
+			}
+			if (this->IsReadyToDraw && this->CurrentRenderMode == RENDER_MODE_RAY_CASTING) {
+				this->DerivedData.Require(DERIVED_DATA_VOLUME_TEXTURE);
+				if (enable) {
+					this->TransferFunction2DTable.Update();
+					this->UploadTransferFunction2D();
+				}
+				if (this->EnableEmptySpaceSkipping) {
+					this->UpdateOccupancy();
+				}
+			}
+			this->ProgressiveRendering.Invalidate();
+		}
+
+		bool GetTransferFunction2DEnabled() const {
+			return this->EnableTransferFunction2D;
+		}
+
+		// 修改 region 之後呼叫 UpdateTransferFunction2D 重新產生表格並上傳。
+		TransferFunction2D& GetTransferFunction2D() {
+			return this->TransferFunction2DTable;
+		}
+
+		// 需要在 OpenGL 的執行緒上呼叫。
+		void UpdateTransferFunction2D();
+		// Gradient heatmap 上的格子（GetGradientHeatmap 的 x、y）換算成 2D transfer function 的正規化座標。
+		glm::vec2 GetTransferFunction2DCoordinate(unsigned int heatmap_x, unsigned int heatmap_y);
+
+		// 相機移動時以較低的解析度與較大的取樣間距 ray casting，靜止之後逐步累積到完整的品質。
+		// composite_shader 把 offscreen 的結果畫回原本的 framebuffer，沒有指定時維持一般的繪製。
+		void SetProgressiveRendering(bool enable, Nexus::Shader* composite_shader = nullptr) {
+			this->EnableProgressiveRendering = enable;
+			if (composite_shader != nullptr) {
+				this->ProgressiveCompositeShader = composite_shader;
+			}
+			this->ProgressiveRendering.Invalidate();
+		}
+
+		bool GetProgressiveRendering() const {
+			return this->EnableProgressiveRendering;
+		}
+
+		ProgressiveRenderSettings& GetProgressiveRenderSettings() {
+			return this->ProgressiveRendering.GetSettings();
+		}
+
+		const ProgressiveRenderer& GetProgressiveRenderer() const {
+			return this->ProgressiveRendering;
+		}
+
 		void SetIsoValue(float iso_value) {
 			this->IsoValue = iso_value;
 		}
+
+		// 加入多個 iso value 後，ConvertToPolygon 會在同一次走訪中抽取所有圖層；沒有圖層時只使用 IsoValue。
+		unsigned int AddLayer(float iso_value) {
+			IsoSurfaceLayer layer;
+			layer.IsoValue = iso_value;
+			this->Layers.push_back(layer);
+			return (unsigned int)this->Layers.size() - 1;
+		}
+
+		void RemoveLayer(unsigned int index) {
+			if (index < this->Layers.size()) {
+				this->Layers.erase(this->Layers.begin() + index);
+			}
+		}
+
+		void ClearLayers() {
+			this->Layers.clear();
+		}
+
+		void SetLayerVisible(unsigned int index, bool visible) {
+			if (index < this->Layers.size()) {
+				this->Layers[index].Visible = visible;
+			}
+		}
+
+		std::vector<IsoSurfaceLayer>& GetLayers() {
+			return this->Layers;
+		}
+
+		void SetExtractionMethod(int extraction_method) {
+			this->CurrentExtractionMethod = extraction_method;
+		}
+
+		void SetMultiThreading(bool enable) {
+			this->EnableMultiThreading = enable;
+		}
+
+		bool GetMultiThreading() const {
+			return this->EnableMultiThreading;
+		}
+
+		// 背景抽取中的 slab 是以舊的格式產生的，先停下來再改。
+		void SetCompressedVertices(bool enable) {
+			if (enable != this->EnableCompressedVertices) {
+				this->StopProgressiveExtraction();
+				this->EnableCompressedVertices = enable;
+			}
+		}
+
+		bool GetCompressedVertices() const {
+			return this->EnableCompressedVertices;
+		}
+
+		// 上傳到 GPU 之後是否保留 CPU 端的頂點資料，不保留時只會記錄數量。
+		void SetKeepHostCopies(bool enable) {
+			this->EnableHostCopies = enable;
+		}
+
+		bool GetKeepHostCopies() const {
+			return this->EnableHostCopies;
+		}
+
+		void SetDecimation(bool enable) {
+			this->EnableDecimation = enable;
+		}
+
+		bool GetDecimation() const {
+			return this->EnableDecimation;
+		}
+
+		void SetDecimationSettings(const DecimationSettings& settings) {
+			this->Decimation = settings;
+		}
+
+		DecimationSettings& GetDecimationSettings() {
+			return this->Decimation;
+		}
+
+		// 抽取之後、上傳之前移除雜訊造成的小碎片，每一層分開計算。
+		void SetComponentFilter(bool enable) {
+			this->EnableComponentFilter = enable;
+		}
+
+		bool GetComponentFilter() const {
+			return this->EnableComponentFilter;
+		}
+
+		void SetComponentFilterSettings(const ComponentFilterSettings& settings) {
+			this->ComponentFiltering = settings;
+		}
+
+		ComponentFilterSettings& GetComponentFilterSettings() {
+			return this->ComponentFiltering;
+		}
+
+		// 上傳前重新排列三角形與頂點的順序（Tipsify），三角形湯會先焊接成 indexed mesh。
+		void SetMeshOptimization(bool enable) {
+			this->EnableMeshOptimization = enable;
+		}
+
+		bool GetMeshOptimization() const {
+			return this->EnableMeshOptimization;
+		}
+
+		// 開啟後 ConvertToPolygon 不再一次抽取整個表面，而是交給 ChunkedIsoSurface 依相機距離分塊、分 level 抽取，
+		// 每個 frame 需要呼叫 UpdateChunks。
+		void SetChunkedLevelOfDetail(bool enable) {
+			this->EnableChunkedLevelOfDetail = enable;
+		}
+
+		bool GetChunkedLevelOfDetail() const {
+			return this->EnableChunkedLevelOfDetail;
+		}
+
+		ChunkedIsoSurface* GetChunkedSurface() {
+			return this->Chunks.get();
+		}
 		
+		// 開啟後 ConvertToPolygon 會立刻返回，表面在背景中一個 slab 一個 slab 地抽取，Draw 每個 frame 把完成的部分
+		// 附加到 GPU buffer 的尾端（最多 ProgressiveUploadBudget bytes），表面會由下往上逐漸出現。只使用 IsoValue，不支援圖層與簡化。
+		void SetProgressiveExtraction(bool enable) {
+			this->EnableProgressive = enable;
+		}
+
+		bool GetProgressiveExtraction() const {
+			return this->EnableProgressive;
+		}
+
+		void SetProgressiveUploadBudget(unsigned int bytes_per_frame) {
+			this->ProgressiveUploadBudget = std::max(bytes_per_frame, 1u);
+		}
+
+		unsigned int GetProgressiveUploadBudget() const {
+			return this->ProgressiveUploadBudget;
+		}
+
+		bool GetIsExtracting() const {
+			return this->ProgressiveActive;
+		}
+
+		// 背景抽取完成的 slab 比例（0 ~ 1），還沒上傳的部分不算在內。
+		float GetProgressiveProgress() const {
+			return this->ProgressiveSlabCount == 0 ? 1.0f : (float)this->ProgressiveSlabsExtracted / (float)this->ProgressiveSlabCount;
+		}
+
+		// Clip 會被背景抽取讀取，修改之前都要先停下來。
+		void SetClipBox(glm::vec3 box_min, glm::vec3 box_max) {
+			this->StopProgressiveExtraction();
+			this->Clip.EnableBox = true;
+			this->Clip.BoxMin = glm::min(box_min, box_max);
+			this->Clip.BoxMax = glm::max(box_min, box_max);
+		}
+
+		void ClearClipBox() {
+			this->StopProgressiveExtraction();
+			this->Clip.EnableBox = false;
+		}
+
+		unsigned int AddClipPlane(glm::vec4 plane) {
+			this->StopProgressiveExtraction();
+			this->Clip.Planes.push_back(plane);
+			return (unsigned int)this->Clip.Planes.size() - 1;
+		}
+
+		void ClearClipPlanes() {
+			this->StopProgressiveExtraction();
+			this->Clip.Planes.clear();
+		}
+
+		void SetClipRegion(const ClipRegion& clip_region) {
+			this->StopProgressiveExtraction();
+			this->Clip = clip_region;
+		}
+
+		const ClipRegion& GetClipRegion() const {
+			return this->Clip;
+		}
+
 		bool* WireFrameModeHelper() {
 			return &this->EnableWireFrameMode;
 		}
 
 		void Initialize(const std::string& info_path, const std::string& raw_path, float max_gradient = 1.0f);
 		void ConvertToPolygon();
+		// 只抽取 clip_region 內的表面，之後的 ConvertToPolygon 也會沿用這個範圍。
+		void ConvertToPolygon(const ClipRegion& clip_region);
+		void UpdateChunks(const Camera& camera, glm::mat4 model = glm::mat4(1.0f));
+		// 每個 frame 在 Draw 之前呼叫，矩陣改變時 progressive rendering 回到互動的解析度。
+		void UpdateProgressiveRendering(const glm::mat4& view, const glm::mat4& projection, glm::mat4 model = glm::mat4(1.0f));
+		// 只在 CPU 上抽取（與簡化）iso surface，不會呼叫任何 OpenGL 函式，可以在沒有視窗的批次處理中使用。
+		void ExtractSurface();
+		// 依照副檔名（.ply / .stl / .obj）輸出目前的網格，需要保留 CPU 端的頂點資料。
+		bool ExportMesh(const std::string& path) const;
+		// 在 CPU 上以 SetTransferFunction 設定的 transfer function 做 ray casting，輸出 RGBA8 的影像，不需要 OpenGL。
+		bool RenderSoftware(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, int width, int height, std::vector<uint8_t>& image);
+		// 把 axis（SliceAxis）方向上第 index 張 slice 更新到這個方向的 R8 texture，需要在 OpenGL 的執行緒上呼叫。
+		// 同一張 slice 已經在 texture 中時不會重新抽取；大小不變時以 glTexSubImage2D 上傳。
+		Texture2D* UpdateSlice(int axis, int index);
+		Texture2D* GetSliceTexture(int axis) const { return axis >= SLICE_AXIS_X && axis <= SLICE_AXIS_Z ? this->SliceTextures[axis].get() : nullptr; }
+		int GetSliceCount(int axis) const { return axis >= SLICE_AXIS_X && axis <= SLICE_AXIS_Z ? (int)this->Attributes.Resolution[axis] : 0; }
+		const VolumeSlicer& GetSlicer() const { return this->Slicer; }
 
+		// 由 DerivedDataGraph 在需要時呼叫，直接呼叫前 RawData 的最大值與 gradient 必須已經是最新的；一般請使用 GetIsoValueHistogram 等函式。
 		void GenerateIsoValueHistogram();
 		void GenerateGradientHistogram();
 		void GenerateGradientHeatMap();
 		void IsoValueHistogramEqualization();
 
 		float Interval = 256.0f;
+		// 衍生資料只在需要時才計算（例如第一次取得 histogram、切換到 ray casting），GetComputeCount 可以看出重新計算了幾次。
+		const DerivedDataGraph& GetDerivedData() const { return this->DerivedData; }
 		GLuint GetVolumeTexture() const { return this->VolumeTexture; }
+		GLuint GetGradientTexture() const { return this->GradientTexture; }
+		GLuint GetOccupancyTexture() const { return this->OccupancyTexture; }
+		GLuint GetPreIntegrationTexture() const { return this->PreIntegrationTexture; }
+		GLuint GetProjectionBrickTexture() const { return this->ProjectionBrickTexture; }
+		const BrickRangeGrid& GetProjectionBricks() const { return this->ProjectionBricks; }
+		const PreIntegrationTable& GetPreIntegrationTable() const { return this->PreIntegration; }
+		double GetSoftwareSamplesPerSecond() const { return this->SoftwareSamplesPerSecond; }
+		size_t GetVolumeTextureBytes() const { return this->VolumeTextureBytes; }
 		std::vector<float> GetIsoValueHistogram();
 		std::vector<float> GetGradientHistogram();
 		std::vector<float> GetGradientHeatmap();
@@ -123,307 +622,60 @@ namespace Nexus {
         }
 		std::string GetEndian() const { return this->Attributes.Endian; }
 		int GetCurrentRenderMode() const { return this->CurrentRenderMode; }
+		// 除了 iso surface 以外的模式都是畫 bounding box 並在 shader 中 ray casting。
+		bool GetIsVolumeRendering() const { return this->CurrentRenderMode != RENDER_MODE_ISO_SURFACE; }
+		// 目前的 render mode 對應的 IntensityProjection，一般的 ray casting 與 iso surface 是 NONE。
+		int GetIntensityProjection() const {
+			if (this->CurrentRenderMode == RENDER_MODE_MAXIMUM_INTENSITY_PROJECTION) {
+				return INTENSITY_PROJECTION_MAXIMUM;
+			} else if (this->CurrentRenderMode == RENDER_MODE_MINIMUM_INTENSITY_PROJECTION) {
+				return INTENSITY_PROJECTION_MINIMUM;
+			} else if (this->CurrentRenderMode == RENDER_MODE_AVERAGE_INTENSITY_PROJECTION) {
+				return INTENSITY_PROJECTION_AVERAGE;
+			}
+			return INTENSITY_PROJECTION_NONE;
+		}
+		std::string GetRenderModeName() const {
+			if (this->CurrentRenderMode == RENDER_MODE_RAY_CASTING) {
+				return std::string("Ray Casting");
+			} else if (this->CurrentRenderMode == RENDER_MODE_MAXIMUM_INTENSITY_PROJECTION) {
+				return std::string("Maximum Intensity Projection");
+			} else if (this->CurrentRenderMode == RENDER_MODE_MINIMUM_INTENSITY_PROJECTION) {
+				return std::string("Minimum Intensity Projection");
+			} else if (this->CurrentRenderMode == RENDER_MODE_AVERAGE_INTENSITY_PROJECTION) {
+				return std::string("Average Intensity Projection");
+			}
+			return std::string("Iso Surface");
+		}
+		int GetCurrentExtractionMethod() const { return this->CurrentExtractionMethod; }
+		std::string GetExtractionMethodName() const {
+			if (this->CurrentExtractionMethod == EXTRACTION_METHOD_FLYING_EDGES) {
+				return std::string("Flying Edges");
+			} else if (this->CurrentExtractionMethod == EXTRACTION_METHOD_SURFACE_NETS) {
+				return std::string("Surface Nets");
+			}
+			return std::string("March Cube Method");
+		}
 		unsigned int GetVoxelCount() const{ return (unsigned int)this->RawData.size(); }
-		unsigned int GetTriangleCount() const{ return (unsigned int)this->Vertices.size() / 3; }
-		unsigned int GetVertexCount() const { return (unsigned int)this->Vertices.size(); }
-		unsigned int GetPositionCount() const { return (unsigned int)this->Position.size(); }
-		unsigned int GetNormalCount() const { return (unsigned int)this->Normal.size(); }
+		unsigned int GetTriangleCount() const{ return this->GetIndexCount() == 0 ? this->GetVertexCount() / 3 : this->GetIndexCount() / 3; }
+		unsigned int GetVertexCount() const { return this->Vertices.empty() ? this->VertexCount : (unsigned int)this->Vertices.size() / 6; }
+		unsigned int GetPositionCount() const { return (unsigned int)this->Position.size() / 3; }
+		unsigned int GetNormalCount() const { return (unsigned int)this->Normal.size() / 3; }
+		unsigned int GetIndexCount() const { return this->Indices.empty() ? this->IndexCount : (unsigned int)this->Indices.size(); }
+		const std::vector<float>& GetVertices() const { return this->Vertices; }
+		const std::vector<unsigned int>& GetIndices() const { return this->Indices; }
+		unsigned int GetVertexBufferSize() const { return this->VertexBufferSize; }
+		double GetExtractionSeconds() const { return this->ExtractionSeconds.count(); }
+		double GetDecimationSeconds() const { return this->DecimationSeconds.count(); }
+		unsigned int GetExtractedTriangleCount() const { return this->ExtractedTriangleCount; }
+		unsigned int GetRemovedComponentCount() const { return this->RemovedComponentCount; }
+		float GetACMRBefore() const { return this->ACMRBefore; }
+		float GetACMRAfter() const { return this->ACMRAfter; }
 		float GetIsoValue() const { return this->IsoValue; }
+		unsigned int GetBrickCount() const { return this->Octree.GetBrickCount(); }
+		unsigned int GetActiveBrickCount() const { return (unsigned int)this->ActiveBricks.size(); }
 		
 	protected:
-		const std::vector<unsigned short> EdgeTable = {
-			0x0  , 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
-			0x80c, 0x905, 0xa0f, 0xb06, 0xc0a, 0xd03, 0xe09, 0xf00,
-			0x190, 0x99 , 0x393, 0x29a, 0x596, 0x49f, 0x795, 0x69c,
-			0x99c, 0x895, 0xb9f, 0xa96, 0xd9a, 0xc93, 0xf99, 0xe90,
-			0x230, 0x339, 0x33 , 0x13a, 0x636, 0x73f, 0x435, 0x53c,
-			0xa3c, 0xb35, 0x83f, 0x936, 0xe3a, 0xf33, 0xc39, 0xd30,
-			0x3a0, 0x2a9, 0x1a3, 0xaa , 0x7a6, 0x6af, 0x5a5, 0x4ac,
-			0xbac, 0xaa5, 0x9af, 0x8a6, 0xfaa, 0xea3, 0xda9, 0xca0,
-			0x460, 0x569, 0x663, 0x76a, 0x66 , 0x16f, 0x265, 0x36c,
-			0xc6c, 0xd65, 0xe6f, 0xf66, 0x86a, 0x963, 0xa69, 0xb60,
-			0x5f0, 0x4f9, 0x7f3, 0x6fa, 0x1f6, 0xff , 0x3f5, 0x2fc,
-			0xdfc, 0xcf5, 0xfff, 0xef6, 0x9fa, 0x8f3, 0xbf9, 0xaf0,
-			0x650, 0x759, 0x453, 0x55a, 0x256, 0x35f, 0x55 , 0x15c,
-			0xe5c, 0xf55, 0xc5f, 0xd56, 0xa5a, 0xb53, 0x859, 0x950,
-			0x7c0, 0x6c9, 0x5c3, 0x4ca, 0x3c6, 0x2cf, 0x1c5, 0xcc ,
-			0xfcc, 0xec5, 0xdcf, 0xcc6, 0xbca, 0xac3, 0x9c9, 0x8c0,
-			0x8c0, 0x9c9, 0xac3, 0xbca, 0xcc6, 0xdcf, 0xec5, 0xfcc,
-			0xcc , 0x1c5, 0x2cf, 0x3c6, 0x4ca, 0x5c3, 0x6c9, 0x7c0,
-			0x950, 0x859, 0xb53, 0xa5a, 0xd56, 0xc5f, 0xf55, 0xe5c,
-			0x15c, 0x55 , 0x35f, 0x256, 0x55a, 0x453, 0x759, 0x650,
-			0xaf0, 0xbf9, 0x8f3, 0x9fa, 0xef6, 0xfff, 0xcf5, 0xdfc,
-			0x2fc, 0x3f5, 0xff , 0x1f6, 0x6fa, 0x7f3, 0x4f9, 0x5f0,
-			0xb60, 0xa69, 0x963, 0x86a, 0xf66, 0xe6f, 0xd65, 0xc6c,
-			0x36c, 0x265, 0x16f, 0x66 , 0x76a, 0x663, 0x569, 0x460,
-			0xca0, 0xda9, 0xea3, 0xfaa, 0x8a6, 0x9af, 0xaa5, 0xbac,
-			0x4ac, 0x5a5, 0x6af, 0x7a6, 0xaa , 0x1a3, 0x2a9, 0x3a0,
-			0xd30, 0xc39, 0xf33, 0xe3a, 0x936, 0x83f, 0xb35, 0xa3c,
-			0x53c, 0x435, 0x73f, 0x636, 0x13a, 0x33 , 0x339, 0x230,
-			0xe90, 0xf99, 0xc93, 0xd9a, 0xa96, 0xb9f, 0x895, 0x99c,
-			0x69c, 0x795, 0x49f, 0x596, 0x29a, 0x393, 0x99 , 0x190,
-			0xf00, 0xe09, 0xd03, 0xc0a, 0xb06, 0xa0f, 0x905, 0x80c,
-			0x70c, 0x605, 0x50f, 0x406, 0x30a, 0x203, 0x109, 0x0
-		};
-		const int TriangleTable[256][16] = {
-			{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 8, 3, 9, 8, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 3, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{9, 2, 10, 0, 2, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{2, 8, 3, 2, 10, 8, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1},
-			{3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 11, 2, 8, 11, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 9, 0, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 11, 2, 1, 9, 11, 9, 8, 11, -1, -1, -1, -1, -1, -1, -1},
-			{3, 10, 1, 11, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 10, 1, 0, 8, 10, 8, 11, 10, -1, -1, -1, -1, -1, -1, -1},
-			{3, 9, 0, 3, 11, 9, 11, 10, 9, -1, -1, -1, -1, -1, -1, -1},
-			{9, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 3, 0, 7, 3, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 1, 9, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 1, 9, 4, 7, 1, 7, 3, 1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 10, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{3, 4, 7, 3, 0, 4, 1, 2, 10, -1, -1, -1, -1, -1, -1, -1},
-			{9, 2, 10, 9, 0, 2, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
-			{2, 10, 9, 2, 9, 7, 2, 7, 3, 7, 9, 4, -1, -1, -1, -1},
-			{8, 4, 7, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{11, 4, 7, 11, 2, 4, 2, 0, 4, -1, -1, -1, -1, -1, -1, -1},
-			{9, 0, 1, 8, 4, 7, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
-			{4, 7, 11, 9, 4, 11, 9, 11, 2, 9, 2, 1, -1, -1, -1, -1},
-			{3, 10, 1, 3, 11, 10, 7, 8, 4, -1, -1, -1, -1, -1, -1, -1},
-			{1, 11, 10, 1, 4, 11, 1, 0, 4, 7, 11, 4, -1, -1, -1, -1},
-			{4, 7, 8, 9, 0, 11, 9, 11, 10, 11, 0, 3, -1, -1, -1, -1},
-			{4, 7, 11, 4, 11, 9, 9, 11, 10, -1, -1, -1, -1, -1, -1, -1},
-			{9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{9, 5, 4, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 5, 4, 1, 5, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{8, 5, 4, 8, 3, 5, 3, 1, 5, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 10, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{3, 0, 8, 1, 2, 10, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
-			{5, 2, 10, 5, 4, 2, 4, 0, 2, -1, -1, -1, -1, -1, -1, -1},
-			{2, 10, 5, 3, 2, 5, 3, 5, 4, 3, 4, 8, -1, -1, -1, -1},
-			{9, 5, 4, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 11, 2, 0, 8, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1},
-			{0, 5, 4, 0, 1, 5, 2, 3, 11, -1, -1, -1, -1, -1, -1, -1},
-			{2, 1, 5, 2, 5, 8, 2, 8, 11, 4, 8, 5, -1, -1, -1, -1},
-			{10, 3, 11, 10, 1, 3, 9, 5, 4, -1, -1, -1, -1, -1, -1, -1},
-			{4, 9, 5, 0, 8, 1, 8, 10, 1, 8, 11, 10, -1, -1, -1, -1},
-			{5, 4, 0, 5, 0, 11, 5, 11, 10, 11, 0, 3, -1, -1, -1, -1},
-			{5, 4, 8, 5, 8, 10, 10, 8, 11, -1, -1, -1, -1, -1, -1, -1},
-			{9, 7, 8, 5, 7, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{9, 3, 0, 9, 5, 3, 5, 7, 3, -1, -1, -1, -1, -1, -1, -1},
-			{0, 7, 8, 0, 1, 7, 1, 5, 7, -1, -1, -1, -1, -1, -1, -1},
-			{1, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{9, 7, 8, 9, 5, 7, 10, 1, 2, -1, -1, -1, -1, -1, -1, -1},
-			{10, 1, 2, 9, 5, 0, 5, 3, 0, 5, 7, 3, -1, -1, -1, -1},
-			{8, 0, 2, 8, 2, 5, 8, 5, 7, 10, 5, 2, -1, -1, -1, -1},
-			{2, 10, 5, 2, 5, 3, 3, 5, 7, -1, -1, -1, -1, -1, -1, -1},
-			{7, 9, 5, 7, 8, 9, 3, 11, 2, -1, -1, -1, -1, -1, -1, -1},
-			{9, 5, 7, 9, 7, 2, 9, 2, 0, 2, 7, 11, -1, -1, -1, -1},
-			{2, 3, 11, 0, 1, 8, 1, 7, 8, 1, 5, 7, -1, -1, -1, -1},
-			{11, 2, 1, 11, 1, 7, 7, 1, 5, -1, -1, -1, -1, -1, -1, -1},
-			{9, 5, 8, 8, 5, 7, 10, 1, 3, 10, 3, 11, -1, -1, -1, -1},
-			{5, 7, 0, 5, 0, 9, 7, 11, 0, 1, 0, 10, 11, 10, 0, -1},
-			{11, 10, 0, 11, 0, 3, 10, 5, 0, 8, 0, 7, 5, 7, 0, -1},
-			{11, 10, 5, 7, 11, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{9, 0, 1, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 8, 3, 1, 9, 8, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
-			{1, 6, 5, 2, 6, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 6, 5, 1, 2, 6, 3, 0, 8, -1, -1, -1, -1, -1, -1, -1},
-			{9, 6, 5, 9, 0, 6, 0, 2, 6, -1, -1, -1, -1, -1, -1, -1},
-			{5, 9, 8, 5, 8, 2, 5, 2, 6, 3, 2, 8, -1, -1, -1, -1},
-			{2, 3, 11, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{11, 0, 8, 11, 2, 0, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
-			{0, 1, 9, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1},
-			{5, 10, 6, 1, 9, 2, 9, 11, 2, 9, 8, 11, -1, -1, -1, -1},
-			{6, 3, 11, 6, 5, 3, 5, 1, 3, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 11, 0, 11, 5, 0, 5, 1, 5, 11, 6, -1, -1, -1, -1},
-			{3, 11, 6, 0, 3, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1},
-			{6, 5, 9, 6, 9, 11, 11, 9, 8, -1, -1, -1, -1, -1, -1, -1},
-			{5, 10, 6, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 3, 0, 4, 7, 3, 6, 5, 10, -1, -1, -1, -1, -1, -1, -1},
-			{1, 9, 0, 5, 10, 6, 8, 4, 7, -1, -1, -1, -1, -1, -1, -1},
-			{10, 6, 5, 1, 9, 7, 1, 7, 3, 7, 9, 4, -1, -1, -1, -1},
-			{6, 1, 2, 6, 5, 1, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 5, 5, 2, 6, 3, 0, 4, 3, 4, 7, -1, -1, -1, -1},
-			{8, 4, 7, 9, 0, 5, 0, 6, 5, 0, 2, 6, -1, -1, -1, -1},
-			{7, 3, 9, 7, 9, 4, 3, 2, 9, 5, 9, 6, 2, 6, 9, -1},
-			{3, 11, 2, 7, 8, 4, 10, 6, 5, -1, -1, -1, -1, -1, -1, -1},
-			{5, 10, 6, 4, 7, 2, 4, 2, 0, 2, 7, 11, -1, -1, -1, -1},
-			{0, 1, 9, 4, 7, 8, 2, 3, 11, 5, 10, 6, -1, -1, -1, -1},
-			{9, 2, 1, 9, 11, 2, 9, 4, 11, 7, 11, 4, 5, 10, 6, -1},
-			{8, 4, 7, 3, 11, 5, 3, 5, 1, 5, 11, 6, -1, -1, -1, -1},
-			{5, 1, 11, 5, 11, 6, 1, 0, 11, 7, 11, 4, 0, 4, 11, -1},
-			{0, 5, 9, 0, 6, 5, 0, 3, 6, 11, 6, 3, 8, 4, 7, -1},
-			{6, 5, 9, 6, 9, 11, 4, 7, 9, 7, 11, 9, -1, -1, -1, -1},
-			{10, 4, 9, 6, 4, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 10, 6, 4, 9, 10, 0, 8, 3, -1, -1, -1, -1, -1, -1, -1},
-			{10, 0, 1, 10, 6, 0, 6, 4, 0, -1, -1, -1, -1, -1, -1, -1},
-			{8, 3, 1, 8, 1, 6, 8, 6, 4, 6, 1, 10, -1, -1, -1, -1},
-			{1, 4, 9, 1, 2, 4, 2, 6, 4, -1, -1, -1, -1, -1, -1, -1},
-			{3, 0, 8, 1, 2, 9, 2, 4, 9, 2, 6, 4, -1, -1, -1, -1},
-			{0, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{8, 3, 2, 8, 2, 4, 4, 2, 6, -1, -1, -1, -1, -1, -1, -1},
-			{10, 4, 9, 10, 6, 4, 11, 2, 3, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 2, 2, 8, 11, 4, 9, 10, 4, 10, 6, -1, -1, -1, -1},
-			{3, 11, 2, 0, 1, 6, 0, 6, 4, 6, 1, 10, -1, -1, -1, -1},
-			{6, 4, 1, 6, 1, 10, 4, 8, 1, 2, 1, 11, 8, 11, 1, -1},
-			{9, 6, 4, 9, 3, 6, 9, 1, 3, 11, 6, 3, -1, -1, -1, -1},
-			{8, 11, 1, 8, 1, 0, 11, 6, 1, 9, 1, 4, 6, 4, 1, -1},
-			{3, 11, 6, 3, 6, 0, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1},
-			{6, 4, 8, 11, 6, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{7, 10, 6, 7, 8, 10, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1},
-			{0, 7, 3, 0, 10, 7, 0, 9, 10, 6, 7, 10, -1, -1, -1, -1},
-			{10, 6, 7, 1, 10, 7, 1, 7, 8, 1, 8, 0, -1, -1, -1, -1},
-			{10, 6, 7, 10, 7, 1, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 6, 1, 6, 8, 1, 8, 9, 8, 6, 7, -1, -1, -1, -1},
-			{2, 6, 9, 2, 9, 1, 6, 7, 9, 0, 9, 3, 7, 3, 9, -1},
-			{7, 8, 0, 7, 0, 6, 6, 0, 2, -1, -1, -1, -1, -1, -1, -1},
-			{7, 3, 2, 6, 7, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{2, 3, 11, 10, 6, 8, 10, 8, 9, 8, 6, 7, -1, -1, -1, -1},
-			{2, 0, 7, 2, 7, 11, 0, 9, 7, 6, 7, 10, 9, 10, 7, -1},
-			{1, 8, 0, 1, 7, 8, 1, 10, 7, 6, 7, 10, 2, 3, 11, -1},
-			{11, 2, 1, 11, 1, 7, 10, 6, 1, 6, 7, 1, -1, -1, -1, -1},
-			{8, 9, 6, 8, 6, 7, 9, 1, 6, 11, 6, 3, 1, 3, 6, -1},
-			{0, 9, 1, 11, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{7, 8, 0, 7, 0, 6, 3, 11, 0, 11, 6, 0, -1, -1, -1, -1},
-			{7, 11, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{3, 0, 8, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 1, 9, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{8, 1, 9, 8, 3, 1, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
-			{10, 1, 2, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 10, 3, 0, 8, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
-			{2, 9, 0, 2, 10, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1},
-			{6, 11, 7, 2, 10, 3, 10, 8, 3, 10, 9, 8, -1, -1, -1, -1},
-			{7, 2, 3, 6, 2, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{7, 0, 8, 7, 6, 0, 6, 2, 0, -1, -1, -1, -1, -1, -1, -1},
-			{2, 7, 6, 2, 3, 7, 0, 1, 9, -1, -1, -1, -1, -1, -1, -1},
-			{1, 6, 2, 1, 8, 6, 1, 9, 8, 8, 7, 6, -1, -1, -1, -1},
-			{10, 7, 6, 10, 1, 7, 1, 3, 7, -1, -1, -1, -1, -1, -1, -1},
-			{10, 7, 6, 1, 7, 10, 1, 8, 7, 1, 0, 8, -1, -1, -1, -1},
-			{0, 3, 7, 0, 7, 10, 0, 10, 9, 6, 10, 7, -1, -1, -1, -1},
-			{7, 6, 10, 7, 10, 8, 8, 10, 9, -1, -1, -1, -1, -1, -1, -1},
-			{6, 8, 4, 11, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{3, 6, 11, 3, 0, 6, 0, 4, 6, -1, -1, -1, -1, -1, -1, -1},
-			{8, 6, 11, 8, 4, 6, 9, 0, 1, -1, -1, -1, -1, -1, -1, -1},
-			{9, 4, 6, 9, 6, 3, 9, 3, 1, 11, 3, 6, -1, -1, -1, -1},
-			{6, 8, 4, 6, 11, 8, 2, 10, 1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 10, 3, 0, 11, 0, 6, 11, 0, 4, 6, -1, -1, -1, -1},
-			{4, 11, 8, 4, 6, 11, 0, 2, 9, 2, 10, 9, -1, -1, -1, -1},
-			{10, 9, 3, 10, 3, 2, 9, 4, 3, 11, 3, 6, 4, 6, 3, -1},
-			{8, 2, 3, 8, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1},
-			{0, 4, 2, 4, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 9, 0, 2, 3, 4, 2, 4, 6, 4, 3, 8, -1, -1, -1, -1},
-			{1, 9, 4, 1, 4, 2, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1},
-			{8, 1, 3, 8, 6, 1, 8, 4, 6, 6, 10, 1, -1, -1, -1, -1},
-			{10, 1, 0, 10, 0, 6, 6, 0, 4, -1, -1, -1, -1, -1, -1, -1},
-			{4, 6, 3, 4, 3, 8, 6, 10, 3, 0, 3, 9, 10, 9, 3, -1},
-			{10, 9, 4, 6, 10, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 9, 5, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 3, 4, 9, 5, 11, 7, 6, -1, -1, -1, -1, -1, -1, -1},
-			{5, 0, 1, 5, 4, 0, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
-			{11, 7, 6, 8, 3, 4, 3, 5, 4, 3, 1, 5, -1, -1, -1, -1},
-			{9, 5, 4, 10, 1, 2, 7, 6, 11, -1, -1, -1, -1, -1, -1, -1},
-			{6, 11, 7, 1, 2, 10, 0, 8, 3, 4, 9, 5, -1, -1, -1, -1},
-			{7, 6, 11, 5, 4, 10, 4, 2, 10, 4, 0, 2, -1, -1, -1, -1},
-			{3, 4, 8, 3, 5, 4, 3, 2, 5, 10, 5, 2, 11, 7, 6, -1},
-			{7, 2, 3, 7, 6, 2, 5, 4, 9, -1, -1, -1, -1, -1, -1, -1},
-			{9, 5, 4, 0, 8, 6, 0, 6, 2, 6, 8, 7, -1, -1, -1, -1},
-			{3, 6, 2, 3, 7, 6, 1, 5, 0, 5, 4, 0, -1, -1, -1, -1},
-			{6, 2, 8, 6, 8, 7, 2, 1, 8, 4, 8, 5, 1, 5, 8, -1},
-			{9, 5, 4, 10, 1, 6, 1, 7, 6, 1, 3, 7, -1, -1, -1, -1},
-			{1, 6, 10, 1, 7, 6, 1, 0, 7, 8, 7, 0, 9, 5, 4, -1},
-			{4, 0, 10, 4, 10, 5, 0, 3, 10, 6, 10, 7, 3, 7, 10, -1},
-			{7, 6, 10, 7, 10, 8, 5, 4, 10, 4, 8, 10, -1, -1, -1, -1},
-			{6, 9, 5, 6, 11, 9, 11, 8, 9, -1, -1, -1, -1, -1, -1, -1},
-			{3, 6, 11, 0, 6, 3, 0, 5, 6, 0, 9, 5, -1, -1, -1, -1},
-			{0, 11, 8, 0, 5, 11, 0, 1, 5, 5, 6, 11, -1, -1, -1, -1},
-			{6, 11, 3, 6, 3, 5, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 10, 9, 5, 11, 9, 11, 8, 11, 5, 6, -1, -1, -1, -1},
-			{0, 11, 3, 0, 6, 11, 0, 9, 6, 5, 6, 9, 1, 2, 10, -1},
-			{11, 8, 5, 11, 5, 6, 8, 0, 5, 10, 5, 2, 0, 2, 5, -1},
-			{6, 11, 3, 6, 3, 5, 2, 10, 3, 10, 5, 3, -1, -1, -1, -1},
-			{5, 8, 9, 5, 2, 8, 5, 6, 2, 3, 8, 2, -1, -1, -1, -1},
-			{9, 5, 6, 9, 6, 0, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1},
-			{1, 5, 8, 1, 8, 0, 5, 6, 8, 3, 8, 2, 6, 2, 8, -1},
-			{1, 5, 6, 2, 1, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 3, 6, 1, 6, 10, 3, 8, 6, 5, 6, 9, 8, 9, 6, -1},
-			{10, 1, 0, 10, 0, 6, 9, 5, 0, 5, 6, 0, -1, -1, -1, -1},
-			{0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{10, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{11, 5, 10, 7, 5, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{11, 5, 10, 11, 7, 5, 8, 3, 0, -1, -1, -1, -1, -1, -1, -1},
-			{5, 11, 7, 5, 10, 11, 1, 9, 0, -1, -1, -1, -1, -1, -1, -1},
-			{10, 7, 5, 10, 11, 7, 9, 8, 1, 8, 3, 1, -1, -1, -1, -1},
-			{11, 1, 2, 11, 7, 1, 7, 5, 1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 3, 1, 2, 7, 1, 7, 5, 7, 2, 11, -1, -1, -1, -1},
-			{9, 7, 5, 9, 2, 7, 9, 0, 2, 2, 11, 7, -1, -1, -1, -1},
-			{7, 5, 2, 7, 2, 11, 5, 9, 2, 3, 2, 8, 9, 8, 2, -1},
-			{2, 5, 10, 2, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1},
-			{8, 2, 0, 8, 5, 2, 8, 7, 5, 10, 2, 5, -1, -1, -1, -1},
-			{9, 0, 1, 5, 10, 3, 5, 3, 7, 3, 10, 2, -1, -1, -1, -1},
-			{9, 8, 2, 9, 2, 1, 8, 7, 2, 10, 2, 5, 7, 5, 2, -1},
-			{1, 3, 5, 3, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 7, 0, 7, 1, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1},
-			{9, 0, 3, 9, 3, 5, 5, 3, 7, -1, -1, -1, -1, -1, -1, -1},
-			{9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{5, 8, 4, 5, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1},
-			{5, 0, 4, 5, 11, 0, 5, 10, 11, 11, 3, 0, -1, -1, -1, -1},
-			{0, 1, 9, 8, 4, 10, 8, 10, 11, 10, 4, 5, -1, -1, -1, -1},
-			{10, 11, 4, 10, 4, 5, 11, 3, 4, 9, 4, 1, 3, 1, 4, -1},
-			{2, 5, 1, 2, 8, 5, 2, 11, 8, 4, 5, 8, -1, -1, -1, -1},
-			{0, 4, 11, 0, 11, 3, 4, 5, 11, 2, 11, 1, 5, 1, 11, -1},
-			{0, 2, 5, 0, 5, 9, 2, 11, 5, 4, 5, 8, 11, 8, 5, -1},
-			{9, 4, 5, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{2, 5, 10, 3, 5, 2, 3, 4, 5, 3, 8, 4, -1, -1, -1, -1},
-			{5, 10, 2, 5, 2, 4, 4, 2, 0, -1, -1, -1, -1, -1, -1, -1},
-			{3, 10, 2, 3, 5, 10, 3, 8, 5, 4, 5, 8, 0, 1, 9, -1},
-			{5, 10, 2, 5, 2, 4, 1, 9, 2, 9, 4, 2, -1, -1, -1, -1},
-			{8, 4, 5, 8, 5, 3, 3, 5, 1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 4, 5, 1, 0, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{8, 4, 5, 8, 5, 3, 9, 0, 5, 0, 3, 5, -1, -1, -1, -1},
-			{9, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 11, 7, 4, 9, 11, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1},
-			{0, 8, 3, 4, 9, 7, 9, 11, 7, 9, 10, 11, -1, -1, -1, -1},
-			{1, 10, 11, 1, 11, 4, 1, 4, 0, 7, 4, 11, -1, -1, -1, -1},
-			{3, 1, 4, 3, 4, 8, 1, 10, 4, 7, 4, 11, 10, 11, 4, -1},
-			{4, 11, 7, 9, 11, 4, 9, 2, 11, 9, 1, 2, -1, -1, -1, -1},
-			{9, 7, 4, 9, 11, 7, 9, 1, 11, 2, 11, 1, 0, 8, 3, -1},
-			{11, 7, 4, 11, 4, 2, 2, 4, 0, -1, -1, -1, -1, -1, -1, -1},
-			{11, 7, 4, 11, 4, 2, 8, 3, 4, 3, 2, 4, -1, -1, -1, -1},
-			{2, 9, 10, 2, 7, 9, 2, 3, 7, 7, 4, 9, -1, -1, -1, -1},
-			{9, 10, 7, 9, 7, 4, 10, 2, 7, 8, 7, 0, 2, 0, 7, -1},
-			{3, 7, 10, 3, 10, 2, 7, 4, 10, 1, 10, 0, 4, 0, 10, -1},
-			{1, 10, 2, 8, 7, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 9, 1, 4, 1, 7, 7, 1, 3, -1, -1, -1, -1, -1, -1, -1},
-			{4, 9, 1, 4, 1, 7, 0, 8, 1, 8, 7, 1, -1, -1, -1, -1},
-			{4, 0, 3, 7, 4, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{9, 10, 8, 10, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{3, 0, 9, 3, 9, 11, 11, 9, 10, -1, -1, -1, -1, -1, -1, -1},
-			{0, 1, 10, 0, 10, 8, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1},
-			{3, 1, 10, 11, 3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 2, 11, 1, 11, 9, 9, 11, 8, -1, -1, -1, -1, -1, -1, -1},
-			{3, 0, 9, 3, 9, 11, 1, 2, 9, 2, 11, 9, -1, -1, -1, -1},
-			{0, 2, 11, 8, 0, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{3, 2, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{2, 3, 8, 2, 8, 10, 10, 8, 9, -1, -1, -1, -1, -1, -1, -1},
-			{9, 10, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{2, 3, 8, 2, 8, 10, 0, 1, 8, 1, 10, 8, -1, -1, -1, -1},
-			{1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{1, 3, 8, 9, 1, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
-			{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}
-		};
-
 		// 通用資料
 		IsoSurfaceAttributes Attributes;
 		std::string InfDataFilePath;
@@ -434,35 +686,144 @@ namespace Nexus {
 		std::vector<float> GradientMagnitudes;
 		bool IsInitialize = false;
 		bool IsReadyToDraw = false;
+		// RawData 改變時 Invalidate(DERIVED_DATA_RAW_DATA)，取用衍生資料之前先 Require 對應的節點。
+		DerivedDataGraph DerivedData;
+		float MaxGradient = 1.0f;
+		float MaxValue = 0.0f;
+		float MaxGradientMagnitude = 0.0f;
+
+		// Empty space skipping
+		int BrickSize = 8;
+		MinMaxOctree Octree;
+		SpanSpaceIndex SpanIndex;
+		std::vector<unsigned int> ActiveBricks;
+		bool EnableMultiThreading = true;
 
 		// 統計專用
 		bool IsEqualization = false;
 		std::chrono::duration<double> ElapsedSeconds;
+		std::chrono::duration<double> ExtractionSeconds;
+		std::chrono::duration<double> DecimationSeconds;
+		unsigned int ExtractedTriangleCount = 0;
 		std::vector<float> IsoValueHistogram;
 		std::vector<float> GradientHistogram;
 		std::vector<float> GradientHeatmap;
 		std::vector<std::pair<float, float>> IsoValueBoundary;
 		std::vector<std::pair<float, float>> GradientBoundary;
+		// 目前的 histogram 是以多少個 bin 計算的，Interval 改變時重新計算。
+		float HistogramInterval = 0.0f;
 
 		// Ray Casting 專用
 		int CurrentRenderMode = RENDER_MODE_ISO_SURFACE;
-		GLuint VolumeTexture;
+		int CurrentVolumeTextureFormat = VOLUME_TEXTURE_FORMAT_RGBA32F;
+		bool EnableGradientTexture = false;
+		GLuint VolumeTexture = 0;
+		glm::ivec3 VolumeTextureSize = glm::ivec3(0);
+		GLenum VolumeTextureInternalFormat = 0;
+		GLuint GradientTexture = 0;
+		glm::ivec3 GradientTextureSize = glm::ivec3(0);
+		GLenum GradientTextureInternalFormat = 0;
+		size_t VolumeTextureBytes = 0;
+		bool EnableStreamingUpload = false;
+		VolumeTextureStreamer VolumeStreamer;
+		bool EnableEmptySpaceSkipping = false;
+		SoftwareRayCasterSettings SoftwareRayCasting;
+		bool EnableTransferFunction2D = false;
+		TransferFunction2D TransferFunction2DTable;
+		GLuint TransferFunction2DTexture = 0;
+		int TransferFunction2DTextureSize = 0;
+		bool EnablePreIntegration = false;
+		float PreIntegrationStepSize = 1.0f;
+		PreIntegrationTable PreIntegration;
+		GLuint PreIntegrationTexture = 0;
+		int PreIntegrationTextureSize = 0;
+		double SoftwareSamplesPerSecond = 0.0;
+		bool EnableProgressiveRendering = false;
+		Nexus::Shader* ProgressiveCompositeShader = nullptr;
+		ProgressiveRenderer ProgressiveRendering;
+		std::vector<float> TransferFunction;
+		OccupancyGrid Occupancy;
+		GLuint OccupancyTexture = 0;
+		glm::ivec3 OccupancyTextureSize = glm::ivec3(0);
+		GLenum OccupancyTextureInternalFormat = 0;
+		BrickRangeGrid ProjectionBricks;
+		GLuint ProjectionBrickTexture = 0;
+		glm::ivec3 ProjectionBrickTextureSize = glm::ivec3(0);
+		GLenum ProjectionBrickTextureInternalFormat = 0;
 		std::vector<glm::vec4> TextureData;
 		std::vector<float> BoundingBoxVertices;
 		std::vector<unsigned int> BoundingBoxIndices;
-		unsigned int BoundingBoxVAO;
-		unsigned int BoundingBoxVBO;
-		unsigned int BoundingBoxEBO;
+		unsigned int BoundingBoxVAO = 0;
+		unsigned int BoundingBoxVBO = 0;
+		unsigned int BoundingBoxEBO = 0;
+
+		// Slice viewer 專用，每個方向一張 texture，3O1P 可以同時顯示三個方向。
+		VolumeSlicer Slicer;
+		SliceWindowLevel SliceWindow;
+		std::unique_ptr<Texture2D> SliceTextures[3];
+		// 每張 texture 目前的 slice，-1 表示需要重新抽取。
+		int SliceIndices[3] = { -1, -1, -1 };
+		std::vector<uint8_t> SliceImage;
 
 		// Iso Surface 專用
 		float IsoValue = 80.0f;
+		std::vector<IsoSurfaceLayer> Layers;
+		int CurrentExtractionMethod = EXTRACTION_METHOD_MARCHING_CUBES;
 		std::vector<float> Vertices;
 		std::vector<float> Position;
 		std::vector<float> Normal;
+		std::vector<unsigned int> Indices;
+		// 已經上傳到 GPU 的數量，CPU 端的資料被釋放後仍然可以繪製。
 		unsigned int VertexCount = 0;
+		unsigned int IndexCount = 0;
+		unsigned int VertexBufferSize = 0;
+		bool EnableCompressedVertices = false;
+		bool EnableHostCopies = true;
+		glm::vec3 QuantizationExtent = glm::vec3(1.0f);
+		bool EnableDecimation = false;
+		DecimationSettings Decimation;
+		bool EnableComponentFilter = false;
+		ComponentFilterSettings ComponentFiltering;
+		unsigned int RemovedComponentCount = 0;
+		bool EnableMeshOptimization = false;
+		float ACMRBefore = 0.0f;
+		float ACMRAfter = 0.0f;
+		ClipRegion Clip;
+		bool EnableChunkedLevelOfDetail = false;
+		std::unique_ptr<ChunkedIsoSurface> Chunks;
 		bool EnableWireFrameMode = false;
-		unsigned int VAO;
-		unsigned int VBO;
+		// 兩組 buffer 輪流使用：新的表面上傳到沒有在畫的那一組，上傳完才交換，GPU 可能還在讀的前一個表面不會被覆寫。
+		SurfaceBuffer SurfaceBuffers[2];
+		unsigned int FrontSurfaceBuffer = 0;
+
+		// Progressive extraction：worker 把 slab 放進佇列，Draw 在主執行緒上依照預算取出並上傳。
+		bool EnableProgressive = false;
+		bool ProgressiveActive = false;
+		// 目前的 GPU buffer 是不是 progressive 模式填的（只有一層），以及它有沒有 index buffer。
+		bool IsProgressiveBuffer = false;
+		bool ProgressiveIndexed = false;
+		// 正在串流的那一組 buffer 與其中已經上傳的數量。前景還有表面時串流到背景那一組，全部上傳完才交換，
+		// 在那之前 Draw 仍然以 VertexCount / IndexCount 畫前一個表面。
+		unsigned int ProgressiveSurface = 0;
+		bool ProgressiveSurfaceIndexed = false;
+		unsigned int ProgressiveVertexCount = 0;
+		unsigned int ProgressiveIndexCount = 0;
+		// 串流到背景時的 CPU 端副本，交換時才取代 Vertices / Indices。
+		std::vector<float> ProgressiveVertices;
+		std::vector<unsigned int> ProgressiveIndices;
+		unsigned int ProgressiveUploadBudget = 4 << 20;
+		unsigned int ProgressiveSlabCount = 0;
+		std::atomic<unsigned int> ProgressiveSlabsExtracted{ 0 };
+		std::atomic<bool> ProgressiveCancel{ false };
+		std::atomic<bool> ProgressiveFinished{ false };
+		std::future<void> ProgressiveTask;
+		std::mutex ProgressiveMutex;
+		std::deque<ProgressiveSlab> ProgressiveQueue;
+		ProgressiveSlab ProgressiveCurrent;
+		bool HasProgressiveCurrent = false;
+		size_t ProgressiveVertexCursor = 0;
+		size_t ProgressiveIndexCursor = 0;
+		std::chrono::system_clock::time_point ProgressiveStart;
 
 		unsigned int GetIndexFromGrid(int x, int y, int z) const {
 			return static_cast<unsigned int>(z * Attributes.Resolution.y * Attributes.Resolution.x + (y * Attributes.Resolution.x + x));
@@ -489,19 +850,57 @@ namespace Nexus {
 		}
 
 		void GetAttributesFromInfoFile();
+		void BuildDerivedDataGraph();
+		void RequireHistograms(const std::vector<unsigned int>& nodes);
+		void ComputeValueRange();
 		void GenerateTextureData();
+		void UploadTexture3D(GLuint& texture, glm::ivec3& allocated_size, GLenum& allocated_format, glm::ivec3 texture_size, GLenum internal_format, GLenum format, GLenum type, GLint filter, const void* data);
+		void UploadVolumeTexture();
+		void StartVolumeStreaming();
+		void UploadTransferFunction2D();
+		float GetGradientMagnitudeScale() const;
+		void UpdateOccupancy();
+		void UpdatePreIntegration();
+		void UploadPreIntegrationTable();
+		void UploadProjectionBricks();
+		void ReleaseGradientTexture();
 		void EqualizationData(std::vector<int> equal_values);
 		void ComputeAllNormals(float max_gradient);
-		void GenerateVertices(float iso_value);
+		void BuildSpatialIndex();
+		void GetActiveBricks(float iso_value, std::vector<unsigned int>& bricks) const;
+		void GenerateVertices(std::vector<IsoSurfaceLayer>& layers);
+		void GenerateVerticesFlyingEdges(std::vector<IsoSurfaceLayer>& layers);
+		void GenerateVerticesSurfaceNets(std::vector<IsoSurfaceLayer>& layers);
+		void AppendIndexedLayer(IsoSurfaceLayer& layer, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+		void TransformLayers(std::vector<IsoSurfaceLayer>& layers, const std::function<void(std::vector<float>&, std::vector<unsigned int>&)>& transform);
+		void FilterComponents(std::vector<IsoSurfaceLayer>& layers);
+		void DecimateLayers(std::vector<IsoSurfaceLayer>& layers);
+		void OptimizeLayers(std::vector<IsoSurfaceLayer>& layers);
+		void CollectActiveBricks(const std::vector<IsoSurfaceLayer>& layers, glm::ivec3 cell_min, glm::ivec3 cell_max);
+		void PolygoniseBricks(const std::vector<unsigned int>& bricks, const std::vector<IsoSurfaceLayer>& layers, glm::ivec3 cell_min, glm::ivec3 cell_max, std::vector<std::vector<PolygonBuffer>>& buffers) const;
+		void PolygoniseBrick(const VolumeBrick& brick, const std::vector<IsoSurfaceLayer>& layers, std::vector<PolygonBuffer>& buffers, glm::ivec3 cell_min, glm::ivec3 cell_max) const;
+		void GetClipCellRange(glm::ivec3& cell_min, glm::ivec3& cell_max) const;
+		bool IsClipped(glm::vec3 box_min, glm::vec3 box_max) const;
+		void ClipTriangles(std::vector<float>& vertices, std::vector<unsigned int>& indices) const;
+		void ClipTriangleSoup(PolygonBuffer& buffer, size_t first_vertex) const;
+		static void RemoveUnusedVertices(std::vector<float>& vertices, std::vector<unsigned int>& indices);
+		GridCell GetGridCell(int x, int y, int z) const;
 		void BufferInitialize();
+		void PackVertices(const std::vector<float>& vertices, std::vector<PackedVertex>& packed) const;
+		void BindVertexAttributes(bool is_compressed) const;
+		SurfaceBuffer& GetBackSurfaceBuffer();
+		void BindSurfaceBuffer(const SurfaceBuffer& surface) const;
+		void ReserveBuffer(const SurfaceBuffer& surface, GLuint& buffer, size_t& capacity, size_t used_bytes, size_t required_bytes);
+		void UploadBufferData(GLuint buffer, size_t offset, size_t bytes, const void* data) const;
+		void ReleaseGraphicsResources();
+		void StartProgressiveExtraction();
+		void StopProgressiveExtraction();
+		void ExtractSlab(float iso_value, glm::ivec3 cell_min, glm::ivec3 cell_max, int method, bool is_first_slab, const std::vector<unsigned int>& bricks, ProgressiveSlab& slab) const;
+		void UploadProgressiveSlabs();
 		
-		
-		void AddPosition(float x, float y, float z);
-		void AddPosition(glm::vec3 position);
-		void AddNormal(float nx, float ny, float nz);
-		void AddNormal(glm::vec3 normal);
-		
-		void Polygonise(GridCell cell, float iso_value);
-		glm::vec3 Interpolation(float iso_value, Voxel voxel_a, Voxel voxel_b, InterpolateMode mode);
+		void Polygonise(GridCell cell, float iso_value, PolygonBuffer& buffer) const;
+		// cube_index 已經由 CubeClassifier 算好時直接使用，不再逐一比較八個角。
+		void Polygonise(const GridCell& cell, int cube_index, float iso_value, PolygonBuffer& buffer) const;
+		glm::vec3 Interpolation(float iso_value, Voxel voxel_a, Voxel voxel_b, InterpolateMode mode) const;
 	};
 }
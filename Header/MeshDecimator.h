@@ -0,0 +1,118 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Nexus {
+
+	struct DecimationSettings {
+		// 目標三角形數量相對於輸入的比例，0 表示只受 MaxError 限制。
+		float TargetRatio = 0.25f;
+		// 允許的最大誤差（與原本平面的距離，單位與頂點座標相同），0 表示不限制。
+		float MaxError = 0.0f;
+		// 門檻值隨迭代次數成長的速度，數值越大越快，但品質越差。
+		float Aggressiveness = 7.0f;
+		// 平行化時切割網格用的格子大小（頂點座標單位）。
+		float ClusterSize = 32.0f;
+		int MaxIterations = 100;
+	};
+
+	// Quadric error metric simplification (Garland & Heckbert 1997) with the threshold iteration scheme
+	// of Sp4cerat's Fast-Quadric-Mesh-Simplification: instead of a global priority queue, every iteration
+	// collapses all edges whose error is below a growing threshold.
+	//
+	// To run in parallel the mesh is split into a grid of clusters, every cluster is simplified on its own
+	// with the vertices it shares with other clusters locked. A second pass runs on a grid shifted by half
+	// a cluster so the seams of the first pass get simplified as well. Open boundaries (edges used by one
+	// triangle, e.g. where the iso-surface leaves the volume) are never moved.
+	class MeshDecimator {
+	public:
+		MeshDecimator(const DecimationSettings& settings = DecimationSettings()) : Settings(settings) {}
+
+		// Vertices are interleaved (position, normal), 6 floats per vertex. An empty index list means the
+		// input is a triangle soup, it is welded first. The result is always an indexed mesh.
+		void Decimate(std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+		// 找出位置完全相同的頂點：representative[i] 是與頂點 i 位置相同、最先出現的那個頂點。
+		static void FindDuplicateVertices(const std::vector<float>& vertices, std::vector<unsigned int>& representative);
+		// 把三角形湯焊接成 indexed mesh，退化的三角形會被丟掉。
+		static void Weld(std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+		unsigned int GetInputTriangleCount() const { return this->InputTriangleCount; }
+		unsigned int GetOutputTriangleCount() const { return this->OutputTriangleCount; }
+
+	private:
+		struct SymmetricMatrix {
+			double M[10] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+			SymmetricMatrix() {}
+			SymmetricMatrix(double a, double b, double c, double d) {
+				M[0] = a * a; M[1] = a * b; M[2] = a * c; M[3] = a * d;
+				M[4] = b * b; M[5] = b * c; M[6] = b * d;
+				M[7] = c * c; M[8] = c * d;
+				M[9] = d * d;
+			}
+
+			SymmetricMatrix& operator+=(const SymmetricMatrix& other) {
+				for (int i = 0; i < 10; i++) {
+					M[i] += other.M[i];
+				}
+				return *this;
+			}
+
+			double Determinant(int a11, int a12, int a13, int a21, int a22, int a23, int a31, int a32, int a33) const {
+				return M[a11] * M[a22] * M[a33] + M[a13] * M[a21] * M[a32] + M[a12] * M[a23] * M[a31]
+					- M[a13] * M[a22] * M[a31] - M[a11] * M[a23] * M[a32] - M[a12] * M[a21] * M[a33];
+			}
+
+			double Error(const glm::dvec3& p) const {
+				return M[0] * p.x * p.x + 2.0 * M[1] * p.x * p.y + 2.0 * M[2] * p.x * p.z + 2.0 * M[3] * p.x
+					+ M[4] * p.y * p.y + 2.0 * M[5] * p.y * p.z + 2.0 * M[6] * p.y
+					+ M[7] * p.z * p.z + 2.0 * M[8] * p.z + M[9];
+			}
+		};
+
+		struct Vertex {
+			glm::dvec3 Position;
+			glm::vec3 Normal;
+			SymmetricMatrix Q;
+			unsigned int TriangleStart = 0;
+			unsigned int TriangleCount = 0;
+			bool Locked = false;
+		};
+
+		struct Triangle {
+			unsigned int V[3];
+			double Error[4];
+			glm::dvec3 Normal;
+			bool Deleted = false;
+			bool Dirty = false;
+		};
+
+		struct Reference {
+			unsigned int Triangle;
+			unsigned int Corner;
+		};
+
+		// 一個可以獨立簡化的網格（整個模型或其中一個 cluster）。
+		struct Mesh {
+			std::vector<Vertex> Vertices;
+			std::vector<Triangle> Triangles;
+			std::vector<Reference> References;
+		};
+
+		DecimationSettings Settings;
+		unsigned int InputTriangleCount = 0;
+		unsigned int OutputTriangleCount = 0;
+
+		void RunClusterPass(std::vector<float>& vertices, std::vector<unsigned int>& indices, float offset, double ratio) const;
+		void Compact(std::vector<float>& vertices, std::vector<unsigned int>& indices) const;
+
+		void Simplify(Mesh& mesh, unsigned int target_count) const;
+		void UpdateMesh(Mesh& mesh, int iteration) const;
+		void UpdateTriangles(Mesh& mesh, unsigned int i0, const Vertex& vertex, const std::vector<char>& deleted, unsigned int& deleted_count) const;
+		bool IsLinkValid(const Mesh& mesh, unsigned int i0, unsigned int i1) const;
+		bool IsFlipped(const Mesh& mesh, const glm::dvec3& p, unsigned int i1, const Vertex& vertex, std::vector<char>& deleted) const;
+		double CalculateError(const Mesh& mesh, unsigned int id_v1, unsigned int id_v2, glm::dvec3& result, glm::vec3& normal) const;
+	};
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Nexus {
+
+	enum MeshFileFormat {
+		MESH_FILE_FORMAT_UNKNOWN,
+		MESH_FILE_FORMAT_PLY,
+		MESH_FILE_FORMAT_STL,
+		MESH_FILE_FORMAT_OBJ
+	};
+
+	// Writes an extracted surface straight from its vertex / index buffers. Vertices are interleaved
+	// (position, normal), 6 floats per vertex; an empty index list means a triangle soup.
+	// Output is formatted in large blocks on the thread pool and written in order, PLY and STL are binary
+	// (little endian), OBJ is indexed text with per-vertex normals.
+	class MeshExporter {
+	public:
+		static bool Export(const std::string& path, const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
+		static bool Export(const std::string& path, const std::vector<float>& vertices, const std::vector<unsigned int>& indices, MeshFileFormat format);
+
+		static MeshFileFormat GetFormatFromPath(const std::string& path);
+
+	private:
+		static bool WritePLY(std::ofstream& file, const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
+		static bool WriteSTL(std::ofstream& file, const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
+		static bool WriteOBJ(std::ofstream& file, const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
+	};
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Nexus {
+
+	struct VolumeBrick {
+		// 以 cell 為單位的起點與大小，一個 brick 涵蓋 Size 個 cell（也就是 Size + 1 個 voxel）。
+		glm::ivec3 Origin = glm::ivec3(0);
+		glm::ivec3 Size = glm::ivec3(0);
+		float Min = 0.0f;
+		float Max = 0.0f;
+	};
+
+	// A min/max pyramid over the cells of a volume. Level 0 holds the bricks themselves,
+	// every upper level merges 2x2x2 nodes of the level below, so it behaves like an octree
+	// whose leaves are bricks. A node can only contain surface if Min <= iso < Max.
+	class MinMaxOctree {
+	public:
+		MinMaxOctree() {}
+
+		void Build(const std::vector<float>& data, glm::ivec3 resolution, int brick_size = 8);
+		void Clear();
+
+		void GetActiveBricks(float iso_value, std::vector<unsigned int>& bricks) const;
+
+		bool IsEmpty() const { return this->Bricks.empty(); }
+		int GetBrickSize() const { return this->BrickSize; }
+		int GetLevelCount() const { return (int)this->Levels.size(); }
+		glm::ivec3 GetBrickGridSize() const { return this->BrickGridSize; }
+		unsigned int GetBrickCount() const { return (unsigned int)this->Bricks.size(); }
+		const VolumeBrick& GetBrick(unsigned int index) const { return this->Bricks[index]; }
+		const std::vector<VolumeBrick>& GetBricks() const { return this->Bricks; }
+
+		static bool IsStraddling(float min, float max, float iso_value) {
+			// 與 Polygonise 的判斷方式一致：Value > iso_value 才會被標記為 1。
+			return min <= iso_value && max > iso_value;
+		}
+
+	private:
+		struct Level {
+			glm::ivec3 Size = glm::ivec3(0);
+			std::vector<glm::vec2> Range;
+		};
+
+		int BrickSize = 8;
+		glm::ivec3 BrickGridSize = glm::ivec3(0);
+		std::vector<VolumeBrick> Bricks;
+		std::vector<Level> Levels;
+
+		unsigned int GetNodeIndex(const Level& level, int x, int y, int z) const {
+			return static_cast<unsigned int>((z * level.Size.y + y) * level.Size.x + x);
+		}
+
+		void CollectActiveBricks(int level, int x, int y, int z, float iso_value, std::vector<unsigned int>& bricks) const;
+	};
+}
@@ -91,8 +91,14 @@ namespace Nexus {
 		unsigned int GetNormalCount() const { return (unsigned int)this->Normal.size() / 3; }
 		unsigned int GetTexCoordCount() const { return (unsigned int)this->TexCoord.size() / 2; }
 		unsigned int GetIndexCount() const { return (unsigned int)this->Indices.size(); }
+
+		// 之後建立的物件在上傳前是否重新排列三角形與頂點的順序（post-transform cache 與 vertex fetch），預設關閉。
+		static void SetMeshOptimization(bool enable) { Object::EnableMeshOptimization = enable; }
+		static bool GetMeshOptimization() { return Object::EnableMeshOptimization; }
 		
 	protected:
+		static bool EnableMeshOptimization;
+
 		std::string ShapeName;
 		std::vector<float> Vertices;
 		std::vector<float> Position;
@@ -114,6 +120,7 @@ namespace Nexus {
 		
 		virtual void GenerateVertices() = 0;
 		virtual void BufferInitialize();
+		void OptimizeMesh();
 
 		void AddPosition(float x, float y);
 		void AddPosition(float x, float y, float z);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "MinMaxOctree.h"
+
+namespace Nexus {
+
+	// Transfer-function-aware empty-space skipping for the ray caster. Every brick of the min/max octree is
+	// reduced to the range of transfer-function bins its voxels can sample (conservative for trilinear
+	// filtering), and a brick is occupied when any bin in that range has a visible opacity. The occupancy is
+	// turned into a Chebyshev distance map in bricks: a ray inside a brick with distance d can advance d - 1
+	// bricks in any direction without missing a visible sample. Occupied bricks have distance 0.
+	//
+	// When the transfer function changes only the bins whose visibility flipped are compared, bricks whose
+	// range does not touch them keep their state, and the distance map is rebuilt only if some brick flipped.
+	class OccupancyGrid {
+	public:
+		OccupancyGrid() {}
+
+		// value_max 是上傳到 texture 時正規化用的最大值，brick 的範圍會換算成同樣的 [0, 1]。
+		void Build(const MinMaxOctree& octree, float value_max);
+		void Clear();
+
+		// transfer_function 是 RGBA，每個 bin 4 個 float（與 transfer function widget 的輸出相同）。
+		// 回傳 distance map 是否有改變（需要重新上傳）。
+		bool Update(const std::vector<float>& transfer_function);
+
+		bool IsEmpty() const { return this->BrickBins.empty(); }
+		int GetBrickSize() const { return this->BrickSize; }
+		glm::ivec3 GetGridSize() const { return this->GridSize; }
+		const std::vector<uint8_t>& GetDistances() const { return this->Distances; }
+		unsigned int GetOccupiedBrickCount() const { return this->OccupiedBrickCount; }
+		unsigned int GetBrickCount() const { return (unsigned int)this->BrickBins.size(); }
+
+		// 不透明度高於這個值的 bin 才算可見。
+		void SetOpacityThreshold(float threshold) { this->OpacityThreshold = threshold; }
+
+	private:
+		int BrickSize = 8;
+		glm::ivec3 GridSize = glm::ivec3(0);
+		float OpacityThreshold = 0.0f;
+		// 每個 brick 可能取樣到的 bin 範圍（包含兩端），換 transfer function 的 bin 數量時需要重新計算。
+		std::vector<glm::vec2> BrickRanges;
+		std::vector<glm::ivec2> BrickBins;
+		std::vector<uint8_t> BinVisible;
+		std::vector<uint8_t> Occupied;
+		std::vector<uint8_t> Distances;
+		unsigned int OccupiedBrickCount = 0;
+
+		unsigned int GetIndex(int x, int y, int z) const { return static_cast<unsigned int>((z * this->GridSize.y + y) * this->GridSize.x + x); }
+
+		void ComputeBrickBins(unsigned int bin_count);
+		void ComputeDistances();
+	};
+}
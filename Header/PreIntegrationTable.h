@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Nexus {
+
+	// Pre-integrated classification (Engel et al. 2001). Instead of classifying single samples, a ray segment
+	// is classified by the values at its front and back end: entry (front, back) holds the premultiplied colour
+	// and opacity of a segment of StepSize voxels whose value changes linearly from front to back. Sharp peaks
+	// in the transfer function that fall between two samples are then no longer missed, so the ray caster can
+	// use a much larger step for the same image.
+	//
+	// The table uses the integral-function approximation: extinction tau = -ln(1 - alpha) per voxel and the
+	// emission tau * colour are integrated once into prefix sums, every entry is then O(1). When the transfer
+	// function changes, only the entries whose [front, back] interval overlaps the changed bins are recomputed.
+	class PreIntegrationTable {
+	public:
+		PreIntegrationTable() {}
+
+		// transfer_function 是 RGBA，每個 bin 4 個 float；step_size 以 voxel 為單位。回傳表格是否有改變。
+		bool Update(const std::vector<float>& transfer_function, float step_size);
+		void Clear();
+
+		bool IsEmpty() const { return this->Table.empty(); }
+		int GetSize() const { return this->Size; }
+		float GetStepSize() const { return this->StepSize; }
+		// Table[back * Size + front]，也就是 texture 的 x 是前一個樣本，y 是後一個樣本。
+		const std::vector<glm::vec4>& GetTable() const { return this->Table; }
+
+		// front、back 是正規化到 [0, 1] 的數值，與 GL_LINEAR 的 2D texture 相同的雙線性內插。
+		glm::vec4 Lookup(float front, float back) const;
+
+	private:
+		int Size = 0;
+		float StepSize = 1.0f;
+		std::vector<float> TransferFunction;
+		std::vector<glm::vec4> Table;
+		// 以 bin 為單位的前綴積分：xyz 是 emission（tau * 顏色），w 是 tau。
+		std::vector<glm::vec4> Integrals;
+
+		void ComputeIntegrals();
+		glm::vec4 ComputeEntry(int front, int back) const;
+	};
+}
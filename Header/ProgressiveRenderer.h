@@ -0,0 +1,110 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "NDCQuad.h"
+#include "Shader.h"
+
+namespace Nexus {
+
+	struct ProgressiveRenderSettings {
+		// 相機移動時 ray casting pass 的目標 GPU 時間，解析度比例依照量到的時間自動調整。
+		float TargetFrameMilliseconds = 12.0f;
+		float MinScale = 0.25f;
+		float MaxInteractiveScale = 0.75f;
+		// 相機移動時取樣間距的倍率。
+		float InteractiveStepScale = 2.0f;
+		// 矩陣連續幾個 frame 沒有改變才開始 refine，拖曳時偶爾沒有滑鼠事件的 frame 不會觸發一次完整的 ray casting。
+		int SettleFrames = 2;
+		// 靜止之後累積幾個 frame（每個 frame 的光線起點偏移不同），之後只把累積的結果畫出來。
+		int AccumulationFrames = 16;
+	};
+
+	// Progressive ray casting for interactive frame rates. While the view changes, the volume is ray cast
+	// into an offscreen target at a reduced resolution and with a larger step; the resolution follows the
+	// GPU time of the pass (timer queries) so that a moving camera stays near TargetFrameMilliseconds.
+	// Once the view is static, full-resolution frames with jittered ray offsets are averaged into an
+	// accumulation target, and after AccumulationFrames the volume is not ray cast at all until something
+	// changes: the stored image is only composited.
+	//
+	// The ray-casting shader is expected to output straight (non-premultiplied) colour with the usual
+	// SRC_ALPHA / ONE_MINUS_SRC_ALPHA blending; the offscreen targets hold premultiplied colour. The composite
+	// shader draws an NDCQuad (position at location 0, texture coordinate at location 1) and outputs
+	// texture(progressive_image, texcoord * texcoord_scale) unchanged. Neither shader is part of this tree.
+	class ProgressiveRenderer {
+	public:
+		ProgressiveRenderer() {}
+		~ProgressiveRenderer();
+
+		ProgressiveRenderer(const ProgressiveRenderer&) = delete;
+		ProgressiveRenderer& operator=(const ProgressiveRenderer&) = delete;
+
+		ProgressiveRenderSettings& GetSettings() { return this->Settings; }
+
+		// 每個 frame 呼叫一次，矩陣與上一個 frame 不同就回到互動模式。
+		void Update(const glm::mat4& model_view_projection);
+		// 畫面內容改變（transfer function、volume 等）時呼叫，累積的結果作廢，重新 refine。
+		void Invalidate();
+
+		// 回傳這個 frame 是否需要 ray casting；需要時已經切換到 offscreen target（建立失敗時就是原本的 framebuffer），
+		// 接著畫 volume 再呼叫 EndFrame。累積已經完成時回傳 false，仍然要呼叫 EndFrame 把結果畫出來。
+		bool BeginFrame();
+		void EndFrame(Nexus::Shader* composite_shader);
+		void Release();
+
+		// 給 ray casting shader 的 step_scale 與 ray_offset（以一個取樣間距為單位，[0, 1)）。
+		float GetStepScale() const { return this->IsInteractive ? this->Settings.InteractiveStepScale : 1.0f; }
+		float GetRayOffset() const { return this->RayOffset; }
+		glm::ivec2 GetRenderSize() const { return this->RenderSize; }
+
+		bool GetIsInteractive() const { return this->IsInteractive; }
+		bool GetIsConverged() const { return !this->IsInteractive && this->AccumulatedFrames >= this->Settings.AccumulationFrames; }
+		float GetScale() const { return this->Scale; }
+		int GetAccumulatedFrames() const { return this->AccumulatedFrames; }
+		float GetLastPassMilliseconds() const { return this->LastPassMilliseconds; }
+
+	private:
+		struct RenderTarget {
+			GLuint Framebuffer = 0;
+			GLuint Texture = 0;
+		};
+
+		ProgressiveRenderSettings Settings;
+		glm::mat4 LastMatrix = glm::mat4(0.0f);
+		bool HasLastMatrix = false;
+		int StaticFrames = 0;
+		bool IsInteractive = true;
+		int AccumulatedFrames = 0;
+		float Scale = 0.5f;
+		float RayOffset = 0.0f;
+		bool IsRendering = false;
+
+		glm::ivec2 Size = glm::ivec2(0);
+		glm::ivec2 RenderSize = glm::ivec2(0);
+		RenderTarget FrameTarget;
+		RenderTarget AccumulationTarget;
+		std::unique_ptr<NDCQuad> Quad;
+
+		// 前一個 framebuffer 與狀態，EndFrame 時還原。
+		GLint PreviousFramebuffer = 0;
+		GLint PreviousViewport[4] = { 0, 0, 0, 0 };
+		GLboolean PreviousBlend = GL_FALSE;
+		GLboolean PreviousDepthTest = GL_FALSE;
+		GLint PreviousBlendFunc[4] = { GL_ONE, GL_ZERO, GL_ONE, GL_ZERO };
+
+		// GL_TIME_ELAPSED 的結果晚幾個 frame 才拿得到，不等待，只在結果出來時調整 Scale。
+		GLuint TimerQuery = 0;
+		bool IsQueryPending = false;
+		bool IsQueryRunning = false;
+		float QueryScale = 0.5f;
+		float LastPassMilliseconds = 0.0f;
+
+		void Resize(glm::ivec2 size);
+		void ReleaseTarget(RenderTarget& target);
+		bool CreateTarget(RenderTarget& target, glm::ivec2 size);
+		void Composite(Nexus::Shader* composite_shader, GLuint texture, glm::vec2 texcoord_scale);
+		void PollTimerQuery();
+	};
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "BrickRangeGrid.h"
+#include "PreIntegrationTable.h"
+#include "TransferFunction2D.h"
+
+namespace Nexus {
+
+	// 沿著光線取最大值（MIP）、最小值（MinIP）或平均值，不使用 transfer function，輸出灰階；NONE 是一般的合成。
+	enum IntensityProjection {
+		INTENSITY_PROJECTION_NONE,
+		INTENSITY_PROJECTION_MAXIMUM,
+		INTENSITY_PROJECTION_MINIMUM,
+		INTENSITY_PROJECTION_AVERAGE
+	};
+
+	struct SoftwareRayCasterSettings {
+		// 取樣間距，以 voxel 為單位（取 Ratio 最小的方向）。
+		float StepSize = 0.5f;
+		// 累積的不透明度超過這個值就停止這條光線。
+		float EarlyTermination = 0.99f;
+		// 每個工作單位處理 TileSize x TileSize 個像素。
+		int TileSize = 16;
+		glm::vec4 Background = glm::vec4(0.0f);
+	};
+
+	// A CPU reference of the ray-casting path, for machines without a GPU and for regression images.
+	// Rays are cast in the model space of the volume's bounding box (0 to Resolution * Ratio, the same box
+	// IsoSurface draws) and sample the volume like a GL_LINEAR 3D texture, normalised by the volume maximum.
+	// Each sample is classified with the same RGBA transfer function table the GPU uses, linearly filtered
+	// between bins, or with a 2D transfer function over value and gradient magnitude. Samples are composited
+	// front to back with an opacity correction for the step size. The image is split into tiles that the
+	// thread pool renders in parallel. Trilinear sampling uses SSE when it is available.
+	//
+	// With an intensity projection the samples are reduced to their maximum, minimum or average instead and
+	// written as an opaque grey value. MIP and MinIP rays step brick by brick through a BrickRangeGrid and
+	// jump over bricks that cannot change the result, and stop once the volume maximum (minimum) is reached.
+	//
+	// The output is RGBA8, row 0 at the bottom like glReadPixels. The colour is composited over the background.
+	class SoftwareRayCaster {
+	public:
+		// max_value 是 data 的最大值（呼叫端已經算好的，例如 IsoSurface::MaxValue），用來把數值正規化成 [0, 1]。
+		SoftwareRayCaster(const std::vector<float>& data, glm::ivec3 resolution, glm::vec3 ratio, float max_value, const SoftwareRayCasterSettings& settings = SoftwareRayCasterSettings());
+
+		// RGBA，每個 bin 4 個 float（與 transfer function widget 的輸出相同）。
+		void SetTransferFunction(const std::vector<float>& transfer_function) { this->TransferFunction = transfer_function; }
+		// 設定之後每一段光線以前後兩個樣本查表，取樣間距改用表格的 StepSize，nullptr 表示逐點分類。
+		void SetPreIntegrationTable(const PreIntegrationTable* table) { this->PreIntegration = table; }
+		// 以（數值, gradient 長度）分類，gradient_magnitudes 每個 voxel 一個值，乘上 gradient_scale 之後是 [0, 1]。
+		// 設定之後優先於 1D transfer function 與 pre-integration，nullptr 表示不使用。
+		void SetTransferFunction2D(const TransferFunction2D* transfer_function, const std::vector<float>* gradient_magnitudes = nullptr, float gradient_scale = 1.0f) {
+			this->TransferFunction2DTable = transfer_function;
+			this->GradientMagnitudes = gradient_magnitudes;
+			this->GradientScale = gradient_scale;
+		}
+
+		// projection 是 IntensityProjection；bricks 為 nullptr 時逐點取樣，不跳過任何 brick。
+		void SetIntensityProjection(int projection, const BrickRangeGrid* bricks = nullptr) {
+			this->Projection = projection;
+			this->ProjectionBricks = bricks;
+		}
+
+		void Render(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, int width, int height, std::vector<uint8_t>& image);
+
+		uint64_t GetSampleCount() const { return this->SampleCount; }
+		uint64_t GetSkippedBrickCount() const { return this->SkippedBrickCount; }
+		double GetRenderSeconds() const { return this->RenderSeconds; }
+		double GetSamplesPerSecond() const { return this->RenderSeconds > 0.0 ? this->SampleCount / this->RenderSeconds : 0.0; }
+
+	private:
+		const std::vector<float>& Data;
+		glm::ivec3 Resolution;
+		glm::vec3 Ratio;
+		SoftwareRayCasterSettings Settings;
+		std::vector<float> TransferFunction;
+		const PreIntegrationTable* PreIntegration = nullptr;
+		const TransferFunction2D* TransferFunction2DTable = nullptr;
+		const std::vector<float>* GradientMagnitudes = nullptr;
+		float GradientScale = 1.0f;
+		float ValueScale = 1.0f;
+		int Projection = INTENSITY_PROJECTION_NONE;
+		const BrickRangeGrid* ProjectionBricks = nullptr;
+		uint64_t SampleCount = 0;
+		uint64_t SkippedBrickCount = 0;
+		double RenderSeconds = 0.0;
+
+		float Sample(const float* data, glm::vec3 voxel) const;
+		glm::vec4 Classify(float value) const;
+		glm::vec4 CastRay(glm::vec3 origin, glm::vec3 direction, uint64_t& samples, uint64_t& skipped_bricks) const;
+		float CastProjection(glm::vec3 origin, glm::vec3 direction, float t_enter, float t_exit, uint64_t& samples, uint64_t& skipped_bricks) const;
+	};
+}
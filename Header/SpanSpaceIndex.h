@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+#include "MinMaxOctree.h"
+
+namespace Nexus {
+
+	struct SpanInterval {
+		float Min;
+		float Max;
+		unsigned int ID;
+	};
+
+	// Span-space index over the bricks of a MinMaxOctree, stored as a static centered interval tree.
+	// Query(iso) reports every brick with Min <= iso < Max in O(log n + k), so moving the iso slider
+	// never touches the bricks that cannot contain the surface.
+	class SpanSpaceIndex {
+	public:
+		SpanSpaceIndex() {}
+
+		void Build(const MinMaxOctree& octree);
+		void Build(std::vector<SpanInterval> intervals);
+		void Clear();
+
+		void Query(float iso_value, std::vector<unsigned int>& result) const;
+
+		bool IsEmpty() const { return this->Nodes.empty(); }
+		unsigned int GetIntervalCount() const { return (unsigned int)this->ByMin.size(); }
+		unsigned int GetNodeCount() const { return (unsigned int)this->Nodes.size(); }
+
+	private:
+		struct Node {
+			float Center;
+			int Left = -1;
+			int Right = -1;
+			// ByMin / ByMax 中屬於此節點的區間（兩者長度相同）
+			unsigned int First = 0;
+			unsigned int Count = 0;
+		};
+
+		std::vector<Node> Nodes;
+		std::vector<SpanInterval> ByMin;
+		std::vector<SpanInterval> ByMax;
+
+		int BuildNode(std::vector<SpanInterval>& intervals);
+	};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "CubeClassifier.h"
+
+namespace Nexus {
+
+	// Naive surface nets (Gibson 1998). Instead of triangulating every cell like marching cubes, it places one
+	// vertex in every cell that straddles the iso value, at the average of the crossings on the cell's edges.
+	// Every edge with a sign change then emits a quad between the four cells around it. Vertices are shared by
+	// construction and there are roughly 3-4x fewer of them than marching cubes produces, which makes it a good
+	// fit for previews and interaction, at the price of slightly rounder features.
+	//
+	// The extraction runs in passes like FlyingEdges: the region is classified into sign bitmasks (CubeClassifier),
+	// every row of cells counts its active cells and quads, the counts are prefix-summed, and then every row writes
+	// its vertices and quads straight into the final arrays. The index of a cell's vertex is its row offset plus its
+	// rank in the active-cell bitmask of the row, so no per-cell index map is needed.
+	class SurfaceNets {
+	public:
+		SurfaceNets(const std::vector<float>& data, const std::vector<glm::vec3>& normals, glm::ivec3 resolution, glm::vec3 ratio);
+
+		// 只抽取 [voxel_min, voxel_max]（包含兩端）這個範圍內的 cell，頂點座標仍然是整個 volume 的座標。
+		void SetRegion(glm::ivec3 voxel_min, glm::ivec3 voxel_max);
+
+		// 範圍的第一層 cell 與前一個範圍重疊時（例如 progressive 抽取的 slab），這層 cell 上 z 方向的邊已經由前一個範圍輸出過，不再重複。
+		void SetSharedFirstSlice(bool shared) { this->SharedFirstSlice = shared; }
+
+		// Output vertices are interleaved (position, normal), 6 floats per vertex, every quad is split into two triangles.
+		void Extract(float iso_value, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+	private:
+		struct CellRowMeta {
+			unsigned int Vertices = 0;
+			unsigned int VertexOffset = 0;
+			unsigned int Quads = 0;
+			unsigned int QuadOffset = 0;
+		};
+
+		const std::vector<float>& Data;
+		const std::vector<glm::vec3>& Normals;
+		glm::ivec3 Resolution;
+		glm::vec3 Ratio;
+		// 實際處理的子區域，以下所有的 cell 座標都是相對於 Origin 的座標。
+		glm::ivec3 Origin = glm::ivec3(0);
+		glm::ivec3 Size;
+		bool SharedFirstSlice = false;
+		float IsoValue = 0.0f;
+
+		CubeClassifier Classifier;
+		// 每一列 cell 中跨越 iso value 的 cell（每個 cell 一個 bit）。
+		std::vector<uint64_t> ActiveCells;
+		unsigned int WordsPerRow = 0;
+		std::vector<CellRowMeta> CellRows;
+
+		unsigned int GetCellRowIndex(int y, int z) const { return static_cast<unsigned int>(z * (this->Size.y - 1) + y); }
+		size_t GetVoxelIndex(glm::ivec3 voxel) const { return (static_cast<size_t>(voxel.z + this->Origin.z) * this->Resolution.y + (voxel.y + this->Origin.y)) * this->Resolution.x + (voxel.x + this->Origin.x); }
+		bool HasQuad(uint8_t cube_index, int corner, bool has_neighbours) const { return has_neighbours && ((cube_index & 1) != 0) != ((cube_index & (1 << corner)) != 0); }
+
+		void CountCellRow(int y, int z, uint8_t* cube_indices);
+		void GenerateCellRow(int y, int z, uint8_t* cube_indices, float* vertices, unsigned int* indices) const;
+		unsigned int GetVertexIndex(int x, int y, int z) const;
+		void GenerateVertex(glm::ivec3 cell, uint8_t cube_index, float* vertex) const;
+	};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Nexus {
+	class ThreadPool {
+	public:
+		explicit ThreadPool(unsigned int thread_count = std::thread::hardware_concurrency());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Shared pool used by the volume processing code.
+		static ThreadPool& GetInstance();
+
+		template<typename Function>
+		auto Enqueue(Function&& function) -> std::future<decltype(function())> {
+			using ReturnType = decltype(function());
+			auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<Function>(function));
+			std::future<ReturnType> result = task->get_future();
+			{
+				std::unique_lock<std::mutex> lock(this->QueueMutex);
+				this->Tasks.emplace([task]() { (*task)(); });
+			}
+			this->Condition.notify_one();
+			return result;
+		}
+
+		// Split [begin, end) into chunks of at least grain_size and run body(chunk_begin, chunk_end) on the pool.
+		// The calling thread works on the chunks as well, so it is safe to call from inside a pool task.
+		void ParallelFor(unsigned int begin, unsigned int end, const std::function<void(unsigned int, unsigned int)>& body, unsigned int grain_size = 1);
+
+		unsigned int GetThreadCount() const { return (unsigned int)this->Workers.size(); }
+
+	private:
+		std::vector<std::thread> Workers;
+		std::queue<std::function<void()>> Tasks;
+		std::mutex QueueMutex;
+		std::condition_variable Condition;
+		bool IsStopping = false;
+	};
+}
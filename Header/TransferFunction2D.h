@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace Nexus {
+
+	enum TransferFunction2DShape {
+		TRANSFER_FUNCTION_2D_SHAPE_BOX,
+		// Kniss 的三角形 widget：頂點在 gradient 最小的地方，往 gradient 大的方向變寬，剛好框住邊界在 heatmap 上的拱形。
+		TRANSFER_FUNCTION_2D_SHAPE_TRIANGLE,
+		TRANSFER_FUNCTION_2D_SHAPE_ELLIPSE
+	};
+
+	// 座標與 gradient heatmap 的軸相同並正規化到 [0, 1]：x 是數值，y 是 gradient 長度（分貝化之後）。
+	struct TransferFunction2DRegion {
+		int Shape = TRANSFER_FUNCTION_2D_SHAPE_BOX;
+		glm::vec2 Center = glm::vec2(0.5f);
+		// 半寬與半高。
+		glm::vec2 Extent = glm::vec2(0.1f);
+		// rgb 是顏色，a 是區域中心的不透明度。
+		glm::vec4 Color = glm::vec4(1.0f);
+		// 邊緣淡出的寬度，佔區域大小的比例，0 表示硬邊。
+		float Softness = 0.25f;
+	};
+
+	// A two-dimensional transfer function over (value, gradient magnitude). The user draws regions on the
+	// gradient heatmap; each region is rasterised into a Size x Size RGBA table (straight colour, row = gradient)
+	// and later regions are composited over earlier ones. Boundaries between materials sit at high gradient
+	// magnitudes, so a region can isolate a boundary that a 1D transfer function can only reach together with
+	// the homogeneous tissue of the same value.
+	class TransferFunction2D {
+	public:
+		TransferFunction2D(int size = 256) : Size(std::max(size, 2)) {}
+
+		unsigned int AddRegion(const TransferFunction2DRegion& region);
+		void SetRegion(unsigned int index, const TransferFunction2DRegion& region);
+		void RemoveRegion(unsigned int index);
+		void ClearRegions();
+		const std::vector<TransferFunction2DRegion>& GetRegions() const { return this->Regions; }
+
+		// Region 改變之後重新產生表格，回傳表格是否有改變。
+		bool Update();
+
+		bool IsEmpty() const { return this->Regions.empty(); }
+		int GetSize() const { return this->Size; }
+		// Table[gradient * Size + value]，與 texture 的 (x, y) 相同。
+		const std::vector<glm::vec4>& GetTable() const { return this->Table; }
+		// 每個數值 bin 在所有 gradient 上的最大不透明度（RGBA，與 1D transfer function 相同的格式），給 empty space skipping 使用。
+		const std::vector<float>& GetValueProjection() const { return this->ValueProjection; }
+
+		// value、gradient 是正規化到 [0, 1] 的數值，與 GL_LINEAR 的 2D texture 相同的雙線性內插。
+		glm::vec4 Lookup(float value, float gradient) const;
+
+	private:
+		int Size = 256;
+		std::vector<TransferFunction2DRegion> Regions;
+		std::vector<glm::vec4> Table;
+		std::vector<float> ValueProjection;
+		bool IsDirty = true;
+
+		static float GetCoverage(const TransferFunction2DRegion& region, glm::vec2 point);
+	};
+}
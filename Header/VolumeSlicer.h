@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Nexus {
+
+	// 與 Application 的 DISPLAY_MODE_ORTHOGONAL_X/Y/Z 相同的順序：sagittal、coronal、axial。
+	enum SliceAxis {
+		SLICE_AXIS_X,
+		SLICE_AXIS_Y,
+		SLICE_AXIS_Z
+	};
+
+	struct SliceWindowLevel {
+		bool Enable = false;
+		// 以原始的數值為單位，顯示 [Level - Window / 2, Level + Window / 2]，範圍外的數值是黑或白。
+		float Window = 256.0f;
+		float Level = 128.0f;
+	};
+
+	// Orthogonal slices of a volume as 8-bit greyscale images for a 2D slice viewer. A z slice is a
+	// contiguous plane and a y slice is a set of contiguous rows, so both are mapped row by row straight
+	// from the volume. An x slice touches one value per cache line; instead of throwing the rest of every
+	// line away, the slicer copies a slab of SlabWidth neighbouring x slices at once (one cache line per
+	// row) and keeps it transposed, so scrolling through x reads the volume only once per slab.
+	//
+	// Values are mapped to [0, 255] with the window/level when it is enabled, or normalised by the volume
+	// maximum otherwise. Rows are extracted in parallel on the ThreadPool. Slice images are (u, v) with u
+	// fastest: x slices are (y, z), y slices are (x, z) and z slices are (x, y); row 0 is v = 0, which is
+	// the bottom row of a GL texture.
+	class VolumeSlicer {
+	public:
+		VolumeSlicer() {}
+
+		// data 必須在 slicer 使用期間保持有效，內容改變之後要再呼叫一次（丟掉快取的 slab）。
+		void SetVolume(const std::vector<float>* data, glm::ivec3 resolution, float value_max);
+		void Clear();
+
+		static glm::ivec2 GetSliceSize(glm::ivec3 resolution, int axis);
+		glm::ivec2 GetSliceSize(int axis) const { return GetSliceSize(this->Resolution, axis); }
+		int GetSliceCount(int axis) const { return this->Resolution[axis]; }
+
+		// axis 是 SliceAxis，index 超出範圍時 clamp 到最近的一張；volume 是空的時回傳 false。
+		bool Extract(int axis, int index, const SliceWindowLevel& window_level, std::vector<uint8_t>& slice);
+
+		// 從快取的 slab 取得的 x slice 數量，與重新讀取 volume 的次數。
+		unsigned int GetSlabHitCount() const { return this->SlabHitCount; }
+		unsigned int GetSlabFillCount() const { return this->SlabFillCount; }
+		double GetExtractSeconds() const { return this->ExtractSeconds; }
+
+	private:
+		// 一條 64 bytes 的 cache line 有 16 個 float。
+		static const int SlabWidth = 16;
+
+		const std::vector<float>* Data = nullptr;
+		glm::ivec3 Resolution = glm::ivec3(0);
+		float ValueMax = 0.0f;
+		// x 在 [SlabBegin, SlabBegin + SlabWidth) 的 slice，每張是連續的 (y, z) 平面。
+		std::vector<float> Slab;
+		int SlabBegin = -1;
+		unsigned int SlabHitCount = 0;
+		unsigned int SlabFillCount = 0;
+		double ExtractSeconds = 0.0;
+
+		void FillSlab(int x_begin);
+	};
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Nexus {
+
+	// 一張要串流上傳的 3D texture：Fill 把 [origin, origin + size) 的 voxel 依照 x、y、z 的順序緊密地寫進 destination。
+	struct VolumeStreamChannel {
+		GLuint Texture = 0;
+		GLenum Format = GL_RED;
+		GLenum Type = GL_UNSIGNED_BYTE;
+		size_t BytesPerVoxel = 1;
+		std::function<void(glm::ivec3 origin, glm::ivec3 size, uint8_t* destination)> Fill;
+	};
+
+	// Streams 3D textures to the GPU brick by brick instead of one blocking glTexImage3D. Every frame
+	// Update fills as many bricks as fit in the time budget straight into a ring of pixel buffer objects and
+	// issues glTexSubImage3D from them, so the copy to the GPU overlaps with rendering. Each ring slot is
+	// protected by a fence and is only reused once the GPU has consumed it; when no slot is free the frame
+	// simply stops early.
+	//
+	// The textures are cleared to zero when streaming starts and bricks are sent centre first. A brick-grid
+	// residency texture (R8, 255 = uploaded) tells the ray-casting shader which parts are valid, so a partial
+	// volume renders correctly while the rest arrives. Each brick is sent with a one-voxel apron on all six
+	// faces: with texel-centre sampling a GL_LINEAR sample anywhere inside a resident brick reads voxels from
+	// origin - 1 to origin + BrickSize, so it never blends with a neighbour that is still zero.
+	class VolumeTextureStreamer {
+	public:
+		VolumeTextureStreamer() {}
+		~VolumeTextureStreamer();
+
+		VolumeTextureStreamer(const VolumeTextureStreamer&) = delete;
+		VolumeTextureStreamer& operator=(const VolumeTextureStreamer&) = delete;
+
+		// 每個 frame 花在上傳的時間（毫秒），每個 frame 至少會上傳一個 brick。
+		void SetBudget(float milliseconds) { this->BudgetMilliseconds = std::max(milliseconds, 0.0f); }
+		float GetBudget() const { return this->BudgetMilliseconds; }
+		void SetBrickSize(int brick_size) { this->BrickSize = std::max(brick_size, 8); }
+		int GetBrickSize() const { return this->BrickSize; }
+
+		// Texture 必須已經配置好（glTexImage3D，資料為 nullptr）且與 volume_size 相同大小，之前未完成的串流會被取消。
+		void Start(glm::ivec3 volume_size, const std::vector<VolumeStreamChannel>& channels);
+		// 每個 frame 呼叫一次（OpenGL 的執行緒），回傳這個 frame 是否有新的 brick 完成。
+		bool Update();
+		void Cancel();
+		void Release();
+
+		bool GetIsStreaming() const { return !this->Channels.empty() && this->BrickCursor < this->BrickOrder.size(); }
+		float GetProgress() const { return this->BrickOrder.empty() ? 1.0f : (float)this->BrickCursor / this->BrickOrder.size(); }
+		unsigned int GetBrickCount() const { return (unsigned int)this->BrickOrder.size(); }
+		unsigned int GetResidentBrickCount() const { return (unsigned int)this->BrickCursor; }
+		GLuint GetResidencyTexture() const { return this->ResidencyTexture; }
+		glm::ivec3 GetBrickGridSize() const { return this->GridSize; }
+		double GetStreamSeconds() const { return this->StreamSeconds; }
+
+	private:
+		struct RingSlot {
+			GLuint Buffer = 0;
+			GLsync Fence = 0;
+		};
+
+		static const int RingSize = 3;
+
+		float BudgetMilliseconds = 4.0f;
+		int BrickSize = 64;
+		glm::ivec3 VolumeSize = glm::ivec3(0);
+		glm::ivec3 GridSize = glm::ivec3(0);
+		std::vector<VolumeStreamChannel> Channels;
+		// 上傳順序（brick 的線性索引），從中心往外。
+		std::vector<unsigned int> BrickOrder;
+		size_t BrickCursor = 0;
+		size_t ChannelCursor = 0;
+
+		RingSlot Ring[RingSize];
+		int NextSlot = 0;
+		size_t SlotCapacity = 0;
+
+		std::vector<uint8_t> Residency;
+		GLuint ResidencyTexture = 0;
+		glm::ivec3 ResidencyTextureSize = glm::ivec3(0);
+		std::chrono::system_clock::time_point StreamStart;
+		double StreamSeconds = 0.0;
+
+		glm::ivec3 GetBrickOrigin(unsigned int brick) const;
+		// 把 brick 的範圍往六個方向各擴大 apron 個 voxel（clamp 在 volume 內），上傳時為 1，清除時為 0。
+		void GetBrickRegion(glm::ivec3 origin, int apron, glm::ivec3& region_origin, glm::ivec3& region_size) const;
+		bool AcquireSlot(RingSlot& slot, bool wait);
+		void ClearTextures();
+		void UploadResidency();
+	};
+}
@@ -0,0 +1,43 @@
+#include "BrickRangeGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Nexus {
+
+	void BrickRangeGrid::Build(const MinMaxOctree& octree, glm::ivec3 resolution, float value_max) {
+		this->Clear();
+		if (octree.IsEmpty()) {
+			return;
+		}
+
+		this->BrickSize = octree.GetBrickSize();
+		this->Resolution = resolution;
+		this->GridSize = octree.GetBrickGridSize();
+		const float scale = value_max > 0.0f ? 1.0f / value_max : 1.0f;
+		this->Ranges.reserve(octree.GetBrickCount());
+		this->VolumeRange = glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+		for (const VolumeBrick& brick : octree.GetBricks()) {
+			glm::vec2 range = glm::vec2(brick.Min, brick.Max) * scale;
+			this->Ranges.push_back(range);
+			this->VolumeRange.x = std::min(this->VolumeRange.x, range.x);
+			this->VolumeRange.y = std::max(this->VolumeRange.y, range.y);
+		}
+	}
+
+	void BrickRangeGrid::Clear() {
+		this->Resolution = glm::ivec3(0);
+		this->GridSize = glm::ivec3(0);
+		this->Ranges.clear();
+		this->VolumeRange = glm::vec2(0.0f);
+	}
+
+	void BrickRangeGrid::GetBrickBounds(glm::ivec3 brick, glm::vec3& box_min, glm::vec3& box_max) const {
+		const float infinity = std::numeric_limits<float>::infinity();
+		for (int axis = 0; axis < 3; axis++) {
+			box_min[axis] = brick[axis] == 0 ? -infinity : (float)(brick[axis] * this->BrickSize);
+			box_max[axis] = brick[axis] == this->GridSize[axis] - 1 ? infinity : (float)((brick[axis] + 1) * this->BrickSize);
+		}
+	}
+}
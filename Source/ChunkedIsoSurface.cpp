@@ -0,0 +1,819 @@
+#include "ChunkedIsoSurface.h"
+#include "Logger.h"
+#include "MarchingCubesTable.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+
+namespace Nexus {
+
+	namespace {
+		// 與 IsoSurface::Polygonise、FlyingEdges 相同的角點順序與邊的定義。
+		const glm::ivec3 CORNER_OFFSETS[8] = {
+			glm::ivec3(0, 0, 0), glm::ivec3(1, 0, 0), glm::ivec3(1, 0, 1), glm::ivec3(0, 0, 1),
+			glm::ivec3(0, 1, 0), glm::ivec3(1, 1, 0), glm::ivec3(1, 1, 1), glm::ivec3(0, 1, 1)
+		};
+
+		const int EDGE_CORNERS[12][2] = {
+			{ 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+			{ 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 },
+			{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+		};
+
+		// Transition cell 的取樣點放在 3x3x3 的格點上（0、2 是角點，1 是邊的中點或面的中心），
+		// 面上的格點以 (u, v) 表示，先是繞一圈的外框，面中心存在時則拆成四個小正方形。
+		const int FACE_RING[8][2] = {
+			{ 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 }, { 2, 2 }, { 1, 2 }, { 0, 2 }, { 0, 1 }
+		};
+
+		const int FACE_QUADS[4][4][2] = {
+			{ { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } },
+			{ { 1, 0 }, { 2, 0 }, { 2, 1 }, { 1, 1 } },
+			{ { 1, 1 }, { 2, 1 }, { 2, 2 }, { 1, 2 } },
+			{ { 0, 1 }, { 1, 1 }, { 1, 2 }, { 0, 2 } }
+		};
+
+		int GetLatticeId(glm::ivec3 lattice) {
+			return lattice.x + 3 * lattice.y + 9 * lattice.z;
+		}
+
+		glm::ivec3 GetLattice(int id) {
+			return glm::ivec3(id % 3, (id / 3) % 3, id / 9);
+		}
+
+		uint32_t GetFaceBit(int axis, int side) {
+			return 1u << (axis * 2 + side);
+		}
+
+		// 沿著 axis 方向的 chunk 邊，side_b / side_c 分別是另外兩軸 ((axis + 1) % 3, (axis + 2) % 3) 的哪一側。
+		uint32_t GetEdgeBit(int axis, int side_b, int side_c) {
+			return 1u << (6 + axis * 4 + side_b + 2 * side_c);
+		}
+
+		// 一個 chunk 的輸出，共用邊上的頂點只產生一次。
+		class ChunkBuilder {
+		public:
+			ChunkBuilder(const std::vector<float>& data, const std::vector<glm::vec3>& normals, glm::ivec3 resolution, glm::vec3 ratio, float iso_value, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+				: Data(data), Normals(normals), Resolution(resolution), Ratio(ratio), IsoValue(iso_value), Vertices(vertices), Indices(indices) {}
+
+			size_t GetVoxelIndex(glm::ivec3 voxel) const {
+				return (static_cast<size_t>(voxel.z) * this->Resolution.y + voxel.y) * this->Resolution.x + voxel.x;
+			}
+
+			float GetValue(glm::ivec3 voxel) const {
+				return this->Data[this->GetVoxelIndex(voxel)];
+			}
+
+			bool IsAbove(glm::ivec3 voxel) const {
+				return this->GetValue(voxel) > this->IsoValue;
+			}
+
+			// a、b 是只差一個軸的兩個 voxel。與 FlyingEdges::GeneratePoint 相同，固定從座標較小的一端內插，
+			// 相鄰 chunk（不論 level）在同一條邊上算出來的頂點才會完全一致。
+			unsigned int GetVertex(glm::ivec3 a, glm::ivec3 b) {
+				if (b.x + b.y + b.z < a.x + a.y + a.z) {
+					std::swap(a, b);
+				}
+				int axis = (a.x != b.x) ? 0 : ((a.y != b.y) ? 1 : 2);
+				size_t index_a = this->GetVoxelIndex(a);
+				size_t index_b = this->GetVoxelIndex(b);
+				uint64_t key = ((static_cast<uint64_t>(index_a) * 3 + axis) << 16) | static_cast<uint64_t>(b[axis] - a[axis]);
+
+				auto found = this->EdgeVertices.find(key);
+				if (found != this->EdgeVertices.end()) {
+					return found->second;
+				}
+
+				float value_a = this->Data[index_a];
+				float value_b = this->Data[index_b];
+				float proportion = 0.0f;
+				if (std::abs(this->IsoValue - value_a) < 0.00001f) {
+					proportion = 0.0f;
+				} else if (std::abs(this->IsoValue - value_b) < 0.00001f) {
+					proportion = 1.0f;
+				} else if (std::abs(value_a - value_b) >= 0.00001f) {
+					proportion = (this->IsoValue - value_a) / (value_b - value_a);
+				}
+
+				glm::vec3 position = (glm::vec3(a) + proportion * glm::vec3(b - a)) * this->Ratio;
+				glm::vec3 normal = glm::normalize(this->Normals[index_a] + proportion * (this->Normals[index_b] - this->Normals[index_a]));
+				unsigned int id = this->AddVertex(position, normal);
+				this->EdgeVertices.emplace(key, id);
+				return id;
+			}
+
+			unsigned int AddVertex(glm::vec3 position, glm::vec3 normal) {
+				unsigned int id = (unsigned int)(this->Vertices.size() / 6);
+				this->Vertices.insert(this->Vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z });
+				return id;
+			}
+
+			glm::vec3 GetPosition(unsigned int id) const {
+				const float* vertex = &this->Vertices[static_cast<size_t>(id) * 6];
+				return glm::vec3(vertex[0], vertex[1], vertex[2]);
+			}
+
+			glm::vec3 GetNormal(unsigned int id) const {
+				const float* vertex = &this->Vertices[static_cast<size_t>(id) * 6];
+				return glm::vec3(vertex[3], vertex[4], vertex[5]);
+			}
+
+			void AddTriangle(unsigned int a, unsigned int b, unsigned int c) {
+				this->Indices.insert(this->Indices.end(), { a, b, c });
+			}
+
+		private:
+			const std::vector<float>& Data;
+			const std::vector<glm::vec3>& Normals;
+			glm::ivec3 Resolution;
+			glm::vec3 Ratio;
+			float IsoValue;
+			std::vector<float>& Vertices;
+			std::vector<unsigned int>& Indices;
+			std::unordered_map<uint64_t, unsigned int> EdgeVertices;
+		};
+
+		// 把一個 transition cell 當成多面體來切：逐面找出與表面的交點並連成線段，再把線段接成封閉的迴圈。
+		class TransitionCell {
+		public:
+			TransitionCell(ChunkBuilder& builder, const bool* present, const glm::ivec3* voxels)
+				: Builder(builder), Present(present), Voxels(voxels) {
+				for (int i = 0; i < 27; i++) {
+					this->Above[i] = present[i] && builder.IsAbove(voxels[i]);
+				}
+			}
+
+			void Polygonise() {
+				for (int axis = 0; axis < 3; axis++) {
+					for (int side = 0; side < 2; side++) {
+						this->ContourFace(axis, side);
+					}
+				}
+				this->BuildLoops();
+			}
+
+		private:
+			struct Crossing {
+				int A;
+				int B;
+				int Segments[2];
+				int SegmentCount;
+			};
+
+			ChunkBuilder& Builder;
+			const bool* Present;
+			const glm::ivec3* Voxels;
+			bool Above[27];
+			std::vector<Crossing> Crossings;
+			std::vector<std::pair<int, int>> Segments;
+
+			int GetFaceLatticeId(int axis, int side, int u, int v) const {
+				glm::ivec3 lattice;
+				lattice[axis] = side * 2;
+				lattice[(axis + 1) % 3] = u;
+				lattice[(axis + 2) % 3] = v;
+				return GetLatticeId(lattice);
+			}
+
+			int GetCrossing(int a, int b) {
+				if (b < a) {
+					std::swap(a, b);
+				}
+				for (size_t i = 0; i < this->Crossings.size(); i++) {
+					if (this->Crossings[i].A == a && this->Crossings[i].B == b) {
+						return (int)i;
+					}
+				}
+				this->Crossings.push_back({ a, b, { -1, -1 }, 0 });
+				return (int)this->Crossings.size() - 1;
+			}
+
+			void ContourFace(int axis, int side) {
+				int center = this->GetFaceLatticeId(axis, side, 1, 1);
+				if (this->Present[center]) {
+					for (int q = 0; q < 4; q++) {
+						int polygon[4];
+						for (int k = 0; k < 4; k++) {
+							polygon[k] = this->GetFaceLatticeId(axis, side, FACE_QUADS[q][k][0], FACE_QUADS[q][k][1]);
+						}
+						this->ContourPolygon(polygon, 4);
+					}
+				} else {
+					int polygon[8];
+					int count = 0;
+					for (int k = 0; k < 8; k++) {
+						int id = this->GetFaceLatticeId(axis, side, FACE_RING[k][0], FACE_RING[k][1]);
+						if (this->Present[id]) {
+							polygon[count++] = id;
+						}
+					}
+					this->ContourPolygon(polygon, count);
+				}
+			}
+
+			// 交點沿著外框依序是「進入 iso value 以上」與「離開」交替出現。每一段以上的區域由它兩端的交點切開，
+			// 這個配對方式與走訪的方向、起點無關，共用這個面的兩個 cell 會得到一樣的線段。
+			void ContourPolygon(const int* polygon, int count) {
+				int crossings[8];
+				bool entering[8];
+				int crossing_count = 0;
+				for (int k = 0; k < count; k++) {
+					int a = polygon[k];
+					int b = polygon[(k + 1) % count];
+					if (this->Above[a] != this->Above[b]) {
+						crossings[crossing_count] = this->GetCrossing(a, b);
+						entering[crossing_count] = this->Above[b];
+						crossing_count++;
+					}
+				}
+				if (crossing_count == 0) {
+					return;
+				}
+
+				int first = 0;
+				while (!entering[first]) {
+					first++;
+				}
+				for (int k = 0; k < crossing_count; k += 2) {
+					int from = crossings[(first + k) % crossing_count];
+					int to = crossings[(first + k + 1) % crossing_count];
+					int segment = (int)this->Segments.size();
+					this->Segments.push_back({ from, to });
+					for (int id : { from, to }) {
+						Crossing& crossing = this->Crossings[id];
+						if (crossing.SegmentCount < 2) {
+							crossing.Segments[crossing.SegmentCount] = segment;
+						}
+						crossing.SegmentCount++;
+					}
+				}
+			}
+
+			void BuildLoops() {
+				// 每個交點都剛好在兩個面上，所以剛好屬於兩條線段；不成立時代表資料有問題，直接放棄這個 cell。
+				for (const Crossing& crossing : this->Crossings) {
+					if (crossing.SegmentCount != 2) {
+						return;
+					}
+				}
+
+				std::vector<char> used(this->Segments.size(), 0);
+				std::vector<unsigned int> loop;
+				for (size_t start = 0; start < this->Segments.size(); start++) {
+					if (used[start]) {
+						continue;
+					}
+					loop.clear();
+					int segment = (int)start;
+					int crossing = this->Segments[start].first;
+					while (!used[segment]) {
+						used[segment] = 1;
+						const Crossing& current = this->Crossings[crossing];
+						loop.push_back(this->Builder.GetVertex(this->Voxels[current.A], this->Voxels[current.B]));
+						crossing = (this->Segments[segment].first == crossing) ? this->Segments[segment].second : this->Segments[segment].first;
+						const Crossing& next = this->Crossings[crossing];
+						segment = (next.Segments[0] == segment) ? next.Segments[1] : next.Segments[0];
+					}
+					this->Triangulate(loop);
+				}
+			}
+
+			// 迴圈的繞向調整成與 marching cubes 一樣（朝向數值較低的一側），超過三個點時以中心點做扇形。
+			void Triangulate(std::vector<unsigned int>& loop) {
+				if (loop.size() < 3) {
+					return;
+				}
+
+				glm::vec3 area(0.0f);
+				glm::vec3 gradient(0.0f);
+				glm::vec3 centroid(0.0f);
+				for (size_t i = 0; i < loop.size(); i++) {
+					glm::vec3 p = this->Builder.GetPosition(loop[i]);
+					glm::vec3 q = this->Builder.GetPosition(loop[(i + 1) % loop.size()]);
+					area += glm::cross(p, q);
+					gradient += this->Builder.GetNormal(loop[i]);
+					centroid += p;
+				}
+				if (glm::dot(area, gradient) > 0.0f) {
+					std::reverse(loop.begin(), loop.end());
+				}
+
+				if (loop.size() == 3) {
+					this->Builder.AddTriangle(loop[0], loop[1], loop[2]);
+					return;
+				}
+
+				float length = glm::length(gradient);
+				glm::vec3 normal = length > 0.0f ? gradient / length : this->Builder.GetNormal(loop[0]);
+				unsigned int center = this->Builder.AddVertex(centroid / (float)loop.size(), normal);
+				for (size_t i = 0; i < loop.size(); i++) {
+					this->Builder.AddTriangle(center, loop[i], loop[(i + 1) % loop.size()]);
+				}
+			}
+		};
+	}
+
+	size_t ChunkedIsoSurface::ChunkKeyHash::operator()(const ChunkKey& key) const {
+		size_t hash = std::hash<unsigned int>()(key.Chunk);
+		hash ^= std::hash<int>()(key.Level) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<float>()(key.IsoValue) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<uint32_t>()(key.TransitionMask) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+
+	ChunkedIsoSurface::ChunkedIsoSurface(const std::vector<float>& data, const std::vector<glm::vec3>& normals, glm::ivec3 resolution, glm::vec3 ratio, int chunk_size, int max_level)
+		: Data(data), Normals(normals), Resolution(resolution), Ratio(ratio), ChunkSize(std::max(chunk_size, 1)), MaxLevel(std::max(max_level, 0)) {
+
+		// 每個 level 的 cell 都必須剛好排滿一個 chunk。
+		while (this->MaxLevel > 0 && this->ChunkSize % (1 << this->MaxLevel) != 0) {
+			this->MaxLevel--;
+		}
+		this->MaxPendingJobs = std::max(ThreadPool::GetInstance().GetThreadCount() * 2, 4u);
+
+		glm::ivec3 cells = glm::max(this->Resolution - glm::ivec3(1), glm::ivec3(0));
+		this->ChunkCount = (cells + glm::ivec3(this->ChunkSize - 1)) / this->ChunkSize;
+		this->Chunks.resize(static_cast<size_t>(this->ChunkCount.x) * this->ChunkCount.y * this->ChunkCount.z);
+		for (int z = 0; z < this->ChunkCount.z; z++) {
+			for (int y = 0; y < this->ChunkCount.y; y++) {
+				for (int x = 0; x < this->ChunkCount.x; x++) {
+					Chunk& chunk = this->Chunks[this->GetChunkIndex(x, y, z)];
+					chunk.Origin = glm::ivec3(x, y, z) * this->ChunkSize;
+					chunk.Extent = glm::min(glm::ivec3(this->ChunkSize), cells - chunk.Origin);
+				}
+			}
+		}
+		this->ComputeChunkRanges();
+		Logger::Message(LOG_DEBUG, "Chunked iso surface: " + std::to_string(this->Chunks.size()) + " chunks of " + std::to_string(this->ChunkSize) + "^3 cells, " + std::to_string(this->MaxLevel + 1) + " levels.");
+	}
+
+	ChunkedIsoSurface::~ChunkedIsoSurface() {
+		// 背景工作仍然參考著 volume 資料，必須等它們結束。
+		for (PendingJob& job : this->Pending) {
+			if (job.Result.valid()) {
+				job.Result.wait();
+			}
+		}
+		for (auto& entry : this->Cache) {
+			this->Release(entry.second);
+		}
+	}
+
+	void ChunkedIsoSurface::ComputeChunkRanges() {
+		ThreadPool::GetInstance().ParallelFor(0, (unsigned int)this->Chunks.size(), [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				Chunk& chunk = this->Chunks[i];
+				float min_value = std::numeric_limits<float>::max();
+				float max_value = std::numeric_limits<float>::lowest();
+				// 包含與下一個 chunk 共用的那一層 voxel。
+				glm::ivec3 last = chunk.Origin + chunk.Extent;
+				for (int z = chunk.Origin.z; z <= last.z; z++) {
+					for (int y = chunk.Origin.y; y <= last.y; y++) {
+						const float* row = &this->Data[this->GetVoxelIndex(glm::ivec3(0, y, z))];
+						for (int x = chunk.Origin.x; x <= last.x; x++) {
+							min_value = std::min(min_value, row[x]);
+							max_value = std::max(max_value, row[x]);
+						}
+					}
+				}
+				chunk.MinValue = min_value;
+				chunk.MaxValue = max_value;
+			}
+		});
+	}
+
+	void ChunkedIsoSurface::SelectLevels(const glm::vec3& camera_position, const glm::mat4& model) {
+		glm::vec3 camera = glm::vec3(glm::inverse(model) * glm::vec4(camera_position, 1.0f));
+		for (Chunk& chunk : this->Chunks) {
+			glm::vec3 box_min = glm::vec3(chunk.Origin) * this->Ratio;
+			glm::vec3 box_max = glm::vec3(chunk.Origin + chunk.Extent) * this->Ratio;
+			float distance = glm::length(glm::max(glm::max(box_min - camera, camera - box_max), glm::vec3(0.0f)));
+			chunk.Distance = distance;
+			if (distance < this->LevelDistance) {
+				chunk.Level = 0;
+			} else {
+				chunk.Level = std::min(this->MaxLevel, (int)std::floor(std::log2(distance / this->LevelDistance)) + 1);
+			}
+		}
+
+		// 讓相鄰（包含邊與角）的 chunk 最多只差一個 level，transition cell 只需要處理 2:1 的情況。
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (int z = 0; z < this->ChunkCount.z; z++) {
+				for (int y = 0; y < this->ChunkCount.y; y++) {
+					for (int x = 0; x < this->ChunkCount.x; x++) {
+						Chunk& chunk = this->Chunks[this->GetChunkIndex(x, y, z)];
+						for (int dz = -1; dz <= 1; dz++) {
+							for (int dy = -1; dy <= 1; dy++) {
+								for (int dx = -1; dx <= 1; dx++) {
+									glm::ivec3 neighbor(x + dx, y + dy, z + dz);
+									if (!this->IsInside(neighbor)) {
+										continue;
+									}
+									int limit = this->Chunks[this->GetChunkIndex(neighbor.x, neighbor.y, neighbor.z)].Level + 1;
+									if (chunk.Level > limit) {
+										chunk.Level = limit;
+										changed = true;
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	uint32_t ChunkedIsoSurface::GetTransitionMask(unsigned int index) const {
+		int level = this->Chunks[index].Level;
+		if (level == 0) {
+			return 0;
+		}
+
+		glm::ivec3 coordinate(index % this->ChunkCount.x, (index / this->ChunkCount.x) % this->ChunkCount.y, index / (this->ChunkCount.x * this->ChunkCount.y));
+		auto is_finer = [&](glm::ivec3 neighbor) {
+			if (!this->IsInside(neighbor)) {
+				return false;
+			}
+			return this->Chunks[this->GetChunkIndex(neighbor.x, neighbor.y, neighbor.z)].Level < level;
+		};
+
+		uint32_t mask = 0;
+		for (int axis = 0; axis < 3; axis++) {
+			glm::ivec3 step(0);
+			step[axis] = 1;
+			if (is_finer(coordinate - step)) mask |= GetFaceBit(axis, 0);
+			if (is_finer(coordinate + step)) mask |= GetFaceBit(axis, 1);
+		}
+
+		// 一條 chunk 邊由四個 chunk 共用，其他三個之中只要有比較細的，這條邊上就需要中點。
+		for (int axis = 0; axis < 3; axis++) {
+			glm::ivec3 step_b(0), step_c(0);
+			step_b[(axis + 1) % 3] = 1;
+			step_c[(axis + 2) % 3] = 1;
+			for (int side_c = 0; side_c < 2; side_c++) {
+				for (int side_b = 0; side_b < 2; side_b++) {
+					glm::ivec3 offset_b = step_b * (side_b ? 1 : -1);
+					glm::ivec3 offset_c = step_c * (side_c ? 1 : -1);
+					if (is_finer(coordinate + offset_b) || is_finer(coordinate + offset_c) || is_finer(coordinate + offset_b + offset_c)) {
+						mask |= GetEdgeBit(axis, side_b, side_c);
+					}
+				}
+			}
+		}
+		return mask;
+	}
+
+	ChunkedIsoSurface::ChunkKey ChunkedIsoSurface::GetKey(unsigned int index) const {
+		ChunkKey key;
+		key.Chunk = index;
+		key.Level = this->Chunks[index].Level;
+		key.IsoValue = this->IsoValue;
+		key.TransitionMask = this->GetTransitionMask(index);
+		return key;
+	}
+
+	bool ChunkedIsoSurface::IsPending(const ChunkKey& key) const {
+		for (const PendingJob& job : this->Pending) {
+			if (job.Key == key) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void ChunkedIsoSurface::Update(const glm::vec3& camera_position, const glm::mat4& model) {
+		this->Frame++;
+		this->SelectLevels(camera_position, model);
+		this->CollectFinishedJobs();
+
+		// 找出每個 chunk 目前需要的版本，快取裡沒有的就排進背景工作（近的先做），還沒好之前繼續畫舊的。
+		std::vector<std::pair<float, unsigned int>> requests;
+		this->ActiveChunkCount = 0;
+		for (unsigned int i = 0; i < (unsigned int)this->Chunks.size(); i++) {
+			Chunk& chunk = this->Chunks[i];
+			if (!this->IsActive(chunk)) {
+				chunk.HasDisplayed = false;
+				continue;
+			}
+			this->ActiveChunkCount++;
+
+			ChunkKey key = this->GetKey(i);
+			auto found = this->Cache.find(key);
+			if (found != this->Cache.end()) {
+				chunk.Displayed = key;
+				chunk.HasDisplayed = true;
+				found->second.LastUsedFrame = this->Frame;
+				continue;
+			}
+
+			if (chunk.HasDisplayed) {
+				auto displayed = this->Cache.find(chunk.Displayed);
+				if (displayed != this->Cache.end()) {
+					displayed->second.LastUsedFrame = this->Frame;
+				} else {
+					chunk.HasDisplayed = false;
+				}
+			}
+			if (!this->IsPending(key)) {
+				requests.push_back({ chunk.Distance, i });
+			}
+		}
+
+		std::sort(requests.begin(), requests.end());
+		for (const auto& request : requests) {
+			if (this->Pending.size() >= this->MaxPendingJobs) {
+				break;
+			}
+			const Chunk& chunk = this->Chunks[request.second];
+			PendingJob job;
+			job.Key = this->GetKey(request.second);
+			glm::ivec3 origin = chunk.Origin;
+			glm::ivec3 extent = chunk.Extent;
+			int level = job.Key.Level;
+			float iso_value = job.Key.IsoValue;
+			uint32_t mask = job.Key.TransitionMask;
+			job.Result = ThreadPool::GetInstance().Enqueue([this, origin, extent, level, iso_value, mask]() {
+				return this->ExtractChunk(origin, extent, level, iso_value, mask);
+			});
+			this->Pending.push_back(std::move(job));
+		}
+
+		this->EvictCache();
+	}
+
+	void ChunkedIsoSurface::CollectFinishedJobs() {
+		unsigned int uploads = 0;
+		for (size_t i = 0; i < this->Pending.size() && uploads < this->UploadBudget;) {
+			PendingJob& job = this->Pending[i];
+			if (job.Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				i++;
+				continue;
+			}
+			ChunkGeometry geometry = job.Result.get();
+			if (this->Cache.find(job.Key) == this->Cache.end()) {
+				this->Upload(job.Key, geometry);
+				uploads++;
+			}
+			this->Pending.erase(this->Pending.begin() + i);
+		}
+	}
+
+	void ChunkedIsoSurface::Upload(const ChunkKey& key, const ChunkGeometry& geometry) {
+		ChunkMesh mesh;
+		mesh.IndexCount = (unsigned int)geometry.Indices.size();
+		mesh.Bytes = sizeof(ChunkMesh) + geometry.Vertices.size() * sizeof(float) + geometry.Indices.size() * sizeof(unsigned int);
+		mesh.LastUsedFrame = this->Frame;
+
+		// 沒有三角形的 chunk 也要記錄下來，才不會一直重新抽取。
+		if (mesh.IndexCount > 0) {
+			glGenVertexArrays(1, &mesh.VAO);
+			glGenBuffers(1, &mesh.VBO);
+			glGenBuffers(1, &mesh.EBO);
+			glBindVertexArray(mesh.VAO);
+			glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+			glBufferData(GL_ARRAY_BUFFER, geometry.Vertices.size() * sizeof(float), geometry.Vertices.data(), GL_STATIC_DRAW);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, geometry.Indices.size() * sizeof(unsigned int), geometry.Indices.data(), GL_STATIC_DRAW);
+			glBindVertexArray(0);
+		}
+
+		this->CacheBytes += mesh.Bytes;
+		this->Cache.emplace(key, mesh);
+	}
+
+	void ChunkedIsoSurface::EvictCache() {
+		if (this->CacheBytes <= this->CacheBudget) {
+			return;
+		}
+
+		// 這個 frame 有用到的（正在畫的）不會被丟掉。
+		std::vector<std::pair<uint64_t, ChunkKey>> candidates;
+		for (const auto& entry : this->Cache) {
+			if (entry.second.LastUsedFrame < this->Frame) {
+				candidates.push_back({ entry.second.LastUsedFrame, entry.first });
+			}
+		}
+		std::sort(candidates.begin(), candidates.end(), [](const std::pair<uint64_t, ChunkKey>& a, const std::pair<uint64_t, ChunkKey>& b) {
+			return a.first < b.first;
+		});
+
+		for (const auto& candidate : candidates) {
+			if (this->CacheBytes <= this->CacheBudget) {
+				break;
+			}
+			auto found = this->Cache.find(candidate.second);
+			this->CacheBytes -= found->second.Bytes;
+			this->Release(found->second);
+			this->Cache.erase(found);
+		}
+	}
+
+	void ChunkedIsoSurface::Release(ChunkMesh& mesh) {
+		if (mesh.EBO != 0) {
+			glDeleteBuffers(1, &mesh.EBO);
+		}
+		if (mesh.VBO != 0) {
+			glDeleteBuffers(1, &mesh.VBO);
+		}
+		if (mesh.VAO != 0) {
+			glDeleteVertexArrays(1, &mesh.VAO);
+		}
+		mesh.EBO = mesh.VBO = mesh.VAO = 0;
+	}
+
+	void ChunkedIsoSurface::Draw(Nexus::Shader* shader, glm::mat4 model) {
+		shader->Use();
+		shader->SetMat4("model", model);
+		shader->SetMat3("normalModel", glm::mat3(glm::transpose(glm::inverse(model))));
+		shader->SetBool("is_volume", true);
+
+		this->DrawnChunkCount = 0;
+		this->DrawnTriangleCount = 0;
+		for (const Chunk& chunk : this->Chunks) {
+			if (!chunk.HasDisplayed) {
+				continue;
+			}
+			auto found = this->Cache.find(chunk.Displayed);
+			if (found == this->Cache.end() || found->second.IndexCount == 0) {
+				continue;
+			}
+			glBindVertexArray(found->second.VAO);
+			glDrawElements(GL_TRIANGLES, (GLsizei)found->second.IndexCount, GL_UNSIGNED_INT, 0);
+			this->DrawnChunkCount++;
+			this->DrawnTriangleCount += found->second.IndexCount / 3;
+		}
+		glBindVertexArray(0);
+	}
+
+	void ChunkedIsoSurface::Extract(const glm::vec3& camera_position, const glm::mat4& model, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+		this->SelectLevels(camera_position, model);
+
+		std::vector<unsigned int> active;
+		for (unsigned int i = 0; i < (unsigned int)this->Chunks.size(); i++) {
+			if (this->IsActive(this->Chunks[i])) {
+				active.push_back(i);
+			}
+		}
+		this->ActiveChunkCount = (unsigned int)active.size();
+
+		std::vector<ChunkKey> keys(active.size());
+		for (size_t i = 0; i < active.size(); i++) {
+			keys[i] = this->GetKey(active[i]);
+		}
+
+		std::vector<ChunkGeometry> results(active.size());
+		ThreadPool::GetInstance().ParallelFor(0, (unsigned int)active.size(), [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				const Chunk& chunk = this->Chunks[active[i]];
+				results[i] = this->ExtractChunk(chunk.Origin, chunk.Extent, keys[i].Level, keys[i].IsoValue, keys[i].TransitionMask);
+			}
+		});
+
+		size_t vertex_total = 0;
+		size_t index_total = 0;
+		for (const ChunkGeometry& result : results) {
+			vertex_total += result.Vertices.size();
+			index_total += result.Indices.size();
+		}
+		vertices.clear();
+		indices.clear();
+		vertices.reserve(vertex_total);
+		indices.reserve(index_total);
+		for (const ChunkGeometry& result : results) {
+			unsigned int offset = (unsigned int)(vertices.size() / 6);
+			vertices.insert(vertices.end(), result.Vertices.begin(), result.Vertices.end());
+			for (unsigned int index : result.Indices) {
+				indices.push_back(index + offset);
+			}
+		}
+	}
+
+	ChunkedIsoSurface::ChunkGeometry ChunkedIsoSurface::ExtractChunk(glm::ivec3 origin, glm::ivec3 extent, int level, float iso_value, uint32_t transition_mask) const {
+		ChunkGeometry geometry;
+		ChunkBuilder builder(this->Data, this->Normals, this->Resolution, this->Ratio, iso_value, geometry.Vertices, geometry.Indices);
+
+		const int step = 1 << level;
+		const int half = step / 2;
+		const glm::ivec3 end = origin + extent;
+		// 體積尾端的 chunk 不一定是 step 的倍數，最後一個 cell 的座標夾在 chunk 的邊界上；
+		// 各個 level 的取樣點都用同樣的方式夾住，所以相鄰 chunk 仍然共用同一組取樣點。
+		const glm::ivec3 cells = (extent + glm::ivec3(step - 1)) / step;
+		auto clamp_voxel = [&](glm::ivec3 voxel) { return glm::min(voxel, end); };
+
+		glm::ivec3 corners[8];
+		float values[8];
+		unsigned int edge_vertices[12];
+		bool present[27];
+		glm::ivec3 voxels[27];
+
+		for (int k = 0; k < cells.z; k++) {
+			for (int j = 0; j < cells.y; j++) {
+				for (int i = 0; i < cells.x; i++) {
+					glm::ivec3 cell(i, j, k);
+					glm::ivec3 base = origin + cell * step;
+
+					// 判斷這個 cell 是否碰到需要 transition 的 chunk 邊界：記錄每個軸上是貼著哪一側（-1 表示都沒有）。
+					bool transition = false;
+					if (transition_mask != 0) {
+						std::fill(present, present + 27, false);
+						int sides[3][2];
+						for (int axis = 0; axis < 3; axis++) {
+							sides[axis][0] = (cell[axis] == 0) ? 0 : -1;
+							sides[axis][1] = (cell[axis] == cells[axis] - 1) ? 1 : -1;
+						}
+
+						// 12 條邊的中點。
+						for (int axis = 0; axis < 3; axis++) {
+							int axis_b = (axis + 1) % 3;
+							int axis_c = (axis + 2) % 3;
+							for (int lattice_c = 0; lattice_c <= 2; lattice_c += 2) {
+								for (int lattice_b = 0; lattice_b <= 2; lattice_b += 2) {
+									int side_b = sides[axis_b][lattice_b / 2];
+									int side_c = sides[axis_c][lattice_c / 2];
+									bool hanging = (side_b >= 0 && (transition_mask & GetFaceBit(axis_b, side_b)))
+										|| (side_c >= 0 && (transition_mask & GetFaceBit(axis_c, side_c)))
+										|| (side_b >= 0 && side_c >= 0 && (transition_mask & GetEdgeBit(axis, side_b, side_c)));
+									if (hanging) {
+										glm::ivec3 lattice;
+										lattice[axis] = 1;
+										lattice[axis_b] = lattice_b;
+										lattice[axis_c] = lattice_c;
+										present[GetLatticeId(lattice)] = true;
+										transition = true;
+									}
+								}
+							}
+						}
+
+						// 6 個面的中心。
+						for (int axis = 0; axis < 3; axis++) {
+							for (int side = 0; side < 2; side++) {
+								if (sides[axis][side] >= 0 && (transition_mask & GetFaceBit(axis, side))) {
+									glm::ivec3 lattice(1);
+									lattice[axis] = side * 2;
+									present[GetLatticeId(lattice)] = true;
+									transition = true;
+								}
+							}
+						}
+					}
+
+					if (transition) {
+						for (int c = 0; c < 8; c++) {
+							present[GetLatticeId(CORNER_OFFSETS[c] * 2)] = true;
+						}
+						bool any_above = false;
+						bool any_below = false;
+						for (int id = 0; id < 27; id++) {
+							if (!present[id]) {
+								continue;
+							}
+							voxels[id] = clamp_voxel(base + GetLattice(id) * half);
+							bool above = builder.IsAbove(voxels[id]);
+							any_above |= above;
+							any_below |= !above;
+						}
+						if (any_above && any_below) {
+							TransitionCell(builder, present, voxels).Polygonise();
+						}
+						continue;
+					}
+
+					int cube_index = 0;
+					for (int c = 0; c < 8; c++) {
+						corners[c] = clamp_voxel(base + CORNER_OFFSETS[c] * step);
+						values[c] = builder.GetValue(corners[c]);
+						if (values[c] > iso_value) {
+							cube_index |= 1 << c;
+						}
+					}
+					if (MarchingCubesEdgeTable[cube_index] == 0) {
+						continue;
+					}
+
+					for (int e = 0; e < 12; e++) {
+						if (MarchingCubesEdgeTable[cube_index] & (1 << e)) {
+							edge_vertices[e] = builder.GetVertex(corners[EDGE_CORNERS[e][0]], corners[EDGE_CORNERS[e][1]]);
+						}
+					}
+					const int* triangles = MarchingCubesTriangleTable[cube_index];
+					for (int t = 0; triangles[t] != -1; t += 3) {
+						builder.AddTriangle(edge_vertices[triangles[t]], edge_vertices[triangles[t + 1]], edge_vertices[triangles[t + 2]]);
+					}
+				}
+			}
+		}
+		return geometry;
+	}
+}
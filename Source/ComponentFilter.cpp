@@ -0,0 +1,156 @@
+#include "ComponentFilter.h"
+#include "Logger.h"
+#include "MeshDecimator.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace Nexus {
+
+	void ComponentFilter::Filter(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+		const bool is_soup = indices.empty();
+		const unsigned int vertex_count = (unsigned int)(vertices.size() / 6);
+		const unsigned int triangle_count = is_soup ? vertex_count / 3 : (unsigned int)(indices.size() / 3);
+		this->ComponentCount = 0;
+		this->KeptComponentCount = 0;
+		this->RemovedTriangleCount = 0;
+		if (triangle_count == 0) {
+			return;
+		}
+
+		// 三角形湯的頂點沒有共用，先找出位置相同的頂點，只拿來判斷連通，輸出仍然是三角形湯。
+		std::vector<unsigned int> representative;
+		if (is_soup) {
+			MeshDecimator::FindDuplicateVertices(vertices, representative);
+		}
+		const unsigned int* corners = is_soup ? representative.data() : indices.data();
+
+		// 每個三角形把三個角合併到同一個集合，所有三角形平行處理。
+		ThreadPool& pool = ThreadPool::GetInstance();
+		std::vector<std::atomic<unsigned int>> parent(vertex_count);
+		pool.ParallelFor(0, vertex_count, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				parent[i].store(i, std::memory_order_relaxed);
+			}
+		}, 4096);
+		pool.ParallelFor(0, triangle_count, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int t = begin; t < end; t++) {
+				const unsigned int* triangle = corners + static_cast<size_t>(t) * 3;
+				ComponentFilter::Unite(parent, triangle[0], triangle[1]);
+				ComponentFilter::Unite(parent, triangle[0], triangle[2]);
+			}
+		}, 1024);
+
+		// 每個三角形所屬的區塊（集合的根節點），以及每個區塊的三角形數量。
+		std::vector<unsigned int> triangle_root(triangle_count);
+		pool.ParallelFor(0, triangle_count, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int t = begin; t < end; t++) {
+				triangle_root[t] = ComponentFilter::Find(parent, corners[static_cast<size_t>(t) * 3]);
+			}
+		}, 4096);
+		std::vector<unsigned int> component_size(vertex_count, 0);
+		for (unsigned int root : triangle_root) {
+			component_size[root]++;
+		}
+
+		std::vector<std::pair<unsigned int, unsigned int>> components;
+		for (unsigned int v = 0; v < vertex_count; v++) {
+			if (component_size[v] > 0) {
+				components.emplace_back(component_size[v], v);
+			}
+		}
+		this->ComponentCount = (unsigned int)components.size();
+
+		// 先依照大小排序（大小相同時依照根節點，結果與執行緒數量無關），再套用門檻與數量限制。
+		std::sort(components.begin(), components.end(), [](const std::pair<unsigned int, unsigned int>& a, const std::pair<unsigned int, unsigned int>& b) {
+			return a.first != b.first ? a.first > b.first : a.second < b.second;
+		});
+		std::vector<uint8_t> is_kept(vertex_count, 0);
+		for (const std::pair<unsigned int, unsigned int>& component : components) {
+			if (component.first < this->Settings.MinTriangles) {
+				break;
+			}
+			if (this->Settings.KeepLargest > 0 && this->KeptComponentCount >= this->Settings.KeepLargest) {
+				break;
+			}
+			is_kept[component.second] = 1;
+			this->KeptComponentCount++;
+		}
+
+		// 依照原本的順序留下被保留的三角形。
+		unsigned int kept_triangles = 0;
+		if (is_soup) {
+			for (unsigned int t = 0; t < triangle_count; t++) {
+				if (is_kept[triangle_root[t]]) {
+					std::copy(vertices.begin() + static_cast<size_t>(t) * 18, vertices.begin() + static_cast<size_t>(t + 1) * 18, vertices.begin() + static_cast<size_t>(kept_triangles) * 18);
+					kept_triangles++;
+				}
+			}
+			vertices.resize(static_cast<size_t>(kept_triangles) * 18);
+		} else {
+			for (unsigned int t = 0; t < triangle_count; t++) {
+				if (is_kept[triangle_root[t]]) {
+					std::copy(indices.begin() + static_cast<size_t>(t) * 3, indices.begin() + static_cast<size_t>(t + 1) * 3, indices.begin() + static_cast<size_t>(kept_triangles) * 3);
+					kept_triangles++;
+				}
+			}
+			indices.resize(static_cast<size_t>(kept_triangles) * 3);
+
+			// 丟掉不再被任何三角形使用的頂點。
+			std::vector<unsigned int> remap(vertex_count, UINT32_MAX);
+			unsigned int used = 0;
+			for (unsigned int& index : indices) {
+				if (remap[index] == UINT32_MAX) {
+					remap[index] = used++;
+				}
+				index = remap[index];
+			}
+			std::vector<float> compacted(static_cast<size_t>(used) * 6);
+			for (unsigned int v = 0; v < vertex_count; v++) {
+				if (remap[v] != UINT32_MAX) {
+					std::copy(vertices.begin() + static_cast<size_t>(v) * 6, vertices.begin() + static_cast<size_t>(v + 1) * 6, compacted.begin() + static_cast<size_t>(remap[v]) * 6);
+				}
+			}
+			vertices.swap(compacted);
+		}
+		this->RemovedTriangleCount = triangle_count - kept_triangles;
+
+		Logger::Message(LOG_DEBUG, "Component filter: kept " + std::to_string(this->KeptComponentCount) + " / " + std::to_string(this->ComponentCount)
+			+ " components, removed " + std::to_string(this->RemovedTriangleCount) + " triangles.");
+	}
+
+	unsigned int ComponentFilter::Find(std::vector<std::atomic<unsigned int>>& parent, unsigned int vertex) {
+		// Path halving：沿路把節點指向祖父節點，CAS 失敗只代表別的執行緒已經改過，不影響結果。
+		while (true) {
+			unsigned int p = parent[vertex].load(std::memory_order_relaxed);
+			if (p == vertex) {
+				return vertex;
+			}
+			unsigned int grandparent = parent[p].load(std::memory_order_relaxed);
+			if (grandparent != p) {
+				parent[vertex].compare_exchange_weak(p, grandparent, std::memory_order_relaxed);
+			}
+			vertex = grandparent;
+		}
+	}
+
+	void ComponentFilter::Unite(std::vector<std::atomic<unsigned int>>& parent, unsigned int a, unsigned int b) {
+		// 根節點一律接到編號較小的根節點下面，同時進行的合併不會形成環；CAS 失敗代表根節點剛被別人接走，重新找一次。
+		while (true) {
+			a = ComponentFilter::Find(parent, a);
+			b = ComponentFilter::Find(parent, b);
+			if (a == b) {
+				return;
+			}
+			if (a < b) {
+				std::swap(a, b);
+			}
+			unsigned int expected = a;
+			if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+				return;
+			}
+		}
+	}
+}
@@ -0,0 +1,142 @@
+#include "CubeClassifier.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define NEXUS_CLASSIFY_SSE
+#endif
+
+namespace Nexus {
+
+	namespace {
+		// 一個 word 中前 count 個 bit 為 1 的遮罩。
+		uint64_t GetLowBits(unsigned int count) {
+			return count >= 64 ? ~0ull : ((1ull << count) - 1);
+		}
+
+		// 整列 mask 右移一個 bit（下一個 word 的最低位補進來），第 i 個 bit 就變成 voxel i + 1 的符號。
+		uint64_t GetNextVoxelBits(const uint64_t* row, unsigned int word, unsigned int word_count) {
+			uint64_t bits = row[word] >> 1;
+			if (word + 1 < word_count) {
+				bits |= row[word + 1] << 63;
+			}
+			return bits;
+		}
+	}
+
+	void CubeClassifier::ClassifyRow(const float* values, unsigned int count, float iso_value, uint64_t* mask) {
+		std::fill(mask, mask + (count + 63) / 64, 0ull);
+		unsigned int i = 0;
+#ifdef NEXUS_CLASSIFY_SSE
+		// 一次比較四個數值，movemask 取出的 4 個 bit 不會跨越 word（i 是 4 的倍數）。
+		const __m128 iso = _mm_set1_ps(iso_value);
+		for (; i + 4 <= count; i += 4) {
+			uint64_t bits = static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i), iso)));
+			mask[i >> 6] |= bits << (i & 63);
+		}
+#endif
+		for (; i < count; i++) {
+			if (values[i] > iso_value) {
+				mask[i >> 6] |= 1ull << (i & 63);
+			}
+		}
+	}
+
+	void CubeClassifier::Classify(const std::vector<float>& data, glm::ivec3 resolution, glm::ivec3 voxel_min, glm::ivec3 voxel_max, float iso_value) {
+		this->VoxelCount = glm::max(voxel_max - voxel_min + glm::ivec3(1), glm::ivec3(0));
+		this->WordsPerRow = (unsigned int)(this->VoxelCount.x + 63) / 64;
+		this->Masks.assign(static_cast<size_t>(this->VoxelCount.y) * this->VoxelCount.z * this->WordsPerRow, 0ull);
+		this->SliceStates.assign(this->VoxelCount.z, 0);
+
+		const uint64_t last_word = GetLowBits((unsigned int)this->VoxelCount.x - (this->WordsPerRow - 1) * 64);
+		auto classify_slice = [&](int k) {
+			uint64_t any_above = 0;
+			uint64_t all_above = ~0ull;
+			for (int j = 0; j < this->VoxelCount.y; j++) {
+				size_t offset = (static_cast<size_t>(voxel_min.z + k) * resolution.y + (voxel_min.y + j)) * resolution.x + voxel_min.x;
+				uint64_t* row = &this->Masks[(static_cast<size_t>(k) * this->VoxelCount.y + j) * this->WordsPerRow];
+				CubeClassifier::ClassifyRow(&data[offset], (unsigned int)this->VoxelCount.x, iso_value, row);
+
+				// 整個 slice 的 OR 與 AND：全部為 0 代表都在 iso value 以下，全部為 1 代表都在以上。
+				for (unsigned int w = 0; w < this->WordsPerRow; w++) {
+					uint64_t valid = w + 1 == this->WordsPerRow ? last_word : ~0ull;
+					any_above |= row[w];
+					all_above &= row[w] | ~valid;
+				}
+			}
+			this->SliceStates[k] = (any_above != 0 ? SLICE_ANY_ABOVE : 0) | (all_above == ~0ull ? SLICE_ALL_ABOVE : 0);
+		};
+
+		// 一個 brick 的量很小，直接在目前的執行緒上做；整個 volume 時才把 slice 分給 thread pool。
+		if (static_cast<size_t>(this->VoxelCount.x) * this->VoxelCount.y * this->VoxelCount.z < (1u << 20)) {
+			for (int k = 0; k < this->VoxelCount.z; k++) {
+				classify_slice(k);
+			}
+		} else {
+			ThreadPool::GetInstance().ParallelFor(0, (unsigned int)this->VoxelCount.z, [&](unsigned int begin, unsigned int end) {
+				for (unsigned int k = begin; k < end; k++) {
+					classify_slice((int)k);
+				}
+			});
+		}
+	}
+
+	bool CubeClassifier::IsSliceActive(int k) const {
+		uint8_t below = this->SliceStates[k];
+		uint8_t above = this->SliceStates[k + 1];
+		// 兩個 slice 都完全在 iso value 以下（或都完全在以上）時，中間的 cell 都不會有三角形。
+		if ((below & SLICE_ANY_ABOVE) == 0 && (above & SLICE_ANY_ABOVE) == 0) {
+			return false;
+		}
+		return (below & SLICE_ALL_ABOVE) == 0 || (above & SLICE_ALL_ABOVE) == 0;
+	}
+
+	bool CubeClassifier::GetCubeIndices(int j, int k, uint8_t* cube_indices) const {
+		const int cell_count = this->GetRowCellCount();
+		if (cell_count <= 0) {
+			return false;
+		}
+
+		// 角落順序與 MarchingCubesTable 相同：v0 (0,0,0)、v1 (1,0,0)、v2 (1,0,1)、v3 (0,0,1)、v4 (0,1,0)、v5 (1,1,0)、v6 (1,1,1)、v7 (0,1,1)。
+		// 每個 mask 列的第 i 個 bit 是 cell i 在 x = i 的角，右移一位之後就是 x = i + 1 的角。
+		const uint64_t* rows[4] = { this->GetRow(j, k), this->GetRow(j, k + 1), this->GetRow(j + 1, k), this->GetRow(j + 1, k + 1) };
+		auto get_corners = [&](unsigned int w, uint64_t* c) {
+			c[0] = rows[0][w];
+			c[1] = GetNextVoxelBits(rows[0], w, this->WordsPerRow);
+			c[2] = GetNextVoxelBits(rows[1], w, this->WordsPerRow);
+			c[3] = rows[1][w];
+			c[4] = rows[2][w];
+			c[5] = GetNextVoxelBits(rows[2], w, this->WordsPerRow);
+			c[6] = GetNextVoxelBits(rows[3], w, this->WordsPerRow);
+			c[7] = rows[3][w];
+		};
+
+		// 一次檢查 64 個 cell：八個角 OR 起來為 0 或 AND 起來全為 1 的 cell 沒有跨越 iso value。
+		bool is_active = false;
+		uint64_t c[8];
+		for (unsigned int w = 0; w < this->WordsPerRow && !is_active; w++) {
+			get_corners(w, c);
+			uint64_t valid = GetLowBits((unsigned int)(cell_count - (int)w * 64));
+			uint64_t any_above = c[0] | c[1] | c[2] | c[3] | c[4] | c[5] | c[6] | c[7];
+			uint64_t all_above = c[0] & c[1] & c[2] & c[3] & c[4] & c[5] & c[6] & c[7];
+			is_active = ((any_above & ~all_above) & valid) != 0;
+		}
+		if (!is_active) {
+			return false;
+		}
+
+		for (unsigned int w = 0; w < this->WordsPerRow; w++) {
+			get_corners(w, c);
+			int first = (int)w * 64;
+			int count = std::min(cell_count - first, 64);
+			for (int bit = 0; bit < count; bit++) {
+				cube_indices[first + bit] = static_cast<uint8_t>(
+					((c[0] >> bit) & 1) | (((c[1] >> bit) & 1) << 1) | (((c[2] >> bit) & 1) << 2) | (((c[3] >> bit) & 1) << 3) |
+					(((c[4] >> bit) & 1) << 4) | (((c[5] >> bit) & 1) << 5) | (((c[6] >> bit) & 1) << 6) | (((c[7] >> bit) & 1) << 7));
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,146 @@
+#include "DerivedDataGraph.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace Nexus {
+
+	unsigned int DerivedDataGraph::AddNode(const std::string& name, const std::vector<unsigned int>& dependencies, std::function<void()> compute, bool on_calling_thread) {
+		const unsigned int index = (unsigned int)this->Nodes.size();
+		Node node;
+		node.Name = name;
+		node.Compute = std::move(compute);
+		node.OnCallingThread = on_calling_thread;
+		for (unsigned int dependency : dependencies) {
+			// 只能依賴已經存在的節點，保證沒有環。
+			if (dependency >= index) {
+				Logger::Message(LOG_ERROR, "Derived data " + name + " depends on a node that does not exist yet.");
+				continue;
+			}
+			node.Dependencies.push_back(dependency);
+			this->Nodes[dependency].Dependents.push_back(index);
+		}
+		this->Nodes.push_back(std::move(node));
+		return index;
+	}
+
+	void DerivedDataGraph::Invalidate(unsigned int node) {
+		if (node >= this->Nodes.size()) {
+			return;
+		}
+		// 已經是 dirty 的下游也要繼續走，它可能只是被 Discard，下游仍然標記為有效。
+		std::vector<uint8_t> visited(this->Nodes.size(), 0);
+		std::vector<unsigned int> stack = { node };
+		while (!stack.empty()) {
+			unsigned int current = stack.back();
+			stack.pop_back();
+			if (visited[current]) {
+				continue;
+			}
+			visited[current] = 1;
+			this->Nodes[current].IsDirty = true;
+			for (unsigned int dependent : this->Nodes[current].Dependents) {
+				stack.push_back(dependent);
+			}
+		}
+	}
+
+	void DerivedDataGraph::InvalidateAll() {
+		for (Node& node : this->Nodes) {
+			node.IsDirty = true;
+		}
+	}
+
+	void DerivedDataGraph::Discard(unsigned int node) {
+		if (node < this->Nodes.size()) {
+			this->Nodes[node].IsDirty = true;
+		}
+	}
+
+	void DerivedDataGraph::Require(unsigned int node) {
+		this->Require(std::vector<unsigned int>{ node });
+	}
+
+	void DerivedDataGraph::Require(const std::vector<unsigned int>& nodes) {
+		// 從要求的節點往上游找出所有需要重新計算的節點，乾淨的節點不必再往上找。
+		std::vector<uint8_t> needed(this->Nodes.size(), 0);
+		std::vector<unsigned int> stack;
+		for (unsigned int node : nodes) {
+			if (node < this->Nodes.size()) {
+				stack.push_back(node);
+			}
+		}
+		while (!stack.empty()) {
+			unsigned int current = stack.back();
+			stack.pop_back();
+			if (needed[current] || !this->Nodes[current].IsDirty) {
+				continue;
+			}
+			needed[current] = 1;
+			for (unsigned int dependency : this->Nodes[current].Dependencies) {
+				stack.push_back(dependency);
+			}
+		}
+
+		// 每一輪計算所有輸入都已經是最新的節點，同一輪的節點互相獨立，可以同時在 worker 上執行。
+		std::vector<unsigned int> workers;
+		std::vector<unsigned int> calling_thread;
+		while (true) {
+			workers.clear();
+			calling_thread.clear();
+			for (unsigned int i = 0; i < this->Nodes.size(); i++) {
+				if (!needed[i] || !this->Nodes[i].IsDirty) {
+					continue;
+				}
+				bool is_ready = true;
+				for (unsigned int dependency : this->Nodes[i].Dependencies) {
+					if (this->Nodes[dependency].IsDirty) {
+						is_ready = false;
+						break;
+					}
+				}
+				if (is_ready) {
+					(this->Nodes[i].OnCallingThread ? calling_thread : workers).push_back(i);
+				}
+			}
+			if (workers.empty() && calling_thread.empty()) {
+				break;
+			}
+
+			if (workers.size() == 1) {
+				this->Run(workers[0]);
+			} else if (!workers.empty()) {
+				ThreadPool::GetInstance().ParallelFor(0, (unsigned int)workers.size(), [&](unsigned int begin, unsigned int end) {
+					for (unsigned int i = begin; i < end; i++) {
+						this->Run(workers[i]);
+					}
+				}, 1);
+			}
+			for (unsigned int node : calling_thread) {
+				this->Run(node);
+			}
+
+			// Logger 不是 thread-safe，等這一輪結束之後才在呼叫的執行緒上輸出。
+			for (const std::vector<unsigned int>* group : { &workers, &calling_thread }) {
+				for (unsigned int node : *group) {
+					if (this->Nodes[node].Compute) {
+						Logger::Message(LOG_DEBUG, "Derived data updated: " + this->Nodes[node].Name + " (" + std::to_string(this->Nodes[node].Seconds) + " seconds).");
+					}
+				}
+			}
+		}
+	}
+
+	void DerivedDataGraph::Run(unsigned int node) {
+		Node& current = this->Nodes[node];
+		auto start = std::chrono::system_clock::now();
+		if (current.Compute) {
+			current.Compute();
+			current.ComputeCount++;
+		}
+		current.Seconds = std::chrono::duration<double>(std::chrono::system_clock::now() - start).count();
+		current.IsDirty = false;
+	}
+}
@@ -0,0 +1,310 @@
+#include "FlyingEdges.h"
+#include "MarchingCubesTable.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Nexus {
+
+	FlyingEdges::FlyingEdges(const std::vector<float>& data, const std::vector<glm::vec3>& normals, glm::ivec3 resolution, glm::vec3 ratio)
+		: Data(data), Normals(normals), Resolution(resolution), Ratio(ratio), Size(resolution) {
+		for (int cube_index = 0; cube_index < 256; cube_index++) {
+			unsigned char count = 0;
+			while (MarchingCubesTriangleTable[cube_index][count * 3] != -1) {
+				count++;
+			}
+			this->TriangleCount[cube_index] = count;
+		}
+	}
+
+	void FlyingEdges::SetRegion(glm::ivec3 voxel_min, glm::ivec3 voxel_max) {
+		this->Origin = glm::clamp(voxel_min, glm::ivec3(0), this->Resolution - glm::ivec3(1));
+		voxel_max = glm::clamp(voxel_max, glm::ivec3(0), this->Resolution - glm::ivec3(1));
+		this->Size = glm::max(voxel_max - this->Origin + glm::ivec3(1), glm::ivec3(0));
+	}
+
+	void FlyingEdges::Extract(float iso_value, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+		vertices.clear();
+		indices.clear();
+
+		const int nx = this->Size.x;
+		const int ny = this->Size.y;
+		const int nz = this->Size.z;
+		if (nx < 2 || ny < 2 || nz < 2) {
+			return;
+		}
+
+		this->IsoValue = iso_value;
+		this->XCases.assign(static_cast<size_t>(nx - 1) * ny * nz, 0);
+		this->Rows.assign(static_cast<size_t>(ny) * nz, RowMeta());
+		this->CellRows.assign(static_cast<size_t>(ny - 1) * (nz - 1), CellRowMeta());
+
+		ThreadPool& pool = ThreadPool::GetInstance();
+
+		// Pass 1: 分類每一列的 x-edge，並記錄該列與表面相交的範圍。
+		pool.ParallelFor(0, nz, [this, ny](unsigned int begin, unsigned int end) {
+			for (unsigned int k = begin; k < end; k++) {
+				for (int j = 0; j < ny; j++) {
+					this->ClassifyXEdges(j, k);
+				}
+			}
+		});
+
+		// Pass 2: 計算每一列 cell 會產生幾個三角形，以及 y-edge、z-edge 的交點數量。
+		pool.ParallelFor(0, nz - 1, [this, ny](unsigned int begin, unsigned int end) {
+			for (unsigned int k = begin; k < end; k++) {
+				for (int j = 0; j < ny - 1; j++) {
+					this->CountCellRow(j, k);
+				}
+			}
+		});
+
+		// Pass 3: 前綴和，得到每一列的頂點與三角形在輸出陣列中的起始位置，輸出大小因此是精確的。
+		unsigned int point_count = 0;
+		for (RowMeta& row : this->Rows) {
+			row.PointOffset = point_count;
+			point_count += row.XInts + row.YInts + row.ZInts;
+		}
+		unsigned int triangle_count = 0;
+		for (CellRowMeta& cell_row : this->CellRows) {
+			cell_row.TriangleOffset = triangle_count;
+			triangle_count += cell_row.Triangles;
+		}
+		vertices.resize(static_cast<size_t>(point_count) * 6);
+		indices.resize(static_cast<size_t>(triangle_count) * 3);
+
+		// Pass 4: 各列直接把頂點與三角形寫進自己的範圍，不需要任何同步。
+		float* vertex_data = vertices.data();
+		unsigned int* index_data = indices.data();
+		pool.ParallelFor(0, nz - 1, [this, ny, vertex_data, index_data](unsigned int begin, unsigned int end) {
+			for (unsigned int k = begin; k < end; k++) {
+				for (int j = 0; j < ny - 1; j++) {
+					this->GenerateCellRow(j, k, vertex_data, index_data);
+				}
+			}
+		});
+
+		this->XCases.clear();
+		this->XCases.shrink_to_fit();
+	}
+
+	void FlyingEdges::ClassifyXEdges(int y, int z) {
+		const int nx = this->Size.x;
+		const float* values = this->Data.data() + this->GetVoxelIndex(0, y, z);
+		uint8_t* cases = this->XCases.data() + static_cast<size_t>(this->GetRowIndex(y, z)) * (nx - 1);
+		RowMeta& row = this->Rows[this->GetRowIndex(y, z)];
+
+		row.XMin = nx - 1;
+		row.XMax = 0;
+
+		uint8_t left = values[0] > this->IsoValue ? 1 : 0;
+		for (int i = 0; i < nx - 1; i++) {
+			uint8_t right = values[i + 1] > this->IsoValue ? 1 : 0;
+			uint8_t edge_case = left | (right << 1);
+			cases[i] = edge_case;
+			if (edge_case == 1 || edge_case == 2) {
+				row.XInts++;
+				row.XMin = std::min(row.XMin, i);
+				row.XMax = i + 1;
+			}
+			left = right;
+		}
+	}
+
+	unsigned char FlyingEdges::GetCubeIndex(const uint8_t* row0, const uint8_t* row1, const uint8_t* row2, const uint8_t* row3, int x) const {
+		// 依照 Polygonise 的頂點順序組出 cube index：
+		// 0 (x, y, z)、1 (x+1, y, z)、2 (x+1, y, z+1)、3 (x, y, z+1)、4~7 則是 y+1 的同樣四個點。
+		return static_cast<unsigned char>(
+			(row0[x] & 1) | ((row0[x] >> 1) << 1) |
+			((row2[x] >> 1) << 2) | ((row2[x] & 1) << 3) |
+			((row1[x] & 1) << 4) | ((row1[x] >> 1) << 5) |
+			((row3[x] >> 1) << 6) | ((row3[x] & 1) << 7));
+	}
+
+	void FlyingEdges::CountCellRow(int y, int z) {
+		const int nx = this->Size.x;
+		const int ny = this->Size.y;
+		const int nz = this->Size.z;
+
+		RowMeta& meta0 = this->Rows[this->GetRowIndex(y, z)];
+		RowMeta& meta1 = this->Rows[this->GetRowIndex(y + 1, z)];
+		RowMeta& meta2 = this->Rows[this->GetRowIndex(y, z + 1)];
+		const RowMeta& meta3 = this->Rows[this->GetRowIndex(y + 1, z + 1)];
+		const uint8_t* row0 = this->GetXCases(y, z);
+		const uint8_t* row1 = this->GetXCases(y + 1, z);
+		const uint8_t* row2 = this->GetXCases(y, z + 1);
+		const uint8_t* row3 = this->GetXCases(y + 1, z + 1);
+
+		// 四列的相交範圍取聯集。範圍以外每一列的值都不會變號，
+		// 只要四列在最左（最右）端的 voxel 正負號不一致，y/z-edge 就可能在範圍外相交，必須把範圍延伸到邊界。
+		int x_min = std::min(std::min(meta0.XMin, meta1.XMin), std::min(meta2.XMin, meta3.XMin));
+		int x_max = std::max(std::max(meta0.XMax, meta1.XMax), std::max(meta2.XMax, meta3.XMax));
+		uint8_t first = row0[0] & 1;
+		if ((row1[0] & 1) != first || (row2[0] & 1) != first || (row3[0] & 1) != first) {
+			x_min = 0;
+		}
+		uint8_t last = row0[nx - 2] >> 1;
+		if ((row1[nx - 2] >> 1) != last || (row2[nx - 2] >> 1) != last || (row3[nx - 2] >> 1) != last) {
+			x_max = nx - 1;
+		}
+
+		CellRowMeta& cell_row = this->CellRows[this->GetCellRowIndex(y, z)];
+		cell_row.XMin = x_min;
+		cell_row.XMax = x_max;
+
+		// 每一列 cell 負責 (y, z) 這一列的 y-edge 與 z-edge；位於體積最後一層的列沒有自己的 cell，由相鄰的 cell 列代為負責。
+		const bool last_y = (y == ny - 2);
+		const bool last_z = (z == nz - 2);
+		for (int i = x_min; i < x_max; i++) {
+			unsigned char cube_index = this->GetCubeIndex(row0, row1, row2, row3, i);
+			unsigned short edges = MarchingCubesEdgeTable[cube_index];
+			cell_row.Triangles += this->TriangleCount[cube_index];
+			if (edges == 0) {
+				continue;
+			}
+
+			meta0.YInts += (edges >> 8) & 1;
+			meta0.ZInts += (edges >> 3) & 1;
+			if (last_z) {
+				meta2.YInts += (edges >> 11) & 1;
+			}
+			if (last_y) {
+				meta1.ZInts += (edges >> 7) & 1;
+			}
+
+			if (i == x_max - 1) {
+				meta0.YInts += (edges >> 9) & 1;
+				meta0.ZInts += (edges >> 1) & 1;
+				if (last_z) {
+					meta2.YInts += (edges >> 10) & 1;
+				}
+				if (last_y) {
+					meta1.ZInts += (edges >> 5) & 1;
+				}
+			}
+		}
+	}
+
+	void FlyingEdges::GenerateCellRow(int y, int z, float* vertices, unsigned int* indices) const {
+		const CellRowMeta& cell_row = this->CellRows[this->GetCellRowIndex(y, z)];
+		if (cell_row.XMin >= cell_row.XMax || cell_row.Triangles == 0) {
+			return;
+		}
+
+		const int ny = this->Size.y;
+		const int nz = this->Size.z;
+		const bool last_y = (y == ny - 2);
+		const bool last_z = (z == nz - 2);
+
+		const RowMeta& meta0 = this->Rows[this->GetRowIndex(y, z)];
+		const RowMeta& meta1 = this->Rows[this->GetRowIndex(y + 1, z)];
+		const RowMeta& meta2 = this->Rows[this->GetRowIndex(y, z + 1)];
+		const RowMeta& meta3 = this->Rows[this->GetRowIndex(y + 1, z + 1)];
+		const uint8_t* row0 = this->GetXCases(y, z);
+		const uint8_t* row1 = this->GetXCases(y + 1, z);
+		const uint8_t* row2 = this->GetXCases(y, z + 1);
+		const uint8_t* row3 = this->GetXCases(y + 1, z + 1);
+
+		// 每一列的頂點依序是 x-edge、y-edge、z-edge 的交點，範圍起點之前不會有任何交點，所以計數器都從 0 開始。
+		unsigned int x0 = meta0.PointOffset;
+		unsigned int x1 = meta1.PointOffset;
+		unsigned int x2 = meta2.PointOffset;
+		unsigned int x3 = meta3.PointOffset;
+		unsigned int y0 = meta0.PointOffset + meta0.XInts;
+		unsigned int y2 = meta2.PointOffset + meta2.XInts;
+		unsigned int z0 = meta0.PointOffset + meta0.XInts + meta0.YInts;
+		unsigned int z1 = meta1.PointOffset + meta1.XInts + meta1.YInts;
+
+		unsigned int* triangle = indices + static_cast<size_t>(cell_row.TriangleOffset) * 3;
+		unsigned int edge_ids[12];
+
+		for (int i = cell_row.XMin; i < cell_row.XMax; i++) {
+			unsigned char cube_index = this->GetCubeIndex(row0, row1, row2, row3, i);
+			unsigned short edges = MarchingCubesEdgeTable[cube_index];
+			if (edges == 0) {
+				continue;
+			}
+
+			auto crossed = [edges](int edge) -> unsigned int { return (edges >> edge) & 1; };
+			const bool last_x = (i == cell_row.XMax - 1);
+
+			edge_ids[0] = x0;
+			edge_ids[4] = x1;
+			edge_ids[2] = x2;
+			edge_ids[6] = x3;
+			edge_ids[8] = y0;
+			edge_ids[9] = y0 + crossed(8);
+			edge_ids[11] = y2;
+			edge_ids[10] = y2 + crossed(11);
+			edge_ids[3] = z0;
+			edge_ids[1] = z0 + crossed(3);
+			edge_ids[7] = z1;
+			edge_ids[5] = z1 + crossed(7);
+
+			// 產生這個 cell 負責的頂點：原點上的 x/y/z-edge，列尾的 cell 另外負責 x+1 上的 y/z-edge，
+			// 最後一層的 cell 則代替不存在的 cell 列產生 y+1、z+1 上的頂點。
+			if (crossed(0)) this->GeneratePoint(glm::ivec3(i, y, z), glm::ivec3(i + 1, y, z), vertices + static_cast<size_t>(edge_ids[0]) * 6);
+			if (crossed(8)) this->GeneratePoint(glm::ivec3(i, y, z), glm::ivec3(i, y + 1, z), vertices + static_cast<size_t>(edge_ids[8]) * 6);
+			if (crossed(3)) this->GeneratePoint(glm::ivec3(i, y, z), glm::ivec3(i, y, z + 1), vertices + static_cast<size_t>(edge_ids[3]) * 6);
+			if (last_x) {
+				if (crossed(9)) this->GeneratePoint(glm::ivec3(i + 1, y, z), glm::ivec3(i + 1, y + 1, z), vertices + static_cast<size_t>(edge_ids[9]) * 6);
+				if (crossed(1)) this->GeneratePoint(glm::ivec3(i + 1, y, z), glm::ivec3(i + 1, y, z + 1), vertices + static_cast<size_t>(edge_ids[1]) * 6);
+			}
+			if (last_y) {
+				if (crossed(4)) this->GeneratePoint(glm::ivec3(i, y + 1, z), glm::ivec3(i + 1, y + 1, z), vertices + static_cast<size_t>(edge_ids[4]) * 6);
+				if (crossed(7)) this->GeneratePoint(glm::ivec3(i, y + 1, z), glm::ivec3(i, y + 1, z + 1), vertices + static_cast<size_t>(edge_ids[7]) * 6);
+				if (last_x && crossed(5)) this->GeneratePoint(glm::ivec3(i + 1, y + 1, z), glm::ivec3(i + 1, y + 1, z + 1), vertices + static_cast<size_t>(edge_ids[5]) * 6);
+			}
+			if (last_z) {
+				if (crossed(2)) this->GeneratePoint(glm::ivec3(i, y, z + 1), glm::ivec3(i + 1, y, z + 1), vertices + static_cast<size_t>(edge_ids[2]) * 6);
+				if (crossed(11)) this->GeneratePoint(glm::ivec3(i, y, z + 1), glm::ivec3(i, y + 1, z + 1), vertices + static_cast<size_t>(edge_ids[11]) * 6);
+				if (last_x && crossed(10)) this->GeneratePoint(glm::ivec3(i + 1, y, z + 1), glm::ivec3(i + 1, y + 1, z + 1), vertices + static_cast<size_t>(edge_ids[10]) * 6);
+			}
+			if (last_y && last_z && crossed(6)) {
+				this->GeneratePoint(glm::ivec3(i, y + 1, z + 1), glm::ivec3(i + 1, y + 1, z + 1), vertices + static_cast<size_t>(edge_ids[6]) * 6);
+			}
+
+			const int* triangles = MarchingCubesTriangleTable[cube_index];
+			for (int t = 0; triangles[t] != -1; t++) {
+				*triangle++ = edge_ids[triangles[t]];
+			}
+
+			x0 += crossed(0);
+			x1 += crossed(4);
+			x2 += crossed(2);
+			x3 += crossed(6);
+			y0 += crossed(8);
+			y2 += crossed(11);
+			z0 += crossed(3);
+			z1 += crossed(7);
+		}
+	}
+
+	void FlyingEdges::GeneratePoint(glm::ivec3 a, glm::ivec3 b, float* vertex) const {
+		// 與 IsoSurface::Interpolation 相同的內插方式，讓兩種方法的結果可以直接比較。
+		size_t index_a = this->GetVoxelIndex(a.x, a.y, a.z);
+		size_t index_b = this->GetVoxelIndex(b.x, b.y, b.z);
+		float value_a = this->Data[index_a];
+		float value_b = this->Data[index_b];
+
+		float proportion = 0.0f;
+		if (std::abs(this->IsoValue - value_a) < 0.00001f) {
+			proportion = 0.0f;
+		} else if (std::abs(this->IsoValue - value_b) < 0.00001f) {
+			proportion = 1.0f;
+		} else if (std::abs(value_a - value_b) >= 0.00001f) {
+			proportion = (this->IsoValue - value_a) / (value_b - value_a);
+		}
+
+		glm::vec3 position = (glm::vec3(a + this->Origin) + proportion * glm::vec3(b - a)) * this->Ratio;
+		glm::vec3 normal = glm::normalize(this->Normals[index_a] + proportion * (this->Normals[index_b] - this->Normals[index_a]));
+
+		vertex[0] = position.x;
+		vertex[1] = position.y;
+		vertex[2] = position.z;
+		vertex[3] = normal.x;
+		vertex[4] = normal.y;
+		vertex[5] = normal.z;
+	}
+}
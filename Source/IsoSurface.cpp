@@ -3,17 +3,55 @@
 #include "FileLoader.h"
 #include "Utill.h"
 #include "Cube.h"
+#include "CubeClassifier.h"
+#include "ThreadPool.h"
+#include "FlyingEdges.h"
+#include "MeshExporter.h"
+#include "MeshOptimizer.h"
+#include "SurfaceNets.h"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <type_traits>
 
 namespace Nexus {
 	IsoSurface::IsoSurface(const std::string& info_path, const std::string& raw_path, float max_gradient) {
+		this->BuildDerivedDataGraph();
 		this->Initialize(info_path, raw_path, max_gradient);
 	}
 
+	void IsoSurface::BuildDerivedDataGraph() {
+		// 加入的順序必須與 DerivedData 的編號相同。Gradient 與空間索引彼此獨立，histogram 也是，可以同時計算。
+		this->DerivedData.AddNode("raw data", {}, nullptr);
+		this->DerivedData.AddNode("value range", { DERIVED_DATA_RAW_DATA }, [this]() { this->ComputeValueRange(); });
+		this->DerivedData.AddNode("gradients", { DERIVED_DATA_RAW_DATA }, [this]() { this->ComputeAllNormals(this->MaxGradient); });
+		this->DerivedData.AddNode("spatial index", { DERIVED_DATA_RAW_DATA }, [this]() { this->BuildSpatialIndex(); });
+		this->DerivedData.AddNode("iso value histogram", { DERIVED_DATA_VALUE_RANGE }, [this]() { this->GenerateIsoValueHistogram(); });
+		this->DerivedData.AddNode("gradient histogram", { DERIVED_DATA_GRADIENTS }, [this]() { this->GenerateGradientHistogram(); });
+		this->DerivedData.AddNode("gradient heatmap", { DERIVED_DATA_ISO_VALUE_HISTOGRAM, DERIVED_DATA_GRADIENT_HISTOGRAM }, [this]() { this->GenerateGradientHeatMap(); });
+		this->DerivedData.AddNode("texture data", { DERIVED_DATA_VALUE_RANGE, DERIVED_DATA_GRADIENTS }, [this]() { this->GenerateTextureData(); });
+		// 上傳需要 OpenGL 的 context，不能交給 worker；RGBA32F 時會在裡面再 Require TextureData。
+		this->DerivedData.AddNode("volume texture", { DERIVED_DATA_VALUE_RANGE, DERIVED_DATA_GRADIENTS }, [this]() { this->UploadVolumeTexture(); }, true);
+		this->DerivedData.AddNode("brick ranges", { DERIVED_DATA_VALUE_RANGE, DERIVED_DATA_SPATIAL_INDEX }, [this]() {
+			this->ProjectionBricks.Build(this->Octree, glm::ivec3(this->Attributes.Resolution), this->MaxValue);
+		});
+		this->DerivedData.AddNode("brick range texture", { DERIVED_DATA_BRICK_RANGES }, [this]() { this->UploadProjectionBricks(); }, true);
+		// 只是記下 RawData 與最大值並丟掉快取的 slab，真正的抽取在 UpdateSlice 中依照需要的 slice 進行。
+		this->DerivedData.AddNode("slicer", { DERIVED_DATA_VALUE_RANGE }, [this]() {
+			this->Slicer.SetVolume(&this->RawData, glm::ivec3(this->Attributes.Resolution), this->MaxValue);
+		});
+	}
+
 	void IsoSurface::Initialize(const std::string& info_path, const std::string& raw_path, float max_gradient) {
 		Logger::Message(LOG_INFO, "Starting loading volume data: " + raw_path);
 
 		// Initial
+		// 背景中的 chunk 與 progressive 抽取還在讀舊的資料，要先停下來才能清掉。
+		this->Chunks.reset();
+		this->StopProgressiveExtraction();
+		this->VolumeStreamer.Cancel();
 		this->IsInitialize = false;
 		this->IsReadyToDraw = false;
 		this->IsEqualization = false;
@@ -22,6 +60,11 @@ namespace Nexus {
 		this->GridNormals.clear();
 		this->GradientMagnitudes.clear();
 		this->TextureData.clear();
+		this->Octree.Clear();
+		this->SpanIndex.Clear();
+		this->ProjectionBricks.Clear();
+		this->Slicer.Clear();
+		this->ActiveBricks.clear();
 		
 		this->RawDataFilePath = raw_path;
 		this->InfDataFilePath = info_path;
@@ -34,13 +77,10 @@ namespace Nexus {
         Nexus::FileLoader::LoadRawFile(this->RawData, raw_path, Attributes);
 		Logger::Message(LOG_INFO, "Starting initialize voxels data...");
 
-		// Compute the gradient of these all voxels.
-		this->ComputeAllNormals(max_gradient);
-
-		// 計算 Iso value Histogram、Gradient Histogram 和 heatmap
-		this->GenerateIsoValueHistogram();
-		this->GenerateGradientHistogram();
-		this->GenerateGradientHeatMap();
+		// Gradient、min/max octree 與 span-space 索引、histogram 和 heatmap 都是由 RawData 衍生出來的，
+		// 第一次需要時才在 ThreadPool 上計算（見 BuildDerivedDataGraph）。
+		this->MaxGradient = max_gradient;
+		this->DerivedData.Invalidate(DERIVED_DATA_RAW_DATA);
 		
 		// 索引是 0 ~ 3409119 個，代表每一個 voxel 上面 gradient 的長度，介於 1 到 max_gradient 之間。
 		// Utill::Show1DVectorStatistics(this->GradientMagnitudes, "Gradient Histogram - Before");
@@ -176,16 +216,464 @@ namespace Nexus {
 		}
 	}
 
+	void IsoSurface::ComputeValueRange() {
+		this->MaxValue = this->RawData.empty() ? 0.0f : *std::max_element(this->RawData.cbegin(), this->RawData.cend());
+	}
+
 	void IsoSurface::GenerateTextureData() {
-		float max_isovalue = *std::max_element(this->RawData.cbegin(), this->RawData.cend());
+		float max_isovalue = this->MaxValue > 0.0f ? this->MaxValue : 1.0f;
 		
-		for (unsigned i = 0; i < this->RawData.size(); i++) {
-			glm::vec3 temp_norm = this->GridNormals[i];
-			float temp_value = this->RawData[i] / max_isovalue;
-			this->TextureData.push_back(glm::vec4(temp_norm, temp_value));
+		this->TextureData.resize(this->RawData.size());
+		ThreadPool::GetInstance().ParallelFor(0, (unsigned int)this->RawData.size(), [this, max_isovalue](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				this->TextureData[i] = glm::vec4(this->GridNormals[i], this->RawData[i] / max_isovalue);
+			}
+		}, 1 << 16);
+	}
+
+	void IsoSurface::UploadTexture3D(GLuint& texture, glm::ivec3& allocated_size, GLenum& allocated_format, glm::ivec3 texture_size, GLenum internal_format, GLenum format, GLenum type, GLint filter, const void* data) {
+		// Texture 只建立一次，大小與格式都沒有改變時直接以 glTexSubImage3D 更新內容。
+		if (texture == 0) {
+			glGenTextures(1, &texture);
+			allocated_size = glm::ivec3(0);
+		}
+		glBindTexture(GL_TEXTURE_3D, texture);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, filter);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		if (texture_size == allocated_size && internal_format == allocated_format) {
+			// data 為 nullptr 時只確保 texture 已經配置好（內容由串流上傳填入）。
+			if (data != nullptr) {
+				glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, texture_size.x, texture_size.y, texture_size.z, format, type, data);
+			}
+		} else {
+			glTexImage3D(GL_TEXTURE_3D, 0, internal_format, texture_size.x, texture_size.y, texture_size.z, 0, format, type, data);
+			allocated_size = texture_size;
+			allocated_format = internal_format;
+		}
+		glBindTexture(GL_TEXTURE_3D, 0);
+	}
+
+	void IsoSurface::UploadVolumeTexture() {
+		const size_t voxel_count = this->RawData.size();
+		const glm::ivec3 volume_size = glm::ivec3(this->Attributes.Resolution);
+		if (this->EnableStreamingUpload) {
+			this->StartVolumeStreaming();
+			return;
+		}
+		this->VolumeStreamer.Cancel();
+		if (this->CurrentVolumeTextureFormat == VOLUME_TEXTURE_FORMAT_RGBA32F) {
+			// Generate a new data and sent into gpu (r, g, b) => Gradient, a => Value;
+			// Please make sure your texture settings (it is GL_FLOAT, not GL_UNSIGNED_BYTE)
+			this->DerivedData.Require(DERIVED_DATA_TEXTURE_DATA);
+			this->UploadTexture3D(this->VolumeTexture, this->VolumeTextureSize, this->VolumeTextureInternalFormat, volume_size, GL_RGBA32F, GL_RGBA, GL_FLOAT, GL_LINEAR, this->TextureData.data());
+			this->VolumeTextureBytes = voxel_count * sizeof(glm::vec4);
+			this->ReleaseGradientTexture();
+			return;
+		}
+
+		// 只上傳數值（與 RGBA32F 相同，正規化到 [0, 1]），8 bits 的資料用 R8，其他用 R16。
+		// 使用 2D transfer function 時，第二個分量是正規化的 gradient 長度（RG8 / RG16）。
+		// 上傳用的資料只是暫存，不保留 CPU 端的副本。
+		this->TextureData.clear();
+		this->TextureData.shrink_to_fit();
+		this->DerivedData.Discard(DERIVED_DATA_TEXTURE_DATA);
+		const float max_value = this->MaxValue > 0.0f ? this->MaxValue : 1.0f;
+		const float gradient_scale = this->GetGradientMagnitudeScale();
+		const int components = this->EnableTransferFunction2D ? 2 : 1;
+		ThreadPool& pool = ThreadPool::GetInstance();
+		const bool is_8_bit = this->Attributes.DataType == VolumeDataType_Char || this->Attributes.DataType == VolumeDataType_UnsignedChar;
+		auto pack = [&](auto& scalars, float range) {
+			using Scalar = typename std::decay_t<decltype(scalars)>::value_type;
+			pool.ParallelFor(0, (unsigned int)voxel_count, [&](unsigned int begin, unsigned int end) {
+				for (unsigned int i = begin; i < end; i++) {
+					scalars[static_cast<size_t>(i) * components] = static_cast<Scalar>(glm::clamp(this->RawData[i] / max_value, 0.0f, 1.0f) * range + 0.5f);
+					if (components == 2) {
+						scalars[static_cast<size_t>(i) * 2 + 1] = static_cast<Scalar>(glm::clamp(this->GradientMagnitudes[i] * gradient_scale, 0.0f, 1.0f) * range + 0.5f);
+					}
+				}
+			}, 1 << 16);
+		};
+		const GLenum format = components == 2 ? GL_RG : GL_RED;
+		if (is_8_bit) {
+			std::vector<uint8_t> scalars(voxel_count * components);
+			pack(scalars, 255.0f);
+			this->UploadTexture3D(this->VolumeTexture, this->VolumeTextureSize, this->VolumeTextureInternalFormat, volume_size, components == 2 ? GL_RG8 : GL_R8, format, GL_UNSIGNED_BYTE, GL_LINEAR, scalars.data());
+			this->VolumeTextureBytes = scalars.size() * sizeof(uint8_t);
+		} else {
+			std::vector<uint16_t> scalars(voxel_count * components);
+			pack(scalars, 65535.0f);
+			this->UploadTexture3D(this->VolumeTexture, this->VolumeTextureSize, this->VolumeTextureInternalFormat, volume_size, components == 2 ? GL_RG16 : GL_R16, format, GL_UNSIGNED_SHORT, GL_LINEAR, scalars.data());
+			this->VolumeTextureBytes = scalars.size() * sizeof(uint16_t);
+		}
+
+		// Gradient 預設在 shader 中以 central difference 計算；開啟時改成另外一張 RGB8_SNORM 的方向 texture。
+		if (!this->EnableGradientTexture) {
+			this->ReleaseGradientTexture();
+			return;
+		}
+		std::vector<int8_t> gradients(voxel_count * 3);
+		pool.ParallelFor(0, (unsigned int)voxel_count, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				glm::vec3 gradient = this->GridNormals[i];
+				float length = glm::length(gradient);
+				gradient = length > 0.0f ? gradient / length : glm::vec3(0.0f);
+				for (int c = 0; c < 3; c++) {
+					gradients[static_cast<size_t>(i) * 3 + c] = static_cast<int8_t>(std::lround(gradient[c] * 127.0f));
+				}
+			}
+		}, 1 << 16);
+		this->UploadTexture3D(this->GradientTexture, this->GradientTextureSize, this->GradientTextureInternalFormat, volume_size, GL_RGB8_SNORM, GL_RGB, GL_BYTE, GL_LINEAR, gradients.data());
+		this->VolumeTextureBytes += voxel_count * 3;
+	}
+
+	void IsoSurface::StartVolumeStreaming() {
+		// 與 UploadVolumeTexture 相同的格式，只是 texture 先以 nullptr 配置，每個 brick 由 Fill 直接從 RawData 轉換到 PBO 中，
+		// 不需要整個 volume 大小的暫存資料。
+		const glm::ivec3 volume_size = glm::ivec3(this->Attributes.Resolution);
+		const glm::ivec3 resolution = volume_size;
+		const float max_value = this->MaxValue > 0.0f ? this->MaxValue : 1.0f;
+		this->TextureData.clear();
+		this->TextureData.shrink_to_fit();
+		this->DerivedData.Discard(DERIVED_DATA_TEXTURE_DATA);
+
+		// 依照 brick 內 x、y、z 的順序走過每個 voxel，convert(voxel 索引, 輸出位置) 寫入一個 voxel 的所有分量。
+		auto make_fill = [this, resolution](size_t bytes_per_voxel, auto convert) {
+			return [this, resolution, bytes_per_voxel, convert](glm::ivec3 origin, glm::ivec3 size, uint8_t* destination) {
+				for (int z = 0; z < size.z; z++) {
+					for (int y = 0; y < size.y; y++) {
+						size_t index = this->GetIndexFromGrid(origin.x, origin.y + y, origin.z + z);
+						for (int x = 0; x < size.x; x++) {
+							convert(index + x, destination);
+							destination += bytes_per_voxel;
+						}
+					}
+				}
+			};
+		};
+
+		std::vector<VolumeStreamChannel> channels(1);
+		VolumeStreamChannel& volume = channels[0];
+		GLenum internal_format = GL_RGBA32F;
+		if (this->CurrentVolumeTextureFormat == VOLUME_TEXTURE_FORMAT_RGBA32F) {
+			volume.Format = GL_RGBA;
+			volume.Type = GL_FLOAT;
+			volume.BytesPerVoxel = sizeof(glm::vec4);
+			volume.Fill = make_fill(volume.BytesPerVoxel, [this, max_value](size_t i, uint8_t* output) {
+				glm::vec4 texel(this->GridNormals[i], this->RawData[i] / max_value);
+				std::memcpy(output, &texel, sizeof(glm::vec4));
+			});
+		} else if (this->Attributes.DataType == VolumeDataType_Char || this->Attributes.DataType == VolumeDataType_UnsignedChar) {
+			const bool has_gradient = this->EnableTransferFunction2D;
+			const float gradient_scale = this->GetGradientMagnitudeScale();
+			internal_format = has_gradient ? GL_RG8 : GL_R8;
+			volume.Format = has_gradient ? GL_RG : GL_RED;
+			volume.Type = GL_UNSIGNED_BYTE;
+			volume.BytesPerVoxel = has_gradient ? 2 : 1;
+			volume.Fill = make_fill(volume.BytesPerVoxel, [this, max_value, has_gradient, gradient_scale](size_t i, uint8_t* output) {
+				output[0] = static_cast<uint8_t>(glm::clamp(this->RawData[i] / max_value, 0.0f, 1.0f) * 255.0f + 0.5f);
+				if (has_gradient) {
+					output[1] = static_cast<uint8_t>(glm::clamp(this->GradientMagnitudes[i] * gradient_scale, 0.0f, 1.0f) * 255.0f + 0.5f);
+				}
+			});
+		} else {
+			const bool has_gradient = this->EnableTransferFunction2D;
+			const float gradient_scale = this->GetGradientMagnitudeScale();
+			internal_format = has_gradient ? GL_RG16 : GL_R16;
+			volume.Format = has_gradient ? GL_RG : GL_RED;
+			volume.Type = GL_UNSIGNED_SHORT;
+			volume.BytesPerVoxel = has_gradient ? 2 * sizeof(uint16_t) : sizeof(uint16_t);
+			volume.Fill = make_fill(volume.BytesPerVoxel, [this, max_value, has_gradient, gradient_scale](size_t i, uint8_t* output) {
+				uint16_t values[2] = {
+					static_cast<uint16_t>(glm::clamp(this->RawData[i] / max_value, 0.0f, 1.0f) * 65535.0f + 0.5f),
+					static_cast<uint16_t>(glm::clamp(this->GradientMagnitudes[i] * gradient_scale, 0.0f, 1.0f) * 65535.0f + 0.5f)
+				};
+				std::memcpy(output, values, has_gradient ? sizeof(values) : sizeof(uint16_t));
+			});
+		}
+		this->UploadTexture3D(this->VolumeTexture, this->VolumeTextureSize, this->VolumeTextureInternalFormat, volume_size, internal_format, volume.Format, volume.Type, GL_LINEAR, nullptr);
+		volume.Texture = this->VolumeTexture;
+		this->VolumeTextureBytes = this->RawData.size() * volume.BytesPerVoxel;
+
+		if (this->CurrentVolumeTextureFormat == VOLUME_TEXTURE_FORMAT_SCALAR && this->EnableGradientTexture) {
+			VolumeStreamChannel gradient;
+			gradient.Format = GL_RGB;
+			gradient.Type = GL_BYTE;
+			gradient.BytesPerVoxel = 3;
+			gradient.Fill = make_fill(gradient.BytesPerVoxel, [this](size_t i, uint8_t* output) {
+				glm::vec3 direction = this->GridNormals[i];
+				float length = glm::length(direction);
+				direction = length > 0.0f ? direction / length : glm::vec3(0.0f);
+				for (int c = 0; c < 3; c++) {
+					output[c] = static_cast<uint8_t>(static_cast<int8_t>(std::lround(direction[c] * 127.0f)));
+				}
+			});
+			this->UploadTexture3D(this->GradientTexture, this->GradientTextureSize, this->GradientTextureInternalFormat, volume_size, GL_RGB8_SNORM, GL_RGB, GL_BYTE, GL_LINEAR, nullptr);
+			gradient.Texture = this->GradientTexture;
+			this->VolumeTextureBytes += this->RawData.size() * 3;
+			channels.push_back(gradient);
+		} else {
+			this->ReleaseGradientTexture();
+		}
+
+		this->VolumeStreamer.Start(volume_size, channels);
+	}
+
+	void IsoSurface::UpdateOccupancy() {
+		// Brick 的 min/max 換算成與 volume texture 相同的 [0, 1]，volume 改變時（BuildSpatialIndex）才需要重建。
+		this->DerivedData.Require({ DERIVED_DATA_VALUE_RANGE, DERIVED_DATA_SPATIAL_INDEX });
+		if (this->Occupancy.IsEmpty() && !this->Octree.IsEmpty()) {
+			this->Occupancy.Build(this->Octree, this->MaxValue);
+		}
+		// 2D transfer function 以每個數值在所有 gradient 上的最大不透明度判斷 brick 是否可見。
+		const std::vector<float>& transfer_function = this->EnableTransferFunction2D ? this->TransferFunction2DTable.GetValueProjection() : this->TransferFunction;
+		if (!this->Occupancy.Update(transfer_function)) {
+			return;
+		}
+		this->UploadTexture3D(this->OccupancyTexture, this->OccupancyTextureSize, this->OccupancyTextureInternalFormat, this->Occupancy.GetGridSize(),
+			GL_R8UI, GL_RED_INTEGER, GL_UNSIGNED_BYTE, GL_NEAREST, this->Occupancy.GetDistances().data());
+	}
+
+	void IsoSurface::UpdatePreIntegration() {
+		// 表格在 CPU 上更新（software ray caster 也會用到），只有 ray casting 已經準備好時才上傳到 GPU。
+		if (!this->PreIntegration.Update(this->TransferFunction, this->PreIntegrationStepSize)) {
+			return;
+		}
+		if (this->IsReadyToDraw && this->CurrentRenderMode == RENDER_MODE_RAY_CASTING) {
+			this->UploadPreIntegrationTable();
+		}
+	}
+
+	void IsoSurface::UploadPreIntegrationTable() {
+		if (this->PreIntegration.IsEmpty()) {
+			return;
+		}
+		int size = this->PreIntegration.GetSize();
+		if (this->PreIntegrationTexture == 0) {
+			glGenTextures(1, &this->PreIntegrationTexture);
+			this->PreIntegrationTextureSize = 0;
+		}
+		glBindTexture(GL_TEXTURE_2D, this->PreIntegrationTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		if (size == this->PreIntegrationTextureSize) {
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_FLOAT, this->PreIntegration.GetTable().data());
+		} else {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, size, size, 0, GL_RGBA, GL_FLOAT, this->PreIntegration.GetTable().data());
+			this->PreIntegrationTextureSize = size;
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void IsoSurface::UploadProjectionBricks() {
+		if (this->ProjectionBricks.IsEmpty()) {
+			return;
+		}
+		// 每個 brick 一個 texel，shader 以 GL_NEAREST 取出目前所在 brick 的 (min, max)。
+		this->UploadTexture3D(this->ProjectionBrickTexture, this->ProjectionBrickTextureSize, this->ProjectionBrickTextureInternalFormat, this->ProjectionBricks.GetGridSize(),
+			GL_RG32F, GL_RG, GL_FLOAT, GL_NEAREST, this->ProjectionBricks.GetRanges().data());
+	}
+
+	void IsoSurface::UpdateTransferFunction2D() {
+		if (!this->TransferFunction2DTable.Update() && this->TransferFunction2DTexture != 0) {
+			return;
+		}
+		if (!this->IsReadyToDraw || this->CurrentRenderMode != RENDER_MODE_RAY_CASTING) {
+			return;
+		}
+		this->UploadTransferFunction2D();
+		if (this->EnableEmptySpaceSkipping) {
+			this->UpdateOccupancy();
+		}
+		this->ProgressiveRendering.Invalidate();
+	}
+
+	void IsoSurface::UploadTransferFunction2D() {
+		if (this->TransferFunction2DTable.GetTable().empty()) {
+			return;
+		}
+		int size = this->TransferFunction2DTable.GetSize();
+		if (this->TransferFunction2DTexture == 0) {
+			glGenTextures(1, &this->TransferFunction2DTexture);
+			this->TransferFunction2DTextureSize = 0;
+		}
+		glBindTexture(GL_TEXTURE_2D, this->TransferFunction2DTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		if (size == this->TransferFunction2DTextureSize) {
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_FLOAT, this->TransferFunction2DTable.GetTable().data());
+		} else {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, size, size, 0, GL_RGBA, GL_FLOAT, this->TransferFunction2DTable.GetTable().data());
+			this->TransferFunction2DTextureSize = size;
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	float IsoSurface::GetGradientMagnitudeScale() const {
+		// GradientMagnitudes 是分貝化之後的長度（0 到 20 * log2(max_gradient)），以最大值正規化，與 heatmap 的縱軸相同。
+		return this->MaxGradientMagnitude > 0.0f ? 1.0f / this->MaxGradientMagnitude : 1.0f;
+	}
+
+	glm::vec2 IsoSurface::GetTransferFunction2DCoordinate(unsigned int heatmap_x, unsigned int heatmap_y) {
+		// Heatmap 的 x 是數值的 bin，y 是 gradient 的 bin 且第 0 列是最大的 gradient（見 GenerateGradientHeatMap）。
+		this->RequireHistograms({ DERIVED_DATA_ISO_VALUE_HISTOGRAM, DERIVED_DATA_GRADIENT_HISTOGRAM });
+		if (this->IsoValueBoundary.empty() || this->GradientBoundary.empty()) {
+			return glm::vec2(0.0f);
+		}
+		heatmap_x = std::min(heatmap_x, (unsigned int)this->IsoValueBoundary.size() - 1);
+		unsigned int gradient_index = (unsigned int)this->GradientBoundary.size() - 1 - std::min(heatmap_y, (unsigned int)this->GradientBoundary.size() - 1);
+		const float max_value = this->MaxValue;
+		float value = (this->IsoValueBoundary[heatmap_x].first + this->IsoValueBoundary[heatmap_x].second) * 0.5f;
+		float gradient = (this->GradientBoundary[gradient_index].first + this->GradientBoundary[gradient_index].second) * 0.5f;
+		return glm::clamp(glm::vec2(max_value > 0.0f ? value / max_value : 0.0f, gradient * this->GetGradientMagnitudeScale()), glm::vec2(0.0f), glm::vec2(1.0f));
+	}
+
+	void IsoSurface::ReleaseGradientTexture() {
+		if (this->GradientTexture != 0) {
+			glDeleteTextures(1, &this->GradientTexture);
+			this->GradientTexture = 0;
+			this->GradientTextureSize = glm::ivec3(0);
 		}
 	}
 	
+	void IsoSurface::ExtractSurface() {
+		if (!this->IsInitialize) {
+			Logger::Message(LOG_ERROR, "YOU MUST LOAD THE VOLUME DATA FIRST!");
+			return;
+		}
+		this->StopProgressiveExtraction();
+		this->DerivedData.Require({ DERIVED_DATA_GRADIENTS, DERIVED_DATA_SPATIAL_INDEX });
+
+		// Initialize and clean the vector;
+		this->Vertices.clear();
+		this->Position.clear();
+		this->Normal.clear();
+		this->Indices.clear();
+		this->VertexCount = 0;
+		this->IndexCount = 0;
+		this->VertexBufferSize = 0;
+
+		// 沒有設定任何圖層時，以 IsoValue 當作唯一的一層。
+		std::vector<IsoSurfaceLayer> single_layer;
+		if (this->Layers.empty()) {
+			single_layer.push_back(IsoSurfaceLayer());
+			single_layer[0].IsoValue = this->IsoValue;
+		}
+		std::vector<IsoSurfaceLayer>& layers = this->Layers.empty() ? single_layer : this->Layers;
+
+		// Input the data set and iso-values
+		auto extraction_start = std::chrono::system_clock::now();
+		if (this->CurrentExtractionMethod == EXTRACTION_METHOD_FLYING_EDGES) {
+			this->GenerateVerticesFlyingEdges(layers);
+		} else if (this->CurrentExtractionMethod == EXTRACTION_METHOD_SURFACE_NETS) {
+			this->GenerateVerticesSurfaceNets(layers);
+		} else {
+			this->GenerateVertices(layers);
+		}
+		this->ExtractionSeconds = std::chrono::system_clock::now() - extraction_start;
+		this->ExtractedTriangleCount = this->GetTriangleCount();
+
+		// Drop small disconnected pieces before they are decimated and uploaded.
+		this->RemovedComponentCount = 0;
+		if (this->EnableComponentFilter) {
+			this->FilterComponents(layers);
+			this->Position.clear();
+			this->Normal.clear();
+		}
+
+		// Reduce the triangle count before uploading, the result is always an indexed mesh.
+		this->DecimationSeconds = std::chrono::duration<double>(0.0);
+		if (this->EnableDecimation) {
+			auto decimation_start = std::chrono::system_clock::now();
+			this->DecimateLayers(layers);
+			this->Position.clear();
+			this->Normal.clear();
+			this->DecimationSeconds = std::chrono::system_clock::now() - decimation_start;
+		}
+
+		// Reorder the final mesh for the post-transform cache and vertex fetch, the last step before uploading.
+		this->ACMRBefore = 0.0f;
+		this->ACMRAfter = 0.0f;
+		if (this->EnableMeshOptimization) {
+			this->OptimizeLayers(layers);
+			this->Position.clear();
+			this->Normal.clear();
+		}
+	}
+
+	bool IsoSurface::ExportMesh(const std::string& path) const {
+		return MeshExporter::Export(path, this->Vertices, this->Indices);
+	}
+
+	bool IsoSurface::RenderSoftware(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, int width, int height, std::vector<uint8_t>& image) {
+		if (!this->IsInitialize) {
+			Logger::Message(LOG_ERROR, "YOU MUST LOAD THE VOLUME DATA FIRST!");
+			return false;
+		}
+		this->DerivedData.Require(DERIVED_DATA_VALUE_RANGE);
+		SoftwareRayCaster ray_caster(this->RawData, glm::ivec3(this->Attributes.Resolution), this->Attributes.Ratio, this->MaxValue, this->SoftwareRayCasting);
+		ray_caster.SetTransferFunction(this->TransferFunction);
+		if (this->GetIntensityProjection() != INTENSITY_PROJECTION_NONE) {
+			this->DerivedData.Require(DERIVED_DATA_BRICK_RANGES);
+			ray_caster.SetIntensityProjection(this->GetIntensityProjection(), &this->ProjectionBricks);
+		}
+		if (this->EnablePreIntegration) {
+			this->PreIntegration.Update(this->TransferFunction, this->PreIntegrationStepSize);
+			ray_caster.SetPreIntegrationTable(&this->PreIntegration);
+		}
+		if (this->EnableTransferFunction2D) {
+			this->DerivedData.Require(DERIVED_DATA_GRADIENTS);
+			this->TransferFunction2DTable.Update();
+			ray_caster.SetTransferFunction2D(&this->TransferFunction2DTable, &this->GradientMagnitudes, this->GetGradientMagnitudeScale());
+		}
+		ray_caster.Render(model, view, projection, width, height, image);
+		this->SoftwareSamplesPerSecond = ray_caster.GetSamplesPerSecond();
+		return !image.empty();
+	}
+
+	Texture2D* IsoSurface::UpdateSlice(int axis, int index) {
+		if (!this->IsInitialize || axis < SLICE_AXIS_X || axis > SLICE_AXIS_Z) {
+			return nullptr;
+		}
+		// 資料改變之後（重新載入、等化）所有方向的 slice 都要重新抽取。
+		if (this->DerivedData.IsDirty(DERIVED_DATA_SLICER)) {
+			this->DerivedData.Require(DERIVED_DATA_SLICER);
+			for (int& slice_index : this->SliceIndices) {
+				slice_index = -1;
+			}
+		}
+		index = glm::clamp(index, 0, this->Slicer.GetSliceCount(axis) - 1);
+		std::unique_ptr<Texture2D>& texture = this->SliceTextures[axis];
+		const glm::ivec2 size = this->Slicer.GetSliceSize(axis);
+		if (texture && index == this->SliceIndices[axis] && (int)texture->Width == size.x && (int)texture->Height == size.y) {
+			return texture.get();
+		}
+		if (!this->Slicer.Extract(axis, index, this->SliceWindow, this->SliceImage)) {
+			return nullptr;
+		}
+
+		// 寬度不一定是 4 的倍數，R8 的每一列要以 1 byte 對齊。
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		if (!texture || (int)texture->Width != size.x || (int)texture->Height != size.y) {
+			texture = std::make_unique<Texture2D>(size.x, size.y, GL_R8, GL_RED, GL_UNSIGNED_BYTE, this->SliceImage.data(), false);
+			texture->SetWrappingParams(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+		} else {
+			texture->Bind();
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size.x, size.y, GL_RED, GL_UNSIGNED_BYTE, this->SliceImage.data());
+			texture->Unbind();
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		this->SliceIndices[axis] = index;
+		return texture.get();
+	}
+
 	void IsoSurface::ConvertToPolygon() {
 		if (!this->IsInitialize) {
 			Logger::Message(LOG_ERROR, "YOU MUST LOAD THE VOLUME DATA FIRST!");
@@ -195,36 +683,48 @@ namespace Nexus {
 		// Get the start time.
 		auto start = std::chrono::system_clock::now();
 
-		// Initialize and clean the vector;
 		this->IsReadyToDraw = false;
-		this->Vertices.clear();
-		this->Position.clear();
-		this->Normal.clear();
+		this->StopProgressiveExtraction();
 
-		if (this->CurrentRenderMode == RENDER_MODE_ISO_SURFACE) {
+		if (this->CurrentRenderMode == RENDER_MODE_ISO_SURFACE && this->EnableChunkedLevelOfDetail) {
+			// 分塊抽取：這裡只建立 chunk 的索引，實際的抽取在 UpdateChunks 中依照相機位置於背景進行。
+			if (!this->Chunks) {
+				this->DerivedData.Require(DERIVED_DATA_GRADIENTS);
+				this->Chunks = std::make_unique<ChunkedIsoSurface>(this->RawData, this->GridNormals, glm::ivec3(this->Attributes.Resolution), this->Attributes.Ratio);
+			}
+			this->Chunks->SetIsoValue(this->IsoValue);
 
-			// Input the data set and iso-value
-			this->GenerateVertices(this->IsoValue);
+		} else if (this->CurrentRenderMode == RENDER_MODE_ISO_SURFACE && this->EnableProgressive) {
+			// 在背景中一個 slab 一個 slab 地抽取，這裡只配置 buffer，之後由 Draw 逐步上傳。
+			this->StartProgressiveExtraction();
+
+		} else if (this->CurrentRenderMode == RENDER_MODE_ISO_SURFACE) {
+			// Extract the surface on the CPU (no OpenGL calls involved).
+			this->ExtractSurface();
 
 			// Send the position and normal of these vertices to the GPU
 			this->BufferInitialize();
 			
-		} else if (this->CurrentRenderMode == RENDER_MODE_RAY_CASTING) {
-			// Generate a new data and sent into gpu (r, g, b) => Gradient, a => Value;
-			this->GenerateTextureData();
-
-			// Creating a 3D Texture.
-			// Please make sure your texture settings (it is GL_FLOAT, not GL_UNSIGNED_BYTE)
-			glGenTextures(1, &this->VolumeTexture);
-			glBindTexture(GL_TEXTURE_3D, this->VolumeTexture);
-			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-			glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA32F, static_cast<GLsizei>(Attributes.Resolution.x), static_cast<GLsizei>(Attributes.Resolution.y), static_cast<GLsizei>(Attributes.Resolution.z), 0, GL_RGBA, GL_FLOAT, this->TextureData.data());
-			glBindTexture(GL_TEXTURE_3D, 0);
+		} else if (this->GetIsVolumeRendering()) {
+			// 資料與 texture 的設定都沒有改變時（例如只是切換 render mode），volume texture 不需要重新產生與上傳。
+			this->DerivedData.Require(DERIVED_DATA_VOLUME_TEXTURE);
+			if (this->CurrentRenderMode == RENDER_MODE_RAY_CASTING) {
+				if (this->EnableTransferFunction2D) {
+					this->TransferFunction2DTable.Update();
+					this->UploadTransferFunction2D();
+				}
+				if (this->EnableEmptySpaceSkipping) {
+					this->UpdateOccupancy();
+				}
+				if (this->EnablePreIntegration) {
+					this->PreIntegration.Update(this->TransferFunction, this->PreIntegrationStepSize);
+					this->UploadPreIntegrationTable();
+				}
+			} else {
+				// 投影不經過 transfer function，只需要每個 brick 的數值範圍。
+				this->DerivedData.Require(DERIVED_DATA_BRICK_RANGE_TEXTURE);
+			}
+			this->ProgressiveRendering.Invalidate();
 
 			// Creating a bounding-box with texture coordinate.
 			glm::vec3 resolution = Attributes.Resolution * Attributes.Ratio;
@@ -252,19 +752,24 @@ namespace Nexus {
 				6, 2, 1,
 				6, 1, 5
 			};
-			glGenVertexArrays(1, &BoundingBoxVAO);
-			glGenBuffers(1, &BoundingBoxVBO);
-			glGenBuffers(1, &BoundingBoxEBO);
-			glBindVertexArray(BoundingBoxVAO);
-			glBindBuffer(GL_ARRAY_BUFFER, BoundingBoxVBO);
-			glBufferData(GL_ARRAY_BUFFER, this->BoundingBoxVertices.size() * sizeof(float), this->BoundingBoxVertices.data(), GL_STATIC_DRAW);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, BoundingBoxEBO);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->BoundingBoxIndices.size() * sizeof(unsigned int), this->BoundingBoxIndices.data(), GL_STATIC_DRAW);
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (const void*)0);
-			glEnableVertexAttribArray(1);
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (const void*)(3 * sizeof(float)));
-			glBindVertexArray(0);
+			// Bounding box 的大小固定，第一次建立之後只需要更新頂點（解析度可能改變）。
+			if (this->BoundingBoxVAO == 0) {
+				glGenVertexArrays(1, &BoundingBoxVAO);
+				glGenBuffers(1, &BoundingBoxVBO);
+				glGenBuffers(1, &BoundingBoxEBO);
+				glBindVertexArray(BoundingBoxVAO);
+				glBindBuffer(GL_ARRAY_BUFFER, BoundingBoxVBO);
+				glBufferData(GL_ARRAY_BUFFER, this->BoundingBoxVertices.size() * sizeof(float), this->BoundingBoxVertices.data(), GL_STATIC_DRAW);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, BoundingBoxEBO);
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->BoundingBoxIndices.size() * sizeof(unsigned int), this->BoundingBoxIndices.data(), GL_STATIC_DRAW);
+				glEnableVertexAttribArray(0);
+				glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (const void*)0);
+				glEnableVertexAttribArray(1);
+				glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (const void*)(3 * sizeof(float)));
+				glBindVertexArray(0);
+			} else {
+				this->UploadBufferData(BoundingBoxVBO, 0, this->BoundingBoxVertices.size() * sizeof(float), this->BoundingBoxVertices.data());
+			}
 		}
 
 		// Ready to draw
@@ -274,12 +779,33 @@ namespace Nexus {
 		this->ElapsedSeconds = end - start;
 	}
 
+	void IsoSurface::ConvertToPolygon(const ClipRegion& clip_region) {
+		// 背景抽取會讀取 Clip，要先停下來才能換掉。
+		this->StopProgressiveExtraction();
+		this->Clip = clip_region;
+		this->ConvertToPolygon();
+	}
+
+	void IsoSurface::UpdateChunks(const Camera& camera, glm::mat4 model) {
+		if (!this->EnableChunkedLevelOfDetail || !this->Chunks || this->CurrentRenderMode != RENDER_MODE_ISO_SURFACE) {
+			return;
+		}
+		this->Chunks->Update(camera.GetPosition(), model);
+	}
+
+	void IsoSurface::UpdateProgressiveRendering(const glm::mat4& view, const glm::mat4& projection, glm::mat4 model) {
+		if (!this->EnableProgressiveRendering || !this->GetIsVolumeRendering()) {
+			return;
+		}
+		this->ProgressiveRendering.Update(projection * view * model);
+	}
+
 	void IsoSurface::GenerateIsoValueHistogram() {
 		// 初始化，將此 Volume Data 的資料分成 m 等份
 		this->IsoValueHistogram = std::vector<float>(static_cast<unsigned int>(this->Interval), 0.0f);
 
 		// 必須先找出資料中最大值做為下界，上界則採用 0。
-		float max_isovalue = *std::max_element(this->RawData.cbegin(), this->RawData.cend());
+		float max_isovalue = this->MaxValue;
 
 		// 必須將 iso value 介於 0 到 max_isovalue 之間 切成 m 個等分，先求間距
 		float bin_width = ((max_isovalue - 0) + 1) / this->Interval;
@@ -308,7 +834,7 @@ namespace Nexus {
 		this->GradientHistogram = std::vector<float>(static_cast<unsigned int>(this->Interval), 0.0f);
 
 		// 必須先找出資料中最大值做為下界，上界則採用 0。
-		float max_gradient = *std::max_element(this->GradientMagnitudes.cbegin(), this->GradientMagnitudes.cend());
+		float max_gradient = this->MaxGradientMagnitude;
 
 		// 必須將 gradient 的長度介於 0 到 max_gradient 之間 切成 k 個等分，先求間距
 		float bin_width = ((max_gradient - 0) + 1) / this->Interval;
@@ -360,10 +886,13 @@ namespace Nexus {
 	
 	void IsoSurface::IsoValueHistogramEqualization() {
 		this->IsEqualization = true;
+		this->Chunks.reset();
+		this->StopProgressiveExtraction();
+		this->VolumeStreamer.Cancel();
 		
-		// 先取得舊的 histogram，並重新初始化
+		// 先取得舊的 histogram
+		this->RequireHistograms({ DERIVED_DATA_ISO_VALUE_HISTOGRAM });
 		std::vector<float> old_histogram = this->IsoValueHistogram;
-		this->IsoValueHistogram = std::vector<float>(256, 0.0f);
 
 		// 計算總所有 iso value 為 0 ~ 255 的顯示次數。 
 		float total_iso_value = static_cast<float>(std::accumulate(old_histogram.cbegin(), old_histogram.cend(), 0.0));
@@ -389,28 +918,47 @@ namespace Nexus {
 		}
 
 		// 得到的數值是所謂的均衡化值 比如 equal_values[0] = 71 代表 原本  iso value = 0 均衡化後，調整為iso value = 71  數量是不變的
-		for (int i = 0; i < equal_values.size(); i++) {
-			this->IsoValueHistogram[equal_values[i]] += old_histogram[i];
-		}
-
 		// 最後別忘了要對整個 Volume Data 做一樣的操作（均值化）！
 		this->EqualizationData(equal_values);
+
+		// RawData 已經改變：gradient、histogram、heatmap、空間索引與 volume texture 都要重新計算，等到下一次需要時才進行。
+		this->DerivedData.Invalidate(DERIVED_DATA_RAW_DATA);
+	}
+
+	void IsoSurface::RequireHistograms(const std::vector<unsigned int>& nodes) {
+		if (!this->IsInitialize) {
+			return;
+		}
+		// Interval 是公開的成員，改變之後在下一次取用時才重新分 bin。
+		if (this->Interval != this->HistogramInterval) {
+			this->DerivedData.Invalidate(DERIVED_DATA_ISO_VALUE_HISTOGRAM);
+			this->DerivedData.Invalidate(DERIVED_DATA_GRADIENT_HISTOGRAM);
+			this->HistogramInterval = this->Interval;
+		}
+		this->DerivedData.Require(nodes);
 	}
 
 	std::vector<float> IsoSurface::GetIsoValueHistogram() {
+		this->RequireHistograms({ DERIVED_DATA_ISO_VALUE_HISTOGRAM });
 		return this->IsoValueHistogram;
 	}
 	
 	std::vector<float> IsoSurface::GetGradientHistogram() {
+		this->RequireHistograms({ DERIVED_DATA_GRADIENT_HISTOGRAM });
 		return this->GradientHistogram;
 	}
 	
 	std::vector<float> IsoSurface::GetGradientHeatmap() {
+		this->RequireHistograms({ DERIVED_DATA_GRADIENT_HEATMAP });
 		return this->GradientHeatmap;
 	}
 
 	void IsoSurface::GetGradientHeatmapAxisLabels(std::vector<std::string>& labels, bool is_axis_x) {
 		labels.clear();
+		this->RequireHistograms({ DERIVED_DATA_ISO_VALUE_HISTOGRAM, DERIVED_DATA_GRADIENT_HISTOGRAM });
+		if ((is_axis_x ? this->IsoValueBoundary : this->GradientBoundary).empty()) {
+			return;
+		}
 		if (is_axis_x) {
 			float x_bin = this->IsoValueBoundary.size() / 4.0f;
 			for (unsigned int i = 0; i <= 4; i++) {
@@ -451,24 +999,66 @@ namespace Nexus {
 			return;
 		}
 
+		// 每個衍生資料計算過幾次，還沒有更新的標記為 stale。
+		std::string derived_data;
+		for (unsigned int i = DERIVED_DATA_VALUE_RANGE; i < this->DerivedData.GetNodeCount(); i++) {
+			derived_data += (i == DERIVED_DATA_VALUE_RANGE ? "" : ", ") + this->DerivedData.GetName(i) + " x" + std::to_string(this->DerivedData.GetComputeCount(i))
+				+ (this->DerivedData.IsDirty(i) ? " (stale)" : "");
+		}
+
 		if (this->CurrentRenderMode == RENDER_MODE_ISO_SURFACE) {
 			std::cout << "==================== Iso Surface Information ====================" << std::endl
 				<< "Raw File Path: " << this->RawDataFilePath << std::endl
-				<< "Construct Method: March Cube Method" << std::endl
+				<< "Construct Method: " << GetExtractionMethodName() << std::endl
 				<< "Voxel Count: " << GetVoxelCount() << std::endl
 				<< "Triangle Count: " << GetTriangleCount() << std::endl
 				<< "Vertex Count: " << GetVertexCount() << std::endl
 				<< "Position Count: " << GetPositionCount() << std::endl
 				<< "Normal Count: " << GetNormalCount() << std::endl
-				<< "Gradient Magnitudes Counts: " << this->GradientMagnitudes.size() << std::endl
+				<< "Index Count: " << GetIndexCount() << std::endl
+				<< "Vertex Buffer Size: " << GetVertexBufferSize() / 1024 << " (KB)" << (this->SurfaceBuffers[this->FrontSurfaceBuffer].IsCompressed ? " compressed" : "") << std::endl
+				<< "Active Bricks: " << GetActiveBrickCount() << " / " << GetBrickCount() << std::endl;
+			if (this->EnableChunkedLevelOfDetail && this->Chunks) {
+				std::cout << "Chunks: " << this->Chunks->GetDrawnChunkCount() << " drawn, " << this->Chunks->GetActiveChunkCount() << " active / " << this->Chunks->GetChunkCount()
+					<< ", " << this->Chunks->GetDrawnTriangleCount() << " triangles, " << this->Chunks->GetPendingJobCount() << " pending, "
+					<< this->Chunks->GetCachedChunkCount() << " cached (" << this->Chunks->GetCacheBytes() / 1024 << " KB)" << std::endl;
+			}
+			if (this->IsProgressiveBuffer || this->ProgressiveActive) {
+				std::cout << "Progressive: " << this->ProgressiveSlabsExtracted << " / " << this->ProgressiveSlabCount << " slabs extracted"
+					<< (this->ProgressiveActive ? ", uploading" : ", completed") << " (budget " << this->ProgressiveUploadBudget / 1024 << " KB / frame)" << std::endl;
+			}
+			std::cout << "Layer Count: " << this->Layers.size() << std::endl;
+			for (size_t l = 0; l < this->Layers.size(); l++) {
+				const IsoSurfaceLayer& layer = this->Layers[l];
+				std::cout << "  Layer " << l << ": iso value " << layer.IsoValue << ", "
+					<< (this->GetIndexCount() == 0 ? layer.VertexCount / 3 : layer.IndexCount / 3) << " triangles"
+					<< (layer.Visible ? "" : " (hidden)") << std::endl;
+			}
+			std::cout << "Gradient Magnitudes Counts: " << this->GradientMagnitudes.size() << std::endl
+				<< "Derived data: " << derived_data << std::endl
+				<< "Extraction time: " << this->ExtractionSeconds.count() << " (seconds)" << std::endl
+				<< "Extraction throughput: " << (GetExtractionSeconds() > 0.0 ? GetVoxelCount() / GetExtractionSeconds() / 1.0e6 : 0.0) << " (M voxels / second)" << std::endl
+				<< "Component filter: " << (this->EnableComponentFilter ? std::to_string(GetRemovedComponentCount()) + " components removed" : std::string("disabled")) << std::endl
+				<< "Mesh optimization: " << (this->EnableMeshOptimization ? "ACMR " + std::to_string(GetACMRBefore()) + " -> " + std::to_string(GetACMRAfter()) : std::string("disabled")) << std::endl
+				<< "Decimation: " << (this->EnableDecimation ? std::to_string(GetExtractedTriangleCount()) + " -> " + std::to_string(GetTriangleCount()) + " triangles, " + std::to_string(GetDecimationSeconds()) + " (seconds)" : std::string("disabled")) << std::endl
 				<< "Elapsed time: " << this->ElapsedSeconds.count() << " (seconds)" << std::endl
 				<< "================================================================================" << std::endl;
-		} else if (this->CurrentRenderMode == RENDER_MODE_RAY_CASTING) {
+		} else if (this->GetIsVolumeRendering()) {
 			std::cout << "==================== Volume Rendering Information ====================" << std::endl
 				<< "Raw File Path: " << this->RawDataFilePath << std::endl
-				<< "Construct Method: Ray Casting" << std::endl
+				<< "Construct Method: " << GetRenderModeName() << std::endl
 				<< "Voxel Count: " << GetVoxelCount() << std::endl
+				<< "Volume Texture: " << (this->CurrentVolumeTextureFormat == VOLUME_TEXTURE_FORMAT_SCALAR ? "scalar" : "RGBA32F")
+				<< (this->GradientTexture != 0 ? " + gradient" : "") << ", " << GetVolumeTextureBytes() / (1024 * 1024) << " MB" << std::endl
+				<< "Empty space skipping: " << (this->EnableEmptySpaceSkipping ? std::to_string(this->Occupancy.GetOccupiedBrickCount()) + " / " + std::to_string(this->Occupancy.GetBrickCount()) + " bricks occupied" : std::string("disabled")) << std::endl
+				<< "Projection bricks: " << (this->GetIntensityProjection() != INTENSITY_PROJECTION_NONE && !this->ProjectionBricks.IsEmpty() ? std::to_string(this->ProjectionBricks.GetRanges().size()) + " bricks, value range "
+					+ std::to_string(this->ProjectionBricks.GetVolumeRange().x) + " - " + std::to_string(this->ProjectionBricks.GetVolumeRange().y) : std::string("disabled")) << std::endl
+				<< "Transfer function: " << (this->EnableTransferFunction2D ? "2D, " + std::to_string(this->TransferFunction2DTable.GetRegions().size()) + " regions" : std::string("1D")) << std::endl
+				<< "Volume streaming: " << (this->EnableStreamingUpload ? std::to_string(this->VolumeStreamer.GetResidentBrickCount()) + " / " + std::to_string(this->VolumeStreamer.GetBrickCount()) + " bricks resident" : std::string("disabled")) << std::endl
+				<< "Progressive rendering: " << (this->EnableProgressiveRendering ? (this->ProgressiveRendering.GetIsInteractive() ? "interactive, scale " + std::to_string(this->ProgressiveRendering.GetScale())
+					+ ", " + std::to_string(this->ProgressiveRendering.GetLastPassMilliseconds()) + " ms" : std::to_string(this->ProgressiveRendering.GetAccumulatedFrames()) + " frames accumulated") : std::string("disabled")) << std::endl
 				<< "Gradient Magnitudes Counts: " << this->GradientMagnitudes.size() << std::endl
+				<< "Derived data: " << derived_data << std::endl
 				<< "Elapsed time: " << this->ElapsedSeconds.count() << " (seconds)" << std::endl
 				<< "================================================================================" << std::endl;
 		}
@@ -482,136 +1072,654 @@ namespace Nexus {
 		
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-		if (this->CurrentRenderMode == RENDER_MODE_ISO_SURFACE) {
+		if (this->CurrentRenderMode == RENDER_MODE_ISO_SURFACE && this->EnableChunkedLevelOfDetail && this->Chunks) {
+			glPolygonMode(GL_FRONT_AND_BACK, this->EnableWireFrameMode ? GL_LINE : GL_FILL);
+			this->Chunks->Draw(shader, model);
+		} else if (this->CurrentRenderMode == RENDER_MODE_ISO_SURFACE) {
+			// 把背景中已經抽取完成的 slab 附加到 buffer 的尾端，這個 frame 就畫到目前為止的部分。
+			this->UploadProgressiveSlabs();
+
 			shader->Use();
-			shader->SetMat4("model", model);
+			// 壓縮過的位置是 [0, 1] 的比例，把還原的縮放放進 model matrix；法向量矩陣仍然使用原本的 model。
+			if (this->SurfaceBuffers[this->FrontSurfaceBuffer].IsCompressed) {
+				shader->SetMat4("model", model * glm::scale(glm::mat4(1.0f), this->QuantizationExtent));
+			} else {
+				shader->SetMat4("model", model);
+			}
 			shader->SetMat3("normalModel", glm::mat3(glm::transpose(glm::inverse(model))));
 			shader->SetBool("is_volume", true);
 			
 			// this->VAO->Bind();
-			glBindVertexArray(this->VAO);
+			glBindVertexArray(this->SurfaceBuffers[this->FrontSurfaceBuffer].VAO);
 			if (this->EnableWireFrameMode) {
 				glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 			} else {
 				glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 			}
-			glDrawArrays(GL_TRIANGLES, 0, this->GetPositionCount());
+			if (this->Layers.empty() || this->IsProgressiveBuffer) {
+				if (this->IndexCount == 0 && !this->ProgressiveIndexed) {
+					glDrawArrays(GL_TRIANGLES, 0, this->VertexCount);
+				} else {
+					glDrawElements(GL_TRIANGLES, (GLsizei)this->IndexCount, GL_UNSIGNED_INT, 0);
+				}
+			} else {
+				// 每一層只畫自己在共用 buffer 中的範圍，隱藏的圖層不畫。
+				for (const IsoSurfaceLayer& layer : this->Layers) {
+					if (!layer.Visible) {
+						continue;
+					}
+					if (this->IndexCount == 0) {
+						glDrawArrays(GL_TRIANGLES, (GLint)layer.FirstVertex, (GLsizei)layer.VertexCount);
+					} else {
+						glDrawElements(GL_TRIANGLES, (GLsizei)layer.IndexCount, GL_UNSIGNED_INT, (void*)(layer.FirstIndex * sizeof(unsigned int)));
+					}
+				}
+			}
 			glBindVertexArray(0);
 		}
 
-		if (this->CurrentRenderMode == RENDER_MODE_RAY_CASTING) {
+		if (this->GetIsVolumeRendering()) {
+			// Progressive rendering：累積完成之後不再 ray casting，只把 offscreen 的結果疊回畫面。
+			// 串流上傳在 render 之前進行，這個 frame 新到的 brick 馬上就畫得到。
+			// 資料改變（例如 equalization）之後 GPU 上的 texture 都要在這裡更新，沒有改變時 Require 不做任何事。
+			const bool is_projection = this->GetIntensityProjection() != INTENSITY_PROJECTION_NONE;
+			if (this->DerivedData.IsDirty(DERIVED_DATA_VOLUME_TEXTURE) || (is_projection && this->DerivedData.IsDirty(DERIVED_DATA_BRICK_RANGE_TEXTURE))) {
+				this->ProgressiveRendering.Invalidate();
+			}
+			this->DerivedData.Require(DERIVED_DATA_VOLUME_TEXTURE);
+			if (is_projection) {
+				this->DerivedData.Require(DERIVED_DATA_BRICK_RANGE_TEXTURE);
+			} else if (this->CurrentRenderMode == RENDER_MODE_RAY_CASTING && this->EnableEmptySpaceSkipping
+				&& (this->Occupancy.IsEmpty() || this->DerivedData.IsDirty(DERIVED_DATA_SPATIAL_INDEX))) {
+				// BuildSpatialIndex 會清掉 occupancy，重新建立並上傳。
+				this->UpdateOccupancy();
+				this->ProgressiveRendering.Invalidate();
+			}
+			if (this->VolumeStreamer.Update()) {
+				this->ProgressiveRendering.Invalidate();
+			}
+			const bool is_progressive = this->EnableProgressiveRendering && this->ProgressiveCompositeShader != nullptr;
+			if (is_progressive && !this->ProgressiveRendering.BeginFrame()) {
+				this->ProgressiveRendering.EndFrame(this->ProgressiveCompositeShader);
+				return;
+			}
+
 			shader->Use();
 			shader->SetMat4("model", model);
+			// 還沒上傳的 brick 在 residency texture 中是 0，shader 把它們當成透明的。
+			shader->SetBool("volume_streaming", this->VolumeStreamer.GetIsStreaming());
+			if (this->VolumeStreamer.GetIsStreaming()) {
+				shader->SetInt("volume_residency", 5);
+				shader->SetVec3("volume_brick_grid", glm::vec3(this->VolumeStreamer.GetBrickGridSize()));
+				glActiveTexture(GL_TEXTURE5);
+				glBindTexture(GL_TEXTURE_3D, this->VolumeStreamer.GetResidencyTexture());
+				glActiveTexture(GL_TEXTURE0);
+			}
+			// 2D transfer function 以（數值, gradient 長度）查表：單通道的 volume 把 gradient 長度放在 g，
+			// RGBA32F 則由 rgb 的 gradient 算出 20 * log2(clamp(|g|, 1, max)) 再除以 gradient_magnitude_db_max。
+			shader->SetBool("has_transfer_function_2d", this->EnableTransferFunction2D && this->TransferFunction2DTexture != 0);
+			if (this->EnableTransferFunction2D && this->TransferFunction2DTexture != 0) {
+				shader->SetInt("transfer_function_2d", 6);
+				shader->SetFloat("gradient_magnitude_db_max", 1.0f / this->GetGradientMagnitudeScale());
+				glActiveTexture(GL_TEXTURE6);
+				glBindTexture(GL_TEXTURE_2D, this->TransferFunction2DTexture);
+				glActiveTexture(GL_TEXTURE0);
+			}
+			// Pre-integration 的表格是以固定的取樣間距計算的，互動時只降低解析度，不放大取樣間距。
+			shader->SetFloat("step_scale", is_progressive && !this->EnablePreIntegration ? this->ProgressiveRendering.GetStepScale() : 1.0f);
+			shader->SetFloat("ray_offset", is_progressive ? this->ProgressiveRendering.GetRayOffset() : 0.0f);
 			shader->SetInt("volume", 0);
 			shader->SetInt("transfer_function", 1);
+			// intensity_projection 是 IntensityProjection，不是 NONE 時 shader 輸出灰階，不使用 transfer function。
+			// MIP / MinIP 以 projection_brick_range 的 (min, max) 跳過不會改變結果的 brick，
+			// 目前的最大（最小）值到達 projection_value_range 時提早結束。
+			shader->SetInt("intensity_projection", this->GetIntensityProjection());
+			if (this->GetIntensityProjection() != INTENSITY_PROJECTION_NONE && this->ProjectionBrickTexture != 0) {
+				shader->SetInt("projection_brick_range", 7);
+				shader->SetInt("projection_brick_size", this->ProjectionBricks.GetBrickSize());
+				shader->SetVec3("projection_brick_grid", glm::vec3(this->ProjectionBricks.GetGridSize()));
+				shader->SetVec2("projection_value_range", this->ProjectionBricks.GetVolumeRange());
+				glActiveTexture(GL_TEXTURE7);
+				glBindTexture(GL_TEXTURE_3D, this->ProjectionBrickTexture);
+				glActiveTexture(GL_TEXTURE0);
+			}
 			shader->SetVec3("volume_resolution", this->Attributes.Resolution);
             shader->SetVec3("volume_ratio", this->Attributes.Ratio);
+			// 單通道的 volume 只有數值，gradient 來自 gradient_volume 或在 shader 中以鄰近的 voxel 計算。
+			shader->SetBool("scalar_volume", this->CurrentVolumeTextureFormat == VOLUME_TEXTURE_FORMAT_SCALAR);
+			shader->SetBool("has_gradient_volume", this->GradientTexture != 0);
+			if (this->GradientTexture != 0) {
+				shader->SetInt("gradient_volume", 2);
+				glActiveTexture(GL_TEXTURE2);
+				glBindTexture(GL_TEXTURE_3D, this->GradientTexture);
+				glActiveTexture(GL_TEXTURE0);
+			}
+			// Pre-integration 表格的 x 是前一個樣本、y 是後一個樣本，shader 必須以 preintegration_step（voxel）前進。
+			// 2D transfer function 優先，pre-integration 表格只對應 1D transfer function。
+			const bool is_pre_integrated = this->EnablePreIntegration && this->PreIntegrationTexture != 0 && !this->EnableTransferFunction2D;
+			shader->SetBool("pre_integrated", is_pre_integrated);
+			if (is_pre_integrated) {
+				shader->SetInt("preintegration_table", 4);
+				shader->SetFloat("preintegration_step", this->PreIntegration.GetStepSize());
+				glActiveTexture(GL_TEXTURE4);
+				glBindTexture(GL_TEXTURE_2D, this->PreIntegrationTexture);
+				glActiveTexture(GL_TEXTURE0);
+			}
+			// Distance map 以 brick 為單位：距離 d 代表往任何方向前進 d - 1 個 brick 都不會遇到可見的樣本。
+			// Occupancy 是由 transfer function 決定的，投影時完全透明的 brick 仍然會影響結果。
+			const bool is_skipping_empty_space = this->EnableEmptySpaceSkipping && this->OccupancyTexture != 0 && this->CurrentRenderMode == RENDER_MODE_RAY_CASTING;
+			shader->SetBool("empty_space_skipping", is_skipping_empty_space);
+			if (is_skipping_empty_space) {
+				shader->SetInt("occupancy_distance", 3);
+				shader->SetInt("occupancy_brick_size", this->Occupancy.GetBrickSize());
+				shader->SetVec3("occupancy_grid_size", glm::vec3(this->Occupancy.GetGridSize()));
+				glActiveTexture(GL_TEXTURE3);
+				glBindTexture(GL_TEXTURE_3D, this->OccupancyTexture);
+				glActiveTexture(GL_TEXTURE0);
+			}
 
 			// Draw a bounding-box, size will be the resolution of the volume data.
 			glBindVertexArray(this->BoundingBoxVAO);
 			glDrawElements(GL_TRIANGLES, (GLsizei)this->BoundingBoxIndices.size(), GL_UNSIGNED_INT, 0);
 			glBindVertexArray(0);
+
+			if (is_progressive) {
+				this->ProgressiveRendering.EndFrame(this->ProgressiveCompositeShader);
+			}
 		}
 	}
 
 	void IsoSurface::ComputeAllNormals(float max_gradient) {
-		// 計算每一個 Voxel 的 Gradient 來當作法向量。
-		for (int k = 0; k < Attributes.Resolution.z; k++) {
-			for (int j = 0; j < Attributes.Resolution.y; j++) {
-				for (int i = 0; i < Attributes.Resolution.x; i++) {
-					glm::vec3 norm = glm::vec3(0.0f);
-
-					if (i + 1 >= Attributes.Resolution.x) {
-						// Backward difference
-						norm.x = (this->GetIsoValueFromGrid(i, j, k) - this->GetIsoValueFromGrid(i - 1, j, k)) / Attributes.Ratio.x;
-					} else if (i - 1 < 0) {
-						// Forward difference
-						norm.x = (this->GetIsoValueFromGrid(i + 1, j, k) - this->GetIsoValueFromGrid(i, j, k)) / Attributes.Ratio.x;
-					} else {
-						// Central difference
-						norm.x = (this->GetIsoValueFromGrid(i + 1, j, k) - this->GetIsoValueFromGrid(i - 1, j, k)) / 2 * Attributes.Ratio.x;
+		// 計算每一個 Voxel 的 Gradient 來當作法向量，每個 z 切片互相獨立，平行計算。
+		this->GridNormals.assign(this->RawData.size(), glm::vec3(0.0f));
+		this->GradientMagnitudes.assign(this->RawData.size(), 0.0f);
+		ThreadPool::GetInstance().ParallelFor(0, (unsigned int)Attributes.Resolution.z, [this, max_gradient](unsigned int begin, unsigned int end) {
+			for (int k = (int)begin; k < (int)end; k++) {
+				for (int j = 0; j < Attributes.Resolution.y; j++) {
+					for (int i = 0; i < Attributes.Resolution.x; i++) {
+						glm::vec3 norm = glm::vec3(0.0f);
+
+						if (i + 1 >= Attributes.Resolution.x) {
+							// Backward difference
+							norm.x = (this->GetIsoValueFromGrid(i, j, k) - this->GetIsoValueFromGrid(i - 1, j, k)) / Attributes.Ratio.x;
+						} else if (i - 1 < 0) {
+							// Forward difference
+							norm.x = (this->GetIsoValueFromGrid(i + 1, j, k) - this->GetIsoValueFromGrid(i, j, k)) / Attributes.Ratio.x;
+						} else {
+							// Central difference
+							norm.x = (this->GetIsoValueFromGrid(i + 1, j, k) - this->GetIsoValueFromGrid(i - 1, j, k)) / 2 * Attributes.Ratio.x;
+						}
+
+						if (j + 1 >= Attributes.Resolution.y) {
+							// Backward difference
+							norm.y = (this->GetIsoValueFromGrid(i, j, k) - this->GetIsoValueFromGrid(i, j - 1, k)) / Attributes.Ratio.y;
+						} else if (j - 1 < 0) {
+							// Forward difference
+							norm.y = (this->GetIsoValueFromGrid(i, j + 1, k) - this->GetIsoValueFromGrid(i, j, k)) / Attributes.Ratio.y;
+						} else {
+							// Central difference
+							norm.y = (this->GetIsoValueFromGrid(i, j + 1, k) - this->GetIsoValueFromGrid(i, j - 1, k)) / 2 * Attributes.Ratio.y;
+						}
+
+						if (k + 1 >= Attributes.Resolution.z) {
+							// Backward difference
+							norm.z = (this->GetIsoValueFromGrid(i, j, k) - this->GetIsoValueFromGrid(i, j, k - 1)) / Attributes.Ratio.z;
+						} else if (k - 1 < 0) {
+							// Forward difference
+							norm.z = (this->GetIsoValueFromGrid(i, j, k + 1) - this->GetIsoValueFromGrid(i, j, k)) / Attributes.Ratio.z;
+						} else {
+							// Central difference
+							norm.z = (this->GetIsoValueFromGrid(i, j, k + 1) - this->GetIsoValueFromGrid(i, j, k - 1)) / 2 * Attributes.Ratio.z;
+						}
+
+						// Gradient 長度分貝化
+						float temp_length = glm::length(norm);
+						if (temp_length < 1) {
+							temp_length = 1;
+						} else if (temp_length > max_gradient) {
+							temp_length = max_gradient;
+						}
+						temp_length = 20.0f * glm::log2(temp_length);
+						const unsigned int index = this->GetIndexFromGrid(i, j, k);
+						this->GradientMagnitudes[index] = temp_length;
+						this->GridNormals[index] = norm;
 					}
+				}
+			}
+		}, 1);
+		this->MaxGradientMagnitude = this->GradientMagnitudes.empty() ? 0.0f : *std::max_element(this->GradientMagnitudes.cbegin(), this->GradientMagnitudes.cend());
+	}
+	
+	void IsoSurface::BuildSpatialIndex() {
+		this->Octree.Build(this->RawData, glm::ivec3(this->Attributes.Resolution), this->BrickSize);
+		this->SpanIndex.Build(this->Octree);
+		// Occupancy grid 使用同一組 brick，下一次需要時再依照新的 min/max 重建。
+		this->Occupancy.Clear();
+	}
 
-					if (j + 1 >= Attributes.Resolution.y) {
-						// Backward difference
-						norm.y = (this->GetIsoValueFromGrid(i, j, k) - this->GetIsoValueFromGrid(i, j - 1, k)) / Attributes.Ratio.y;
-					} else if (j - 1 < 0) {
-						// Forward difference
-						norm.y = (this->GetIsoValueFromGrid(i, j + 1, k) - this->GetIsoValueFromGrid(i, j, k)) / Attributes.Ratio.y;
-					} else {
-						// Central difference
-						norm.y = (this->GetIsoValueFromGrid(i, j + 1, k) - this->GetIsoValueFromGrid(i, j - 1, k)) / 2 * Attributes.Ratio.y;
-					}
+	void IsoSurface::GetActiveBricks(float iso_value, std::vector<unsigned int>& bricks) const {
+		// Span-space 索引可以直接列出所有跨越 iso value 的 brick；沒有索引時才從 octree 的根節點往下找。
+		if (!this->SpanIndex.IsEmpty()) {
+			this->SpanIndex.Query(iso_value, bricks);
+		} else {
+			this->Octree.GetActiveBricks(iso_value, bricks);
+		}
+		// 依照 brick 的編號排序，讓輸出的三角形順序與執行緒數量無關。
+		std::sort(bricks.begin(), bricks.end());
+	}
 
-					if (k + 1 >= Attributes.Resolution.z) {
-						// Backward difference
-						norm.z = (this->GetIsoValueFromGrid(i, j, k) - this->GetIsoValueFromGrid(i, j, k - 1)) / Attributes.Ratio.z;
-					} else if (k - 1 < 0) {
-						// Forward difference
-						norm.z = (this->GetIsoValueFromGrid(i, j, k + 1) - this->GetIsoValueFromGrid(i, j, k)) / Attributes.Ratio.z;
-					} else {
-						// Central difference
-						norm.z = (this->GetIsoValueFromGrid(i, j, k + 1) - this->GetIsoValueFromGrid(i, j, k - 1)) / 2 * Attributes.Ratio.z;
-					}
+	void IsoSurface::GenerateVertices(std::vector<IsoSurfaceLayer>& layers) {
 
-					// Gradient 長度分貝化
-					float temp_length = glm::length(norm);
-					if (temp_length < 1) {
-						temp_length = 1;
-					} else if (temp_length > max_gradient) {
-						temp_length = max_gradient;
-					}
-					temp_length = 20.0f * glm::log2(temp_length);
-					this->GradientMagnitudes.push_back(temp_length);
-					
-					this->GridNormals.push_back(norm);
+		Logger::Message(LOG_DEBUG, "Starting generate vertices....... It will takes a long time.");
+
+		glm::ivec3 cell_min, cell_max;
+		this->GetClipCellRange(cell_min, cell_max);
+		this->CollectActiveBricks(layers, cell_min, cell_max);
+
+		std::vector<std::vector<PolygonBuffer>> buffers;
+		this->PolygoniseBricks(this->ActiveBricks, layers, cell_min, cell_max, buffers);
+
+		// 先算出總大小一次配置好，避免合併時不斷重新配置與複製。
+		PolygonBuffer result;
+		size_t total_vertices = 0;
+		for (const std::vector<PolygonBuffer>& chunk : buffers) {
+			for (const PolygonBuffer& buffer : chunk) {
+				total_vertices += buffer.Vertices.size() / 6;
+			}
+		}
+		result.Vertices.reserve(total_vertices * 6);
+		result.Position.reserve(total_vertices * 3);
+		result.Normal.reserve(total_vertices * 3);
+		for (size_t l = 0; l < layers.size(); l++) {
+			layers[l].FirstVertex = (unsigned int)(result.Vertices.size() / 6);
+			for (std::vector<PolygonBuffer>& chunk : buffers) {
+				result.Append(chunk[l]);
+				chunk[l] = PolygonBuffer();
+			}
+			layers[l].VertexCount = (unsigned int)(result.Vertices.size() / 6) - layers[l].FirstVertex;
+			layers[l].FirstIndex = 0;
+			layers[l].IndexCount = 0;
+		}
+
+		this->Vertices = std::move(result.Vertices);
+		this->Position = std::move(result.Position);
+		this->Normal = std::move(result.Normal);
+		Logger::Message(LOG_DEBUG, "Generate vertices completed.");
+	}
+
+	void IsoSurface::CollectActiveBricks(const std::vector<IsoSurfaceLayer>& layers, glm::ivec3 cell_min, glm::ivec3 cell_max) {
+		// 先找出所有跨越任一 iso value 的 brick，其餘的 brick 內不可能有三角形，直接跳過。
+		this->ActiveBricks.clear();
+		std::vector<unsigned int> bricks;
+		for (const IsoSurfaceLayer& layer : layers) {
+			this->GetActiveBricks(layer.IsoValue, bricks);
+			this->ActiveBricks.insert(this->ActiveBricks.end(), bricks.begin(), bricks.end());
+		}
+		std::sort(this->ActiveBricks.begin(), this->ActiveBricks.end());
+		this->ActiveBricks.erase(std::unique(this->ActiveBricks.begin(), this->ActiveBricks.end()), this->ActiveBricks.end());
+
+		// 有設定 clip box / plane 時，完全在範圍外的 brick 也不用處理。
+		if (!this->Clip.IsEmpty()) {
+			this->ActiveBricks.erase(std::remove_if(this->ActiveBricks.begin(), this->ActiveBricks.end(), [&](unsigned int id) {
+				const VolumeBrick& brick = this->Octree.GetBrick(id);
+				glm::ivec3 brick_min = glm::max(brick.Origin, cell_min);
+				glm::ivec3 brick_max = glm::min(brick.Origin + brick.Size, cell_max);
+				if (brick_min.x >= brick_max.x || brick_min.y >= brick_max.y || brick_min.z >= brick_max.z) {
+					return true;
+				}
+				return this->IsClipped(glm::vec3(brick_min) * this->Attributes.Ratio, glm::vec3(brick_max) * this->Attributes.Ratio);
+			}), this->ActiveBricks.end());
+		}
+		Logger::Message(LOG_DEBUG, "Active bricks: " + std::to_string(this->ActiveBricks.size()) + " / " + std::to_string(this->Octree.GetBrickCount()));
+	}
+
+	void IsoSurface::PolygoniseBricks(const std::vector<unsigned int>& bricks, const std::vector<IsoSurfaceLayer>& layers, glm::ivec3 cell_min, glm::ivec3 cell_max, std::vector<std::vector<PolygonBuffer>>& buffers) const {
+		// 每個工作對每一層各有一個緩衝區，最後依照 圖層 -> brick 的順序合併，讓每一層在 buffer 中是連續的。
+		unsigned int brick_count = (unsigned int)bricks.size();
+		unsigned int chunk_count = 1;
+		if (this->EnableMultiThreading) {
+			chunk_count = std::max(1u, std::min(brick_count, ThreadPool::GetInstance().GetThreadCount() * 4));
+		}
+		buffers.assign(chunk_count, std::vector<PolygonBuffer>(layers.size()));
+		auto polygonise_chunks = [&](unsigned int begin, unsigned int end) {
+			for (unsigned int chunk = begin; chunk < end; chunk++) {
+				unsigned int first = static_cast<unsigned int>(static_cast<unsigned long long>(brick_count) * chunk / chunk_count);
+				unsigned int last = static_cast<unsigned int>(static_cast<unsigned long long>(brick_count) * (chunk + 1) / chunk_count);
+				for (unsigned int i = first; i < last; i++) {
+					this->PolygoniseBrick(this->Octree.GetBrick(bricks[i]), layers, buffers[chunk], cell_min, cell_max);
 				}
 			}
+		};
+		if (this->EnableMultiThreading) {
+			ThreadPool::GetInstance().ParallelFor(0, chunk_count, polygonise_chunks);
+		} else {
+			polygonise_chunks(0, chunk_count);
 		}
 	}
-	
-	void IsoSurface::GenerateVertices(float iso_value) {
 
-		Logger::Message(LOG_DEBUG, "Starting generate vertices....... It will takes a long time.");
-		
+	void IsoSurface::PolygoniseBrick(const VolumeBrick& brick, const std::vector<IsoSurfaceLayer>& layers, std::vector<PolygonBuffer>& buffers, glm::ivec3 cell_min, glm::ivec3 cell_max) const {
+		// 只處理這個 brick 真的有跨越的圖層。
+		std::vector<unsigned int> active_layers;
+		for (unsigned int l = 0; l < layers.size(); l++) {
+			if (MinMaxOctree::IsStraddling(brick.Min, brick.Max, layers[l].IsoValue)) {
+				active_layers.push_back(l);
+			}
+		}
+		if (active_layers.empty()) {
+			return;
+		}
+
+		// 迴圈範圍限制在 clip box 內，有 clip plane 時再逐一檢查每個 cell。
+		glm::ivec3 first = glm::max(brick.Origin, cell_min);
+		glm::ivec3 last = glm::min(brick.Origin + brick.Size, cell_max);
+		if (first.x >= last.x || first.y >= last.y || first.z >= last.z) {
+			return;
+		}
+
+		// 先把 brick 內的 voxel 整列整列地與每一層的 iso value 比較成 sign bitmask，再由相鄰的兩個 slice 組出每一列 cell 的 cube index，
+		// 整個 slice 或整列都沒有跨越 iso value 時直接跳過，不需要讀取任何 cell。
+		std::vector<CubeClassifier> classifiers(active_layers.size());
+		for (size_t a = 0; a < active_layers.size(); a++) {
+			classifiers[a].Classify(this->RawData, glm::ivec3(this->Attributes.Resolution), first, last, layers[active_layers[a]].IsoValue);
+		}
+		const int row_cells = last.x - first.x;
+		std::vector<uint8_t> cube_indices(active_layers.size() * row_cells);
+		std::vector<uint8_t> row_active(active_layers.size());
+
 		// 開始一個一個 Voxel 讀取，並且每讀一個 Voxel 就抓它其他7個 Voxel (能構成一個正方形的)，
 		// 一次輸入 8 個 Voxel，檢查並求出正方塊中所包覆的三角形頂點與法向量為何。
-		for (int k = 0; k < Attributes.Resolution.z - 1; k++) {
-			for (int j = 0; j < Attributes.Resolution.y - 1; j++) {
-				for (int i = 0; i < Attributes.Resolution.x - 1; i++) {
-					// Logger::Message(LOG_DEBUG, "Coordinate: (" + std::to_string(i) + ", " + std::to_string(j) + ", " + std::to_string(k) + ")");
-					std::vector<glm::vec3> VertexOrder = {
-						glm::vec3(i, j, k),
-						glm::vec3(i + 1, j, k),
-						glm::vec3(i + 1, j, k + 1),
-						glm::vec3(i, j, k + 1),
-						glm::vec3(i, j + 1, k),
-						glm::vec3(i + 1, j + 1, k),
-						glm::vec3(i + 1, j + 1, k + 1),
-						glm::vec3(i, j + 1, k + 1),
-					};
-
-					auto cell = GridCell();
-					for(int vertex_index = 0; vertex_index < VertexOrder.size(); vertex_index++) {
-						auto voxel = Voxel();
-						voxel.Position = VertexOrder[vertex_index];
-						voxel.Normal = this->GetNormalFromGrid(VertexOrder[vertex_index]);
-						voxel.Value = this->GetIsoValueFromGrid(VertexOrder[vertex_index]);
-						cell.vertices.push_back(voxel);
+		// 同一個 cell 只讀取一次，再分別對每一層的 iso value 做 Polygonise。
+		const bool has_planes = !this->Clip.Planes.empty();
+		for (int k = first.z; k < last.z; k++) {
+			bool is_slice_active = false;
+			for (const CubeClassifier& classifier : classifiers) {
+				is_slice_active = is_slice_active || classifier.IsSliceActive(k - first.z);
+			}
+			if (!is_slice_active) {
+				continue;
+			}
+			for (int j = first.y; j < last.y; j++) {
+				bool is_row_active = false;
+				for (size_t a = 0; a < active_layers.size(); a++) {
+					row_active[a] = classifiers[a].GetCubeIndices(j - first.y, k - first.z, &cube_indices[a * row_cells]);
+					is_row_active = is_row_active || row_active[a];
+				}
+				if (!is_row_active) {
+					continue;
+				}
+				for (int i = first.x; i < last.x; i++) {
+					// 所有圖層的 cube index 都是 0 或 255 的 cell 沒有三角形。
+					bool is_cell_active = false;
+					for (size_t a = 0; a < active_layers.size() && !is_cell_active; a++) {
+						is_cell_active = row_active[a] && MarchingCubesEdgeTable[cube_indices[a * row_cells + i - first.x]] != 0;
+					}
+					if (!is_cell_active) {
+						continue;
+					}
+					// 整個 cell 在 plane 外側時它的三角形也一定在外側，直接跳過；其餘的三角形與其他抽取方法一樣逐一檢查。
+					if (has_planes && this->IsClipped(glm::vec3(i, j, k) * this->Attributes.Ratio, glm::vec3(i + 1, j + 1, k + 1) * this->Attributes.Ratio)) {
+						continue;
 					}
+					GridCell cell = this->GetGridCell(i, j, k);
+					for (size_t a = 0; a < active_layers.size(); a++) {
+						if (row_active[a]) {
+							unsigned int l = active_layers[a];
+							size_t first_vertex = buffers[l].Vertices.size() / 6;
+							this->Polygonise(cell, cube_indices[a * row_cells + i - first.x], layers[l].IsoValue, buffers[l]);
+							if (has_planes) {
+								this->ClipTriangleSoup(buffers[l], first_vertex);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void IsoSurface::GetClipCellRange(glm::ivec3& cell_min, glm::ivec3& cell_max) const {
+		// Cell (i, j, k) 涵蓋 voxel [i, i + 1]，與 clip box 有重疊的 cell 都要保留，cell_max 不包含在內。
+		glm::ivec3 cells = glm::max(glm::ivec3(this->Attributes.Resolution) - glm::ivec3(1), glm::ivec3(0));
+		cell_min = glm::ivec3(0);
+		cell_max = cells;
+		if (this->Clip.EnableBox) {
+			glm::vec3 box_min = this->Clip.BoxMin / this->Attributes.Ratio;
+			glm::vec3 box_max = this->Clip.BoxMax / this->Attributes.Ratio;
+			cell_min = glm::clamp(glm::ivec3(glm::floor(box_min)), glm::ivec3(0), cells);
+			cell_max = glm::clamp(glm::ivec3(glm::ceil(box_max)), cell_min, cells);
+		}
+	}
 
-					Polygonise(cell, iso_value);
+	bool IsoSurface::IsClipped(glm::vec3 box_min, glm::vec3 box_max) const {
+		// 只要 box 完全落在某一個 plane 的外側就被裁掉：檢查 box 在 plane 法向量方向上最遠的那個角。
+		for (const glm::vec4& plane : this->Clip.Planes) {
+			glm::vec3 normal(plane);
+			glm::vec3 corner(normal.x >= 0.0f ? box_max.x : box_min.x, normal.y >= 0.0f ? box_max.y : box_min.y, normal.z >= 0.0f ? box_max.z : box_min.z);
+			if (glm::dot(normal, corner) + plane.w < 0.0f) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void IsoSurface::ClipTriangles(std::vector<float>& vertices, std::vector<unsigned int>& indices) const {
+		if (this->Clip.Planes.empty()) {
+			return;
+		}
+		const size_t index_count = indices.size();
+		size_t kept = 0;
+		for (size_t t = 0; t < indices.size(); t += 3) {
+			glm::vec3 triangle_min(std::numeric_limits<float>::max());
+			glm::vec3 triangle_max(std::numeric_limits<float>::lowest());
+			for (size_t c = 0; c < 3; c++) {
+				const float* vertex = &vertices[static_cast<size_t>(indices[t + c]) * 6];
+				triangle_min = glm::min(triangle_min, glm::vec3(vertex[0], vertex[1], vertex[2]));
+				triangle_max = glm::max(triangle_max, glm::vec3(vertex[0], vertex[1], vertex[2]));
+			}
+			if (!this->IsClipped(triangle_min, triangle_max)) {
+				std::copy(indices.begin() + t, indices.begin() + t + 3, indices.begin() + kept);
+				kept += 3;
+			}
+		}
+		indices.resize(kept);
+		// 被丟掉的三角形所用的頂點不需要上傳，也不應該交給之後的 decimation 與 optimization。
+		if (kept != index_count) {
+			RemoveUnusedVertices(vertices, indices);
+		}
+	}
+
+	void IsoSurface::ClipTriangleSoup(PolygonBuffer& buffer, size_t first_vertex) const {
+		// 三角形湯：每三個頂點一個三角形，Vertices 每個頂點 6 個 float，Position 與 Normal 各 3 個。
+		size_t vertex_count = buffer.Vertices.size() / 6;
+		size_t kept = first_vertex;
+		for (size_t v = first_vertex; v + 3 <= vertex_count; v += 3) {
+			glm::vec3 triangle_min(std::numeric_limits<float>::max());
+			glm::vec3 triangle_max(std::numeric_limits<float>::lowest());
+			for (size_t c = 0; c < 3; c++) {
+				const float* vertex = &buffer.Vertices[(v + c) * 6];
+				triangle_min = glm::min(triangle_min, glm::vec3(vertex[0], vertex[1], vertex[2]));
+				triangle_max = glm::max(triangle_max, glm::vec3(vertex[0], vertex[1], vertex[2]));
+			}
+			if (this->IsClipped(triangle_min, triangle_max)) {
+				continue;
+			}
+			if (kept != v) {
+				std::copy(buffer.Vertices.begin() + v * 6, buffer.Vertices.begin() + (v + 3) * 6, buffer.Vertices.begin() + kept * 6);
+				std::copy(buffer.Position.begin() + v * 3, buffer.Position.begin() + (v + 3) * 3, buffer.Position.begin() + kept * 3);
+				std::copy(buffer.Normal.begin() + v * 3, buffer.Normal.begin() + (v + 3) * 3, buffer.Normal.begin() + kept * 3);
+			}
+			kept += 3;
+		}
+		buffer.Vertices.resize(kept * 6);
+		buffer.Position.resize(kept * 3);
+		buffer.Normal.resize(kept * 3);
+	}
+
+	void IsoSurface::RemoveUnusedVertices(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+		// 保留原本的頂點順序，只把沒有被任何 index 引用的頂點移掉。
+		const size_t vertex_count = vertices.size() / 6;
+		std::vector<unsigned int> remap(vertex_count, UINT32_MAX);
+		for (unsigned int index : indices) {
+			remap[index] = 0;
+		}
+		unsigned int used = 0;
+		for (size_t v = 0; v < vertex_count; v++) {
+			if (remap[v] == UINT32_MAX) {
+				continue;
+			}
+			if (used != v) {
+				std::copy(vertices.begin() + v * 6, vertices.begin() + (v + 1) * 6, vertices.begin() + static_cast<size_t>(used) * 6);
+			}
+			remap[v] = used++;
+		}
+		vertices.resize(static_cast<size_t>(used) * 6);
+		for (unsigned int& index : indices) {
+			index = remap[index];
+		}
+	}
+
+	void IsoSurface::GenerateVerticesFlyingEdges(std::vector<IsoSurfaceLayer>& layers) {
+		Logger::Message(LOG_DEBUG, "Starting generate vertices with flying edges...");
+
+		// Flying Edges 的分類與 iso value 有關，所以每一層各跑一次，但共用同一份 volume 與法向量。
+		// Clip box 直接限制 Flying Edges 走訪的範圍；clip plane 無法套進以列為單位的走訪，改成抽取後丟掉完全在外側的三角形
+		// （與 marching cubes 逐一檢查三角形的規則相同）。
+		FlyingEdges flying_edges(this->RawData, this->GridNormals, glm::ivec3(this->Attributes.Resolution), this->Attributes.Ratio);
+		glm::ivec3 cell_min, cell_max;
+		this->GetClipCellRange(cell_min, cell_max);
+		flying_edges.SetRegion(cell_min, cell_max);
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		for (IsoSurfaceLayer& layer : layers) {
+			flying_edges.Extract(layer.IsoValue, vertices, indices);
+			this->AppendIndexedLayer(layer, vertices, indices);
+		}
+
+		Logger::Message(LOG_DEBUG, "Generate vertices completed. Vertices: " + std::to_string(this->GetVertexCount()) + ", Triangles: " + std::to_string(this->GetTriangleCount()));
+	}
+
+	void IsoSurface::GenerateVerticesSurfaceNets(std::vector<IsoSurfaceLayer>& layers) {
+		Logger::Message(LOG_DEBUG, "Starting generate vertices with surface nets...");
+
+		// 與 Flying Edges 相同：每一層各跑一次，clip box 限制走訪範圍，clip plane 在抽取後處理。
+		SurfaceNets surface_nets(this->RawData, this->GridNormals, glm::ivec3(this->Attributes.Resolution), this->Attributes.Ratio);
+		glm::ivec3 cell_min, cell_max;
+		this->GetClipCellRange(cell_min, cell_max);
+		surface_nets.SetRegion(cell_min, cell_max);
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		for (IsoSurfaceLayer& layer : layers) {
+			surface_nets.Extract(layer.IsoValue, vertices, indices);
+			this->AppendIndexedLayer(layer, vertices, indices);
+		}
+
+		Logger::Message(LOG_DEBUG, "Generate vertices completed. Vertices: " + std::to_string(this->GetVertexCount()) + ", Triangles: " + std::to_string(this->GetTriangleCount()));
+	}
+
+	void IsoSurface::AppendIndexedLayer(IsoSurfaceLayer& layer, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+		this->ClipTriangles(vertices, indices);
+
+		layer.FirstVertex = this->GetVertexCount();
+		layer.VertexCount = (unsigned int)(vertices.size() / 6);
+		layer.FirstIndex = this->GetIndexCount();
+		layer.IndexCount = (unsigned int)indices.size();
+		for (unsigned int& index : indices) {
+			index += layer.FirstVertex;
+		}
+		this->Vertices.insert(this->Vertices.end(), vertices.begin(), vertices.end());
+		this->Indices.insert(this->Indices.end(), indices.begin(), indices.end());
+	}
+
+	void IsoSurface::TransformLayers(std::vector<IsoSurfaceLayer>& layers, const std::function<void(std::vector<float>&, std::vector<unsigned int>&)>& transform) {
+		// 每一層分開處理，結果依序放回共用的 buffer，圖層之間不會互相合併。
+		const bool is_indexed = !this->Indices.empty();
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		for (IsoSurfaceLayer& layer : layers) {
+			std::vector<float> layer_vertices(this->Vertices.begin() + static_cast<size_t>(layer.FirstVertex) * 6, this->Vertices.begin() + static_cast<size_t>(layer.FirstVertex + layer.VertexCount) * 6);
+			std::vector<unsigned int> layer_indices;
+			if (is_indexed) {
+				layer_indices.assign(this->Indices.begin() + layer.FirstIndex, this->Indices.begin() + layer.FirstIndex + layer.IndexCount);
+				for (unsigned int& index : layer_indices) {
+					index -= layer.FirstVertex;
 				}
 			}
+			transform(layer_vertices, layer_indices);
+
+			layer.FirstVertex = (unsigned int)(vertices.size() / 6);
+			layer.VertexCount = (unsigned int)(layer_vertices.size() / 6);
+			layer.FirstIndex = (unsigned int)indices.size();
+			layer.IndexCount = (unsigned int)layer_indices.size();
+			for (unsigned int index : layer_indices) {
+				indices.push_back(index + layer.FirstVertex);
+			}
+			vertices.insert(vertices.end(), layer_vertices.begin(), layer_vertices.end());
 		}
-		Logger::Message(LOG_DEBUG, "Generate vertices completed.");
+		this->Vertices.swap(vertices);
+		this->Indices.swap(indices);
+	}
+
+	void IsoSurface::FilterComponents(std::vector<IsoSurfaceLayer>& layers) {
+		// 三角形湯仍然是三角形湯。
+		ComponentFilter filter(this->ComponentFiltering);
+		this->TransformLayers(layers, [this, &filter](std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+			filter.Filter(vertices, indices);
+			this->RemovedComponentCount += filter.GetComponentCount() - filter.GetKeptComponentCount();
+		});
+	}
+
+	void IsoSurface::DecimateLayers(std::vector<IsoSurfaceLayer>& layers) {
+		MeshDecimator decimator(this->Decimation);
+		this->TransformLayers(layers, [&decimator](std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+			decimator.Decimate(vertices, indices);
+		});
 	}
 
-	void IsoSurface::Polygonise(GridCell cell, float iso_value) {
+	void IsoSurface::OptimizeLayers(std::vector<IsoSurfaceLayer>& layers) {
+		// Marching cubes 的三角形湯先焊接成 indexed mesh，每個頂點大約只剩原本的 1/6，之後才有 cache 可以利用。
+		MeshOptimizer optimizer;
+		double acmr_before = 0.0, acmr_after = 0.0;
+		unsigned int triangle_count = 0;
+		this->TransformLayers(layers, [&](std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+			if (indices.empty()) {
+				MeshDecimator::Weld(vertices, indices);
+			}
+			optimizer.Optimize(vertices, 6, indices);
+			unsigned int layer_triangles = (unsigned int)(indices.size() / 3);
+			acmr_before += (double)optimizer.GetACMRBefore() * layer_triangles;
+			acmr_after += (double)optimizer.GetACMRAfter() * layer_triangles;
+			triangle_count += layer_triangles;
+		});
+		this->ACMRBefore = triangle_count > 0 ? (float)(acmr_before / triangle_count) : 0.0f;
+		this->ACMRAfter = triangle_count > 0 ? (float)(acmr_after / triangle_count) : 0.0f;
+		Logger::Message(LOG_DEBUG, "Mesh optimization completed. ACMR: " + std::to_string(this->ACMRBefore) + " -> " + std::to_string(this->ACMRAfter));
+	}
+
+	GridCell IsoSurface::GetGridCell(int x, int y, int z) const {
+		std::vector<glm::vec3> VertexOrder = {
+			glm::vec3(x, y, z),
+			glm::vec3(x + 1, y, z),
+			glm::vec3(x + 1, y, z + 1),
+			glm::vec3(x, y, z + 1),
+			glm::vec3(x, y + 1, z),
+			glm::vec3(x + 1, y + 1, z),
+			glm::vec3(x + 1, y + 1, z + 1),
+			glm::vec3(x, y + 1, z + 1),
+		};
+
+		auto cell = GridCell();
+		for (int vertex_index = 0; vertex_index < VertexOrder.size(); vertex_index++) {
+			auto voxel = Voxel();
+			voxel.Position = VertexOrder[vertex_index];
+			voxel.Normal = this->GetNormalFromGrid(VertexOrder[vertex_index]);
+			voxel.Value = this->GetIsoValueFromGrid(VertexOrder[vertex_index]);
+			cell.vertices.push_back(voxel);
+		}
+		return cell;
+	}
+
+	void IsoSurface::Polygonise(GridCell cell, float iso_value, PolygonBuffer& buffer) const {
 
 		int cube_index = 0;
-		glm::vec3 position_list[12];
-		glm::vec3 normal_list[12];
 
 		// 先檢查每個方塊上的 Voxel 覆蓋為何，一共有 8 個頂點（使用一個 byte 來代表），如果該 iso value 比較大，就會將該 bits 變成 1。
 		for (unsigned int vertex_index = 0; vertex_index < cell.vertices.size(); vertex_index++) {
@@ -620,8 +1728,16 @@ namespace Nexus {
 			}
 		}
 
+		this->Polygonise(cell, cube_index, iso_value, buffer);
+	}
+
+	void IsoSurface::Polygonise(const GridCell& cell, int cube_index, float iso_value, PolygonBuffer& buffer) const {
+
+		glm::vec3 position_list[12];
+		glm::vec3 normal_list[12];
+
 		// 如果都沒有 Voxel 被覆蓋，代表此 Cell 是沒有相交的（可能在圖形 外面 或 裡面）
-		if (this->EdgeTable[cube_index] == 0) {
+		if (MarchingCubesEdgeTable[cube_index] == 0) {
 			return;
 		}
 
@@ -643,22 +1759,27 @@ namespace Nexus {
 
 		// 開始一個一個邊去找有沒有相交，如果有就進行插值計算 相交點的座標以及法向量
 		for (unsigned int edge_index = 0; edge_index < EdgeOrder.size(); edge_index++) {
-			if (this->EdgeTable[cube_index] & (1 << edge_index)) {
+			if (MarchingCubesEdgeTable[cube_index] & (1 << edge_index)) {
 				position_list[edge_index] = this->Interpolation(iso_value, cell.vertices[EdgeOrder[edge_index][0]], cell.vertices[EdgeOrder[edge_index][1]], INTERPOLATE_POSITION);
 				normal_list[edge_index] = this->Interpolation(iso_value, cell.vertices[EdgeOrder[edge_index][0]], cell.vertices[EdgeOrder[edge_index][1]], INTERPOLATE_NORMAL);
 			}
 		}
 
 		// 利用 Lookup table 查表出對應的三角形座標
-		for (unsigned int i = 0; this->TriangleTable[cube_index][i] != -1; i += 3) {
+		for (unsigned int i = 0; MarchingCubesTriangleTable[cube_index][i] != -1; i += 3) {
 			for (unsigned int offset = 0; offset < 3; offset++) {
-				this->AddPosition(position_list[this->TriangleTable[cube_index][i + offset]] * this->Attributes.Ratio);
-				this->AddNormal(glm::normalize(normal_list[this->TriangleTable[cube_index][i + offset]]));
+				buffer.AddPosition(position_list[MarchingCubesTriangleTable[cube_index][i + offset]] * this->Attributes.Ratio);
+				buffer.AddNormal(glm::normalize(normal_list[MarchingCubesTriangleTable[cube_index][i + offset]]));
 			}
 		}
 	}
 
-	glm::vec3 IsoSurface::Interpolation(float iso_value, Voxel voxel_a, Voxel voxel_b, InterpolateMode mode) {
+	glm::vec3 IsoSurface::Interpolation(float iso_value, Voxel voxel_a, Voxel voxel_b, InterpolateMode mode) const {
+
+		// 相鄰的 cell 會以相反的方向走過同一條邊，固定由座標較小的端點開始內插，兩邊算出來的頂點才會完全一致（焊接時需要）。
+		if (voxel_b.Position.x + voxel_b.Position.y + voxel_b.Position.z < voxel_a.Position.x + voxel_a.Position.y + voxel_a.Position.z) {
+			std::swap(voxel_a, voxel_b);
+		}
 
 		glm::vec3 p1, p2;
 		if (mode == INTERPOLATE_POSITION) {
@@ -676,15 +1797,15 @@ namespace Nexus {
 		float proportion;
 		glm::vec3 result;
 
-		if (abs(iso_value - val1) < 0.00001) {
+		if (std::abs(iso_value - val1) < 0.00001) {
 			return p1;
 		}
 
-		if (abs(iso_value - val2) < 0.00001) {
+		if (std::abs(iso_value - val2) < 0.00001) {
 			return p2;
 		}
 
-		if (abs(val1 - val2) < 0.00001) {
+		if (std::abs(val1 - val2) < 0.00001) {
 			return p1;
 		}
 
@@ -701,19 +1822,465 @@ namespace Nexus {
 		this->VAO = std::make_unique<Nexus::VertexArray>(this->VBO.get(), Attribs, 2, (GLsizei)sizeof(float));
 		*/
 		
-		glGenVertexArrays(1, &VAO);
-		glGenBuffers(1, &VBO);
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, this->Vertices.size() * sizeof(float), this->Vertices.data(), GL_STATIC_DRAW);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-		glBindVertexArray(0);
+		this->VertexCount = (unsigned int)(this->Vertices.size() / 6);
+		this->IndexCount = (unsigned int)this->Indices.size();
+		this->QuantizationExtent = glm::max((this->Attributes.Resolution - glm::vec3(1.0f)) * this->Attributes.Ratio, glm::vec3(0.000001f));
+
+		this->IsProgressiveBuffer = false;
+		this->ProgressiveIndexed = false;
+
+		// 上傳到目前沒有在畫的那一組 buffer，容量足夠時只更新內容，不會重新配置；上傳完才交換成前景。
+		SurfaceBuffer& surface = this->GetBackSurfaceBuffer();
+		std::vector<PackedVertex> packed;
+		const void* vertex_data = this->Vertices.data();
+		size_t vertex_bytes = this->Vertices.size() * sizeof(float);
+		if (this->EnableCompressedVertices) {
+			this->PackVertices(this->Vertices, packed);
+			vertex_data = packed.data();
+			vertex_bytes = packed.size() * sizeof(PackedVertex);
+		}
+		this->VertexBufferSize = (unsigned int)vertex_bytes;
+		surface.IsCompressed = this->EnableCompressedVertices;
+		this->ReserveBuffer(surface, surface.VBO, surface.VertexCapacity, 0, vertex_bytes);
+		this->UploadBufferData(surface.VBO, 0, vertex_bytes, vertex_data);
+		if (!this->Indices.empty()) {
+			size_t index_bytes = this->Indices.size() * sizeof(unsigned int);
+			this->ReserveBuffer(surface, surface.EBO, surface.IndexCapacity, 0, index_bytes);
+			this->UploadBufferData(surface.EBO, 0, index_bytes, this->Indices.data());
+		}
+		this->BindSurfaceBuffer(surface);
+		this->FrontSurfaceBuffer ^= 1;
+
+		// 不保留 CPU 端的資料時直接釋放，之後只依靠 VertexCount 與 IndexCount 繪製。
+		if (!this->EnableHostCopies) {
+			std::vector<float>().swap(this->Vertices);
+			std::vector<float>().swap(this->Position);
+			std::vector<float>().swap(this->Normal);
+			std::vector<unsigned int>().swap(this->Indices);
+		}
+	}
+
+	void IsoSurface::PackVertices(const std::vector<float>& vertices, std::vector<PackedVertex>& packed) const {
+		// 位置相對於整個 volume 的範圍做 16-bit 量化，精度為 volume 邊長的 1 / 65535。
+		unsigned int vertex_count = (unsigned int)(vertices.size() / 6);
+		packed.resize(vertex_count);
+
+		// glm::clamp 不會處理 NaN，轉成整數之前先把非有限的分量（例如長度為 0 的 gradient 正規化的結果）換成 0。
+		auto pack_snorm10 = [](float value) -> uint32_t {
+			value = std::isfinite(value) ? value : 0.0f;
+			int quantized = (int)std::round(glm::clamp(value, -1.0f, 1.0f) * 511.0f);
+			return static_cast<uint32_t>(quantized) & 0x3FFu;
+		};
+
+		glm::vec3 extent = this->QuantizationExtent;
+		ThreadPool::GetInstance().ParallelFor(0, vertex_count, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				const float* vertex = &vertices[static_cast<size_t>(i) * 6];
+				PackedVertex& result = packed[i];
+				for (int axis = 0; axis < 3; axis++) {
+					float ratio = vertex[axis] / extent[axis];
+					ratio = std::isfinite(ratio) ? glm::clamp(ratio, 0.0f, 1.0f) : 0.0f;
+					result.Position[axis] = static_cast<uint16_t>(std::round(ratio * 65535.0f));
+				}
+				result.Padding = 0;
+				result.Normal = pack_snorm10(vertex[3]) | (pack_snorm10(vertex[4]) << 10) | (pack_snorm10(vertex[5]) << 20);
+			}
+		}, 4096);
 	}
 	
-	void IsoSurface::AddPosition(float x, float y, float z) {
+	void IsoSurface::BindVertexAttributes(bool is_compressed) const {
+		if (is_compressed) {
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Position));
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, Normal));
+		} else {
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+		}
+	}
+
+	SurfaceBuffer& IsoSurface::GetBackSurfaceBuffer() {
+		SurfaceBuffer& surface = this->SurfaceBuffers[this->FrontSurfaceBuffer ^ 1];
+		if (surface.VAO == 0) {
+			glGenVertexArrays(1, &surface.VAO);
+			glGenBuffers(1, &surface.VBO);
+			glGenBuffers(1, &surface.EBO);
+		}
+		return surface;
+	}
+
+	void IsoSurface::BindSurfaceBuffer(const SurfaceBuffer& surface) const {
+		// 頂點格式（壓縮與否）可能在兩次抽取之間改變，每次都重新設定 VAO。
+		glBindVertexArray(surface.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, surface.VBO);
+		this->BindVertexAttributes(surface.IsCompressed);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, surface.EBO);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void IsoSurface::ReserveBuffer(const SurfaceBuffer& surface, GLuint& buffer, size_t& capacity, size_t used_bytes, size_t required_bytes) {
+		if (required_bytes <= capacity) {
+			return;
+		}
+		// 容量以倍數成長，反覆抽取或逐步附加時只會重新配置 O(log n) 次。
+		// 使用 GL_COPY_READ/WRITE_BUFFER 這兩個 target，不會動到 VAO 綁定的 element buffer。
+		size_t new_capacity = std::max(required_bytes, capacity * 2);
+		if (used_bytes == 0) {
+			// 沒有需要保留的內容，直接在同一個 buffer 上重新配置，VAO 不需要改變。
+			glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+			glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)new_capacity, nullptr, GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			capacity = new_capacity;
+			return;
+		}
+
+		// 舊的內容直接在 GPU 上複製到新的 buffer，不經過 CPU。
+		GLuint grown = 0;
+		glGenBuffers(1, &grown);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)new_capacity, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)used_bytes);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glDeleteBuffers(1, &buffer);
+		buffer = grown;
+		capacity = new_capacity;
+
+		// 換了 buffer 之後 VAO 要重新指向新的 buffer。
+		this->BindSurfaceBuffer(surface);
+	}
+
+	void IsoSurface::UploadBufferData(GLuint buffer, size_t offset, size_t bytes, const void* data) const {
+		if (bytes == 0) {
+			return;
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)bytes, data);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	}
+
+	void IsoSurface::ReleaseGraphicsResources() {
+		// 只刪除真的建立過的物件，只在 CPU 上抽取（沒有 OpenGL context）時不會呼叫任何 OpenGL 函式。
+		for (SurfaceBuffer& surface : this->SurfaceBuffers) {
+			if (surface.VAO != 0) {
+				glDeleteVertexArrays(1, &surface.VAO);
+				glDeleteBuffers(1, &surface.VBO);
+				glDeleteBuffers(1, &surface.EBO);
+			}
+			surface = SurfaceBuffer();
+		}
+		if (this->BoundingBoxVAO != 0) {
+			glDeleteVertexArrays(1, &this->BoundingBoxVAO);
+			glDeleteBuffers(1, &this->BoundingBoxVBO);
+			glDeleteBuffers(1, &this->BoundingBoxEBO);
+			this->BoundingBoxVAO = 0;
+			this->BoundingBoxVBO = 0;
+			this->BoundingBoxEBO = 0;
+		}
+		if (this->VolumeTexture != 0) {
+			glDeleteTextures(1, &this->VolumeTexture);
+			this->VolumeTexture = 0;
+			this->VolumeTextureSize = glm::ivec3(0);
+		}
+		this->ReleaseGradientTexture();
+		this->DerivedData.Invalidate(DERIVED_DATA_VOLUME_TEXTURE);
+		if (this->OccupancyTexture != 0) {
+			glDeleteTextures(1, &this->OccupancyTexture);
+			this->OccupancyTexture = 0;
+			this->OccupancyTextureSize = glm::ivec3(0);
+		}
+		if (this->PreIntegrationTexture != 0) {
+			glDeleteTextures(1, &this->PreIntegrationTexture);
+			this->PreIntegrationTexture = 0;
+			this->PreIntegrationTextureSize = 0;
+		}
+		if (this->TransferFunction2DTexture != 0) {
+			glDeleteTextures(1, &this->TransferFunction2DTexture);
+			this->TransferFunction2DTexture = 0;
+			this->TransferFunction2DTextureSize = 0;
+		}
+		if (this->ProjectionBrickTexture != 0) {
+			glDeleteTextures(1, &this->ProjectionBrickTexture);
+			this->ProjectionBrickTexture = 0;
+			this->ProjectionBrickTextureSize = glm::ivec3(0);
+		}
+		this->DerivedData.Invalidate(DERIVED_DATA_BRICK_RANGE_TEXTURE);
+		for (int axis = SLICE_AXIS_X; axis <= SLICE_AXIS_Z; axis++) {
+			this->SliceTextures[axis].reset();
+			this->SliceIndices[axis] = -1;
+		}
+		this->ProgressiveRendering.Release();
+		this->VolumeStreamer.Release();
+	}
+
+	void IsoSurface::StartProgressiveExtraction() {
+		// 背景工作會讀取 GridNormals 與 octree，開始之前要先是最新的。
+		this->DerivedData.Require({ DERIVED_DATA_GRADIENTS, DERIVED_DATA_SPATIAL_INDEX });
+
+		// 上一次的大小拿來估計初始容量，大部分情況下調整 iso value 之後不需要再成長。
+		size_t initial_vertex_bytes = std::max<size_t>(this->VertexBufferSize, 1 << 20);
+		size_t initial_index_bytes = std::max<size_t>(static_cast<size_t>(this->IndexCount) * sizeof(unsigned int), 1 << 20);
+
+		this->ExtractedTriangleCount = 0;
+		this->DecimationSeconds = std::chrono::duration<double>(0.0);
+		this->ExtractionSeconds = std::chrono::duration<double>(0.0);
+		this->QuantizationExtent = glm::max((this->Attributes.Resolution - glm::vec3(1.0f)) * this->Attributes.Ratio, glm::vec3(0.000001f));
+
+		const int method = this->CurrentExtractionMethod;
+		const bool is_indexed = method != EXTRACTION_METHOD_MARCHING_CUBES;
+		const float iso_value = this->IsoValue;
+		glm::ivec3 cell_min, cell_max;
+		this->GetClipCellRange(cell_min, cell_max);
+		if (is_indexed) {
+			this->ActiveBricks.clear();
+		} else {
+			std::vector<IsoSurfaceLayer> layers(1);
+			layers[0].IsoValue = iso_value;
+			this->CollectActiveBricks(layers, cell_min, cell_max);
+		}
+
+		// 使用沒有在畫的那一組 buffer，容量至少是估計值，不夠時在上傳時成長。前一個表面在新的表面全部上傳完之前
+		// 都還留在前景；前景本來就是空的時直接交換，畫面上顯示的就是逐漸長出來的新表面。
+		SurfaceBuffer& surface = this->GetBackSurfaceBuffer();
+		surface.IsCompressed = this->EnableCompressedVertices;
+		this->ReserveBuffer(surface, surface.VBO, surface.VertexCapacity, 0, initial_vertex_bytes);
+		if (is_indexed) {
+			this->ReserveBuffer(surface, surface.EBO, surface.IndexCapacity, 0, initial_index_bytes);
+		}
+		this->BindSurfaceBuffer(surface);
+		this->ProgressiveSurface = this->FrontSurfaceBuffer ^ 1;
+		this->ProgressiveSurfaceIndexed = is_indexed;
+		this->ProgressiveVertexCount = 0;
+		this->ProgressiveIndexCount = 0;
+		this->ProgressiveVertices.clear();
+		this->ProgressiveIndices.clear();
+		if (this->VertexCount == 0) {
+			this->Vertices.clear();
+			this->Position.clear();
+			this->Normal.clear();
+			this->Indices.clear();
+			this->IndexCount = 0;
+			this->VertexBufferSize = 0;
+			this->FrontSurfaceBuffer = this->ProgressiveSurface;
+			this->IsProgressiveBuffer = true;
+			this->ProgressiveIndexed = is_indexed;
+		}
+
+		// Slab 是沿 z 軸一層 brick 的厚度，與 octree 的 brick 對齊，marching cubes 可以直接依 brick 分組。
+		const int slab_size = this->BrickSize;
+		const int first_z = (cell_min.z / slab_size) * slab_size;
+		this->ProgressiveSlabCount = cell_max.z > cell_min.z ? (unsigned int)((cell_max.z - first_z + slab_size - 1) / slab_size) : 0u;
+		this->ProgressiveSlabsExtracted = 0;
+		this->ProgressiveCancel = false;
+		this->ProgressiveFinished = false;
+		this->HasProgressiveCurrent = false;
+		this->ProgressiveStart = std::chrono::system_clock::now();
+		this->ProgressiveActive = true;
+
+		const unsigned int slab_count = this->ProgressiveSlabCount;
+		const bool is_compressed = surface.IsCompressed;
+		this->ProgressiveTask = ThreadPool::GetInstance().Enqueue([this, iso_value, cell_min, cell_max, method, slab_size, first_z, slab_count, is_compressed]() {
+			if (slab_count == 0) {
+				this->ProgressiveFinished = true;
+				return;
+			}
+			std::vector<std::vector<unsigned int>> slab_bricks(slab_count);
+			for (unsigned int id : this->ActiveBricks) {
+				unsigned int slab = (unsigned int)((this->Octree.GetBrick(id).Origin.z - first_z) / slab_size);
+				slab_bricks[std::min(slab, slab_count - 1)].push_back(id);
+			}
+
+			unsigned int base_vertex = 0;
+			for (unsigned int s = 0; s < slab_count && !this->ProgressiveCancel; s++) {
+				glm::ivec3 slab_min = cell_min;
+				glm::ivec3 slab_max = cell_max;
+				slab_min.z = std::max(cell_min.z, first_z + (int)s * slab_size);
+				slab_max.z = std::min(cell_max.z, first_z + (int)(s + 1) * slab_size);
+
+				ProgressiveSlab slab;
+				slab.IsCompressed = is_compressed;
+				this->ExtractSlab(iso_value, slab_min, slab_max, method, s == 0, slab_bricks[s], slab);
+				for (unsigned int& index : slab.Indices) {
+					index += base_vertex;
+				}
+				base_vertex += (unsigned int)(slab.Vertices.size() / 6);
+				if (!slab.Vertices.empty()) {
+					std::lock_guard<std::mutex> lock(this->ProgressiveMutex);
+					this->ProgressiveQueue.push_back(std::move(slab));
+				}
+				this->ProgressiveSlabsExtracted++;
+			}
+			this->ProgressiveFinished = true;
+		});
+	}
+
+	void IsoSurface::StopProgressiveExtraction() {
+		if (this->ProgressiveTask.valid()) {
+			this->ProgressiveCancel = true;
+			this->ProgressiveTask.get();
+		}
+		this->ProgressiveActive = false;
+		this->ProgressiveCancel = false;
+		this->HasProgressiveCurrent = false;
+		this->ProgressiveCurrent = ProgressiveSlab();
+		std::lock_guard<std::mutex> lock(this->ProgressiveMutex);
+		this->ProgressiveQueue.clear();
+	}
+
+	void IsoSurface::ExtractSlab(float iso_value, glm::ivec3 cell_min, glm::ivec3 cell_max, int method, bool is_first_slab, const std::vector<unsigned int>& bricks, ProgressiveSlab& slab) const {
+		// 在背景執行緒上執行，不會呼叫任何 OpenGL 函式。
+		if (method == EXTRACTION_METHOD_FLYING_EDGES) {
+			FlyingEdges flying_edges(this->RawData, this->GridNormals, glm::ivec3(this->Attributes.Resolution), this->Attributes.Ratio);
+			flying_edges.SetRegion(cell_min, cell_max);
+			flying_edges.Extract(iso_value, slab.Vertices, slab.Indices);
+			this->ClipTriangles(slab.Vertices, slab.Indices);
+		} else if (method == EXTRACTION_METHOD_SURFACE_NETS) {
+			// Surface nets 的四邊形跨越相鄰的 cell，slab 往前多取一層 cell（與上一個 slab 重疊），重疊那層的 z 方向的邊不再重複輸出。
+			SurfaceNets surface_nets(this->RawData, this->GridNormals, glm::ivec3(this->Attributes.Resolution), this->Attributes.Ratio);
+			glm::ivec3 region_min = cell_min;
+			if (!is_first_slab) {
+				region_min.z--;
+			}
+			surface_nets.SetSharedFirstSlice(!is_first_slab);
+			surface_nets.SetRegion(region_min, cell_max);
+			surface_nets.Extract(iso_value, slab.Vertices, slab.Indices);
+			this->ClipTriangles(slab.Vertices, slab.Indices);
+			// 重疊那層 cell 的頂點只有被這個 slab 的四邊形引用的才需要，其餘的已經在上一個 slab 中，不再重複上傳。
+			if (!is_first_slab) {
+				RemoveUnusedVertices(slab.Vertices, slab.Indices);
+			}
+		} else if (!bricks.empty()) {
+			std::vector<IsoSurfaceLayer> layers(1);
+			layers[0].IsoValue = iso_value;
+			std::vector<std::vector<PolygonBuffer>> buffers;
+			this->PolygoniseBricks(bricks, layers, cell_min, cell_max, buffers);
+			size_t total = 0;
+			for (const std::vector<PolygonBuffer>& chunk : buffers) {
+				total += chunk[0].Vertices.size();
+			}
+			slab.Vertices.reserve(total);
+			for (const std::vector<PolygonBuffer>& chunk : buffers) {
+				slab.Vertices.insert(slab.Vertices.end(), chunk[0].Vertices.begin(), chunk[0].Vertices.end());
+			}
+		}
+		if (slab.IsCompressed) {
+			this->PackVertices(slab.Vertices, slab.Packed);
+		}
+	}
+
+	void IsoSurface::UploadProgressiveSlabs() {
+		if (!this->ProgressiveActive) {
+			return;
+		}
+
+		// 先上傳頂點再上傳 index，畫出來的三角形永遠只引用已經在 GPU 上的頂點。
+		SurfaceBuffer& surface = this->SurfaceBuffers[this->ProgressiveSurface];
+		const bool is_front = this->ProgressiveSurface == this->FrontSurfaceBuffer;
+		const size_t vertex_stride = surface.IsCompressed ? sizeof(PackedVertex) : 6 * sizeof(float);
+		size_t budget = this->ProgressiveUploadBudget;
+		while (budget > 0) {
+			if (!this->HasProgressiveCurrent) {
+				std::lock_guard<std::mutex> lock(this->ProgressiveMutex);
+				if (this->ProgressiveQueue.empty()) {
+					break;
+				}
+				this->ProgressiveCurrent = std::move(this->ProgressiveQueue.front());
+				this->ProgressiveQueue.pop_front();
+				this->ProgressiveVertexCursor = 0;
+				this->ProgressiveIndexCursor = 0;
+				this->HasProgressiveCurrent = true;
+			}
+
+			ProgressiveSlab& slab = this->ProgressiveCurrent;
+			if (slab.IsCompressed != surface.IsCompressed) {
+				// 不同格式的 slab 不能接在這個 buffer 後面（正常情況下改變格式時已經停止抽取）。
+				this->ProgressiveCurrent = ProgressiveSlab();
+				this->HasProgressiveCurrent = false;
+				continue;
+			}
+			size_t slab_vertices = slab.Vertices.size() / 6;
+			if (this->ProgressiveVertexCursor < slab_vertices) {
+				// 沒有 index 的三角形湯以三個頂點為單位上傳，每個 frame 畫出來的都是完整的三角形。
+				size_t count = std::min(slab_vertices - this->ProgressiveVertexCursor, std::max<size_t>(budget / vertex_stride, 3));
+				if (!this->ProgressiveSurfaceIndexed) {
+					count -= count % 3;
+				}
+				size_t offset = static_cast<size_t>(this->ProgressiveVertexCount) * vertex_stride;
+				this->ReserveBuffer(surface, surface.VBO, surface.VertexCapacity, offset, offset + count * vertex_stride);
+				const void* data = slab.IsCompressed ? (const void*)(slab.Packed.data() + this->ProgressiveVertexCursor) : (const void*)(slab.Vertices.data() + this->ProgressiveVertexCursor * 6);
+				this->UploadBufferData(surface.VBO, offset, count * vertex_stride, data);
+				this->ProgressiveVertexCount += (unsigned int)count;
+				this->ProgressiveVertexCursor += count;
+				budget -= std::min(budget, count * vertex_stride);
+				continue;
+			}
+			if (this->ProgressiveIndexCursor < slab.Indices.size()) {
+				size_t count = std::min(slab.Indices.size() - this->ProgressiveIndexCursor, std::max<size_t>(budget / sizeof(unsigned int), 3));
+				count -= count % 3;
+				size_t offset = static_cast<size_t>(this->ProgressiveIndexCount) * sizeof(unsigned int);
+				this->ReserveBuffer(surface, surface.EBO, surface.IndexCapacity, offset, offset + count * sizeof(unsigned int));
+				this->UploadBufferData(surface.EBO, offset, count * sizeof(unsigned int), slab.Indices.data() + this->ProgressiveIndexCursor);
+				this->ProgressiveIndexCount += (unsigned int)count;
+				this->ProgressiveIndexCursor += count;
+				budget -= std::min(budget, count * sizeof(unsigned int));
+				continue;
+			}
+
+			// 整個 slab 都上傳完了，需要時保留 CPU 端的資料（可以輸出成檔案）。
+			if (this->EnableHostCopies) {
+				std::vector<float>& host_vertices = is_front ? this->Vertices : this->ProgressiveVertices;
+				std::vector<unsigned int>& host_indices = is_front ? this->Indices : this->ProgressiveIndices;
+				host_vertices.insert(host_vertices.end(), slab.Vertices.begin(), slab.Vertices.end());
+				host_indices.insert(host_indices.end(), slab.Indices.begin(), slab.Indices.end());
+			}
+			this->ProgressiveCurrent = ProgressiveSlab();
+			this->HasProgressiveCurrent = false;
+		}
+		if (is_front) {
+			this->VertexCount = this->ProgressiveVertexCount;
+			this->IndexCount = this->ProgressiveIndexCount;
+			this->VertexBufferSize = (unsigned int)(static_cast<size_t>(this->VertexCount) * vertex_stride);
+		}
+
+		if (!this->ProgressiveFinished || this->HasProgressiveCurrent) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(this->ProgressiveMutex);
+			if (!this->ProgressiveQueue.empty()) {
+				return;
+			}
+		}
+		this->ProgressiveTask.get();
+		this->ProgressiveActive = false;
+
+		// 新的表面全部在 GPU 上了，這時才取代前一個表面。
+		if (!is_front) {
+			this->FrontSurfaceBuffer = this->ProgressiveSurface;
+			this->IsProgressiveBuffer = true;
+			this->ProgressiveIndexed = this->ProgressiveSurfaceIndexed;
+			this->VertexCount = this->ProgressiveVertexCount;
+			this->IndexCount = this->ProgressiveIndexCount;
+			this->VertexBufferSize = (unsigned int)(static_cast<size_t>(this->VertexCount) * vertex_stride);
+			this->Vertices.swap(this->ProgressiveVertices);
+			this->Indices.swap(this->ProgressiveIndices);
+			this->Position.clear();
+			this->Normal.clear();
+			std::vector<float>().swap(this->ProgressiveVertices);
+			std::vector<unsigned int>().swap(this->ProgressiveIndices);
+		}
+		this->ExtractionSeconds = std::chrono::system_clock::now() - this->ProgressiveStart;
+		this->ElapsedSeconds = this->ExtractionSeconds;
+		this->ExtractedTriangleCount = this->GetTriangleCount();
+		Logger::Message(LOG_INFO, "Progressive extraction completed: " + std::to_string(this->ExtractedTriangleCount) + " triangles in " + std::to_string(this->ExtractionSeconds.count()) + " seconds.");
+	}
+
+	void PolygonBuffer::AddPosition(float x, float y, float z) {
 		this->Position.push_back(x);
 		this->Position.push_back(y);
 		this->Position.push_back(z);
@@ -723,7 +2290,7 @@ namespace Nexus {
 		this->Vertices.push_back(z);
 	}
 
-	void IsoSurface::AddPosition(glm::vec3 position) {
+	void PolygonBuffer::AddPosition(glm::vec3 position) {
 		this->Position.push_back(position.x);
 		this->Position.push_back(position.y);
 		this->Position.push_back(position.z);
@@ -733,7 +2300,7 @@ namespace Nexus {
 		this->Vertices.push_back(position.z);
 	}
 
-	void IsoSurface::AddNormal(float nx, float ny, float nz) {
+	void PolygonBuffer::AddNormal(float nx, float ny, float nz) {
 		this->Normal.push_back(nx);
 		this->Normal.push_back(ny);
 		this->Normal.push_back(nz);
@@ -743,7 +2310,7 @@ namespace Nexus {
 		this->Vertices.push_back(nz);
 	}
 	
-	void IsoSurface::AddNormal(glm::vec3 normal) {
+	void PolygonBuffer::AddNormal(glm::vec3 normal) {
 		this->Normal.push_back(normal.x);
 		this->Normal.push_back(normal.y);
 		this->Normal.push_back(normal.z);
@@ -752,4 +2319,10 @@ namespace Nexus {
 		this->Vertices.push_back(normal.y);
 		this->Vertices.push_back(normal.z);
 	}
+
+	void PolygonBuffer::Append(const PolygonBuffer& other) {
+		this->Vertices.insert(this->Vertices.end(), other.Vertices.begin(), other.Vertices.end());
+		this->Position.insert(this->Position.end(), other.Position.begin(), other.Position.end());
+		this->Normal.insert(this->Normal.end(), other.Normal.begin(), other.Normal.end());
+	}
 }
@@ -0,0 +1,619 @@
+#include "MeshDecimator.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace Nexus {
+
+	namespace {
+		struct WeldKey {
+			uint32_t X, Y, Z;
+			bool operator==(const WeldKey& other) const { return X == other.X && Y == other.Y && Z == other.Z; }
+		};
+
+		struct WeldKeyHash {
+			size_t operator()(const WeldKey& key) const {
+				uint64_t h = key.X * 0x9E3779B1ull;
+				h ^= (key.Y + 0x7F4A7C15ull + (h << 6) + (h >> 2)) * 0x85EBCA77ull;
+				h ^= (key.Z + 0x165667B1ull + (h << 6) + (h >> 2)) * 0xC2B2AE3Dull;
+				return static_cast<size_t>(h ^ (h >> 29));
+			}
+		};
+
+		WeldKey GetWeldKey(const float* vertex) {
+			// 加上 0.0f 讓 -0.0 與 0.0 變成同一個 key。
+			WeldKey key;
+			float x = vertex[0] + 0.0f, y = vertex[1] + 0.0f, z = vertex[2] + 0.0f;
+			std::memcpy(&key.X, &x, sizeof(float));
+			std::memcpy(&key.Y, &y, sizeof(float));
+			std::memcpy(&key.Z, &z, sizeof(float));
+			return key;
+		}
+	}
+
+	void MeshDecimator::Decimate(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+		if (indices.empty()) {
+			this->InputTriangleCount = (unsigned int)(vertices.size() / 18);
+			MeshDecimator::Weld(vertices, indices);
+		} else {
+			this->InputTriangleCount = (unsigned int)(indices.size() / 3);
+		}
+		this->OutputTriangleCount = (unsigned int)(indices.size() / 3);
+
+		if (this->Settings.TargetRatio <= 0.0f && this->Settings.MaxError <= 0.0f) {
+			Logger::Message(LOG_WARNING, "Mesh decimation needs a target ratio or an error bound, the mesh is left untouched.");
+			return;
+		}
+
+		// 第一次以原本的格子切割，第二次把格子平移半個 cluster，讓第一次被鎖住的接縫也能被簡化。
+		double target = this->Settings.TargetRatio > 0.0f ? (double)this->InputTriangleCount * this->Settings.TargetRatio : 0.0;
+		this->RunClusterPass(vertices, indices, 0.0f, this->Settings.TargetRatio > 0.0f ? this->Settings.TargetRatio : 0.0);
+
+		double current = (double)(indices.size() / 3);
+		if (current > target) {
+			this->RunClusterPass(vertices, indices, this->Settings.ClusterSize * 0.5f, target > 0.0 ? target / current : 0.0);
+		}
+
+		this->Compact(vertices, indices);
+		this->OutputTriangleCount = (unsigned int)(indices.size() / 3);
+
+		Logger::Message(LOG_DEBUG, "Mesh decimation completed. Triangles: " + std::to_string(this->InputTriangleCount) + " -> " + std::to_string(this->OutputTriangleCount));
+	}
+
+	void MeshDecimator::FindDuplicateVertices(const std::vector<float>& vertices, std::vector<unsigned int>& representative) {
+		size_t vertex_count = vertices.size() / 6;
+		representative.resize(vertex_count);
+		ThreadPool& pool = ThreadPool::GetInstance();
+
+		// 依照 hash 把頂點分到數個互不重疊的分區，每個分區各自用一張 hash table 找出重複的頂點，
+		// 每個分區都依照原本的順序掃描，所以代表點一定是第一次出現的那個頂點。
+		std::vector<uint32_t> partition_of(vertex_count);
+		unsigned int partition_count = std::max(pool.GetThreadCount(), 1u);
+		pool.ParallelFor(0, (unsigned int)vertex_count, [&](unsigned int begin, unsigned int end) {
+			WeldKeyHash hash;
+			for (unsigned int i = begin; i < end; i++) {
+				partition_of[i] = (uint32_t)(hash(GetWeldKey(&vertices[static_cast<size_t>(i) * 6])) % partition_count);
+			}
+		}, 4096);
+		pool.ParallelFor(0, partition_count, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int partition = begin; partition < end; partition++) {
+				std::unordered_map<WeldKey, unsigned int, WeldKeyHash> table;
+				table.reserve(vertex_count / partition_count + 1);
+				for (unsigned int i = 0; i < vertex_count; i++) {
+					if (partition_of[i] == partition) {
+						representative[i] = table.emplace(GetWeldKey(&vertices[static_cast<size_t>(i) * 6]), i).first->second;
+					}
+				}
+			}
+		});
+	}
+
+	void MeshDecimator::Weld(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+		size_t vertex_count = vertices.size() / 6;
+		std::vector<unsigned int> representative;
+		MeshDecimator::FindDuplicateVertices(vertices, representative);
+
+		std::vector<unsigned int> remap(vertex_count);
+		std::vector<float> welded;
+		welded.reserve(vertices.size() / 4);
+		unsigned int welded_count = 0;
+		for (size_t i = 0; i < vertex_count; i++) {
+			if (representative[i] == i) {
+				remap[i] = welded_count++;
+				welded.insert(welded.end(), vertices.begin() + i * 6, vertices.begin() + i * 6 + 6);
+			} else {
+				remap[i] = remap[representative[i]];
+			}
+		}
+
+		// 頂點剛好落在 voxel 上時，同一個三角形的兩個角可能會被焊接成同一點，這種三角形直接丟掉。
+		indices.clear();
+		indices.reserve(vertex_count);
+		for (size_t i = 0; i + 2 < vertex_count; i += 3) {
+			unsigned int a = remap[i], b = remap[i + 1], c = remap[i + 2];
+			if (a != b && b != c && c != a) {
+				indices.push_back(a);
+				indices.push_back(b);
+				indices.push_back(c);
+			}
+		}
+		vertices.swap(welded);
+	}
+
+	void MeshDecimator::RunClusterPass(std::vector<float>& vertices, std::vector<unsigned int>& indices, float offset, double ratio) const {
+		unsigned int triangle_count = (unsigned int)(indices.size() / 3);
+		unsigned int vertex_count = (unsigned int)(vertices.size() / 6);
+		if (triangle_count == 0) {
+			return;
+		}
+
+		glm::vec3 lower(FLT_MAX), upper(-FLT_MAX);
+		for (unsigned int i = 0; i < vertex_count; i++) {
+			glm::vec3 p(vertices[i * 6 + 0], vertices[i * 6 + 1], vertices[i * 6 + 2]);
+			lower = glm::min(lower, p);
+			upper = glm::max(upper, p);
+		}
+
+		// cluster 太小時格子數量會爆炸，限制在大約 2^21 個格子以內。
+		float size = std::max(this->Settings.ClusterSize, 1e-6f);
+		glm::vec3 origin = lower - glm::vec3(offset);
+		glm::vec3 extent = upper - origin;
+		while ((double)(extent.x / size + 1.0f) * (extent.y / size + 1.0f) * (extent.z / size + 1.0f) > (double)(1 << 21)) {
+			size *= 2.0f;
+		}
+		glm::ivec3 grid = glm::ivec3(extent / size) + glm::ivec3(1);
+		unsigned int cluster_count = (unsigned int)(grid.x * grid.y * grid.z);
+
+		ThreadPool& pool = ThreadPool::GetInstance();
+		std::vector<unsigned int> triangle_cluster(triangle_count);
+		pool.ParallelFor(0, triangle_count, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int t = begin; t < end; t++) {
+				glm::vec3 centroid(0.0f);
+				for (int j = 0; j < 3; j++) {
+					const float* p = &vertices[static_cast<size_t>(indices[t * 3 + j]) * 6];
+					centroid += glm::vec3(p[0], p[1], p[2]);
+				}
+				glm::ivec3 cell = glm::clamp(glm::ivec3((centroid / 3.0f - origin) / size), glm::ivec3(0), grid - glm::ivec3(1));
+				triangle_cluster[t] = (unsigned int)((cell.z * grid.y + cell.y) * grid.x + cell.x);
+			}
+		}, 4096);
+
+		// 以 counting sort 把三角形依照 cluster 排好，同時找出被多個 cluster 共用的頂點（接縫）。
+		std::vector<unsigned int> cluster_start(cluster_count + 1, 0);
+		for (unsigned int t = 0; t < triangle_count; t++) {
+			cluster_start[triangle_cluster[t] + 1]++;
+		}
+		for (unsigned int c = 0; c < cluster_count; c++) {
+			cluster_start[c + 1] += cluster_start[c];
+		}
+		std::vector<unsigned int> order(triangle_count);
+		{
+			std::vector<unsigned int> cursor(cluster_start.begin(), cluster_start.end() - 1);
+			for (unsigned int t = 0; t < triangle_count; t++) {
+				order[cursor[triangle_cluster[t]]++] = t;
+			}
+		}
+
+		std::vector<unsigned int> vertex_cluster(vertex_count, UINT_MAX);
+		std::vector<char> seam(vertex_count, 0);
+		for (unsigned int t = 0; t < triangle_count; t++) {
+			for (int j = 0; j < 3; j++) {
+				unsigned int v = indices[t * 3 + j];
+				if (vertex_cluster[v] == UINT_MAX) {
+					vertex_cluster[v] = triangle_cluster[t];
+				} else if (vertex_cluster[v] != triangle_cluster[t]) {
+					seam[v] = 1;
+				}
+			}
+		}
+
+		std::vector<unsigned int> clusters;
+		for (unsigned int c = 0; c < cluster_count; c++) {
+			if (cluster_start[c + 1] > cluster_start[c]) {
+				clusters.push_back(c);
+			}
+		}
+
+		// 每個 cluster 只會寫回自己獨佔的頂點（接縫上的頂點被鎖住不會移動），所以可以直接平行處理。
+		std::vector<std::vector<unsigned int>> results(clusters.size());
+		pool.ParallelFor(0, (unsigned int)clusters.size(), [&](unsigned int begin, unsigned int end) {
+			for (unsigned int index = begin; index < end; index++) {
+				unsigned int cluster = clusters[index];
+				unsigned int first = cluster_start[cluster];
+				unsigned int count = cluster_start[cluster + 1] - first;
+
+				std::vector<unsigned int> globals;
+				globals.reserve(count * 3);
+				for (unsigned int k = 0; k < count; k++) {
+					unsigned int t = order[first + k];
+					globals.insert(globals.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+				}
+				std::sort(globals.begin(), globals.end());
+				globals.erase(std::unique(globals.begin(), globals.end()), globals.end());
+
+				Mesh mesh;
+				mesh.Vertices.resize(globals.size());
+				for (size_t i = 0; i < globals.size(); i++) {
+					const float* v = &vertices[static_cast<size_t>(globals[i]) * 6];
+					mesh.Vertices[i].Position = glm::dvec3(v[0], v[1], v[2]);
+					mesh.Vertices[i].Normal = glm::vec3(v[3], v[4], v[5]);
+					mesh.Vertices[i].Locked = seam[globals[i]] != 0;
+				}
+				mesh.Triangles.resize(count);
+				for (unsigned int k = 0; k < count; k++) {
+					unsigned int t = order[first + k];
+					for (int j = 0; j < 3; j++) {
+						mesh.Triangles[k].V[j] = (unsigned int)(std::lower_bound(globals.begin(), globals.end(), indices[t * 3 + j]) - globals.begin());
+					}
+				}
+
+				this->Simplify(mesh, (unsigned int)(count * ratio));
+
+				for (size_t i = 0; i < globals.size(); i++) {
+					if (seam[globals[i]]) {
+						continue;
+					}
+					float* v = &vertices[static_cast<size_t>(globals[i]) * 6];
+					v[0] = (float)mesh.Vertices[i].Position.x;
+					v[1] = (float)mesh.Vertices[i].Position.y;
+					v[2] = (float)mesh.Vertices[i].Position.z;
+					v[3] = mesh.Vertices[i].Normal.x;
+					v[4] = mesh.Vertices[i].Normal.y;
+					v[5] = mesh.Vertices[i].Normal.z;
+				}
+
+				std::vector<unsigned int>& result = results[index];
+				for (const Triangle& triangle : mesh.Triangles) {
+					if (!triangle.Deleted) {
+						result.push_back(globals[triangle.V[0]]);
+						result.push_back(globals[triangle.V[1]]);
+						result.push_back(globals[triangle.V[2]]);
+					}
+				}
+			}
+		});
+
+		indices.clear();
+		for (const std::vector<unsigned int>& result : results) {
+			indices.insert(indices.end(), result.begin(), result.end());
+		}
+	}
+
+	void MeshDecimator::Compact(std::vector<float>& vertices, std::vector<unsigned int>& indices) const {
+		size_t vertex_count = vertices.size() / 6;
+		std::vector<unsigned int> remap(vertex_count, UINT_MAX);
+		std::vector<float> compacted;
+		unsigned int count = 0;
+		for (unsigned int& index : indices) {
+			if (remap[index] == UINT_MAX) {
+				remap[index] = count++;
+				compacted.insert(compacted.end(), vertices.begin() + static_cast<size_t>(index) * 6, vertices.begin() + static_cast<size_t>(index) * 6 + 6);
+			}
+			index = remap[index];
+		}
+		vertices.swap(compacted);
+	}
+
+	void MeshDecimator::Simplify(Mesh& mesh, unsigned int target_count) const {
+		unsigned int triangle_count = (unsigned int)mesh.Triangles.size();
+		unsigned int deleted_count = 0;
+		double max_error = this->Settings.MaxError > 0.0f ? (double)this->Settings.MaxError * this->Settings.MaxError : DBL_MAX;
+		std::vector<char> deleted0, deleted1;
+
+		for (int iteration = 0; iteration < this->Settings.MaxIterations; iteration++) {
+			if (triangle_count - deleted_count <= target_count) {
+				break;
+			}
+
+			// 每隔幾次迭代就把刪掉的三角形清掉並重建頂點與三角形之間的關聯。
+			if (iteration % 5 == 0) {
+				this->UpdateMesh(mesh, iteration);
+				triangle_count = (unsigned int)mesh.Triangles.size();
+				deleted_count = 0;
+			}
+
+			for (Triangle& triangle : mesh.Triangles) {
+				triangle.Dirty = false;
+			}
+
+			// 門檻值隨著迭代次數成長，誤差小的邊會先被合併。
+			double threshold = 0.000000001 * std::pow(double(iteration + 3), (double)this->Settings.Aggressiveness);
+			bool is_bounded = threshold >= max_error;
+			if (is_bounded) {
+				threshold = max_error;
+			}
+
+			unsigned int collapsed = 0;
+			for (size_t i = 0; i < mesh.Triangles.size(); i++) {
+				Triangle& triangle = mesh.Triangles[i];
+				if (triangle.Error[3] > threshold || triangle.Deleted || triangle.Dirty) {
+					continue;
+				}
+
+				for (int j = 0; j < 3; j++) {
+					if (triangle.Error[j] >= threshold) {
+						continue;
+					}
+
+					// 合併後留下來的是 i0，有鎖住的頂點時要留下鎖住的那個，其他 cluster 的三角形才會繼續連在同一個頂點上。
+					unsigned int i0 = triangle.V[j];
+					unsigned int i1 = triangle.V[(j + 1) % 3];
+					if (mesh.Vertices[i1].Locked) {
+						std::swap(i0, i1);
+					}
+					Vertex& v0 = mesh.Vertices[i0];
+					Vertex& v1 = mesh.Vertices[i1];
+					if (v0.Locked && v1.Locked) {
+						continue;
+					}
+
+					if (!this->IsLinkValid(mesh, i0, i1)) {
+						continue;
+					}
+
+					glm::dvec3 p;
+					glm::vec3 normal;
+					this->CalculateError(mesh, i0, i1, p, normal);
+
+					deleted0.assign(v0.TriangleCount, 0);
+					deleted1.assign(v1.TriangleCount, 0);
+					if (this->IsFlipped(mesh, p, i1, v0, deleted0) || this->IsFlipped(mesh, p, i0, v1, deleted1)) {
+						continue;
+					}
+
+					v0.Position = p;
+					v0.Normal = normal;
+					v0.Q += v1.Q;
+					v0.Locked = v0.Locked || v1.Locked;
+
+					unsigned int start = (unsigned int)mesh.References.size();
+					this->UpdateTriangles(mesh, i0, v0, deleted0, deleted_count);
+					this->UpdateTriangles(mesh, i0, v1, deleted1, deleted_count);
+
+					// 新的關聯如果放得進原本的位置就搬回去，避免 References 一直長大。
+					unsigned int count = (unsigned int)mesh.References.size() - start;
+					if (count <= v0.TriangleCount) {
+						std::copy(mesh.References.begin() + start, mesh.References.end(), mesh.References.begin() + v0.TriangleStart);
+						mesh.References.resize(start);
+					} else {
+						v0.TriangleStart = start;
+					}
+					v0.TriangleCount = count;
+					collapsed++;
+					break;
+				}
+
+				if (triangle_count - deleted_count <= target_count) {
+					break;
+				}
+			}
+
+			// 門檻值已經到達誤差上限，而且這一輪沒有任何邊可以合併，就不用再繼續了。
+			if (is_bounded && collapsed == 0) {
+				break;
+			}
+		}
+	}
+
+	void MeshDecimator::UpdateMesh(Mesh& mesh, int iteration) const {
+		if (iteration > 0) {
+			mesh.Triangles.erase(std::remove_if(mesh.Triangles.begin(), mesh.Triangles.end(), [](const Triangle& triangle) {
+				return triangle.Deleted;
+			}), mesh.Triangles.end());
+		}
+
+		for (Vertex& vertex : mesh.Vertices) {
+			vertex.TriangleStart = 0;
+			vertex.TriangleCount = 0;
+		}
+		for (const Triangle& triangle : mesh.Triangles) {
+			for (int j = 0; j < 3; j++) {
+				mesh.Vertices[triangle.V[j]].TriangleCount++;
+			}
+		}
+		unsigned int start = 0;
+		for (Vertex& vertex : mesh.Vertices) {
+			vertex.TriangleStart = start;
+			start += vertex.TriangleCount;
+			vertex.TriangleCount = 0;
+		}
+		mesh.References.resize(start);
+		for (unsigned int i = 0; i < mesh.Triangles.size(); i++) {
+			for (unsigned int j = 0; j < 3; j++) {
+				Vertex& vertex = mesh.Vertices[mesh.Triangles[i].V[j]];
+				mesh.References[vertex.TriangleStart + vertex.TriangleCount++] = { i, j };
+			}
+		}
+
+		if (iteration != 0) {
+			return;
+		}
+
+		// 只被一個三角形使用的邊是邊界（例如表面在 volume 的邊緣被截斷），超過兩個則是非流形邊，兩者的頂點都鎖住。
+		std::vector<unsigned int> neighbor_count, neighbor_ids;
+		for (unsigned int i = 0; i < mesh.Vertices.size(); i++) {
+			neighbor_count.clear();
+			neighbor_ids.clear();
+			const Vertex& vertex = mesh.Vertices[i];
+			for (unsigned int k = 0; k < vertex.TriangleCount; k++) {
+				const Triangle& triangle = mesh.Triangles[mesh.References[vertex.TriangleStart + k].Triangle];
+				for (int j = 0; j < 3; j++) {
+					unsigned int id = triangle.V[j];
+					if (id == i) {
+						continue;
+					}
+					auto found = std::find(neighbor_ids.begin(), neighbor_ids.end(), id);
+					if (found == neighbor_ids.end()) {
+						neighbor_ids.push_back(id);
+						neighbor_count.push_back(1);
+					} else {
+						neighbor_count[found - neighbor_ids.begin()]++;
+					}
+				}
+			}
+			for (size_t j = 0; j < neighbor_ids.size(); j++) {
+				if (neighbor_count[j] != 2) {
+					mesh.Vertices[i].Locked = true;
+					mesh.Vertices[neighbor_ids[j]].Locked = true;
+				}
+			}
+		}
+
+		for (Triangle& triangle : mesh.Triangles) {
+			const glm::dvec3& p0 = mesh.Vertices[triangle.V[0]].Position;
+			glm::dvec3 normal = glm::cross(mesh.Vertices[triangle.V[1]].Position - p0, mesh.Vertices[triangle.V[2]].Position - p0);
+			double length = glm::length(normal);
+			triangle.Normal = length > 0.0 ? normal / length : glm::dvec3(0.0);
+			SymmetricMatrix plane(triangle.Normal.x, triangle.Normal.y, triangle.Normal.z, -glm::dot(triangle.Normal, p0));
+			for (int j = 0; j < 3; j++) {
+				mesh.Vertices[triangle.V[j]].Q += plane;
+			}
+		}
+
+		glm::dvec3 p;
+		glm::vec3 normal;
+		for (Triangle& triangle : mesh.Triangles) {
+			for (int j = 0; j < 3; j++) {
+				triangle.Error[j] = this->CalculateError(mesh, triangle.V[j], triangle.V[(j + 1) % 3], p, normal);
+			}
+			triangle.Error[3] = std::min(triangle.Error[0], std::min(triangle.Error[1], triangle.Error[2]));
+		}
+	}
+
+	void MeshDecimator::UpdateTriangles(Mesh& mesh, unsigned int i0, const Vertex& vertex, const std::vector<char>& deleted, unsigned int& deleted_count) const {
+		glm::dvec3 p;
+		glm::vec3 normal;
+		for (unsigned int k = 0; k < vertex.TriangleCount; k++) {
+			Reference reference = mesh.References[vertex.TriangleStart + k];
+			Triangle& triangle = mesh.Triangles[reference.Triangle];
+			if (triangle.Deleted) {
+				continue;
+			}
+			if (deleted[k]) {
+				triangle.Deleted = true;
+				deleted_count++;
+				continue;
+			}
+
+			triangle.V[reference.Corner] = i0;
+			triangle.Dirty = true;
+
+			const glm::dvec3& p0 = mesh.Vertices[triangle.V[0]].Position;
+			glm::dvec3 face_normal = glm::cross(mesh.Vertices[triangle.V[1]].Position - p0, mesh.Vertices[triangle.V[2]].Position - p0);
+			double length = glm::length(face_normal);
+			triangle.Normal = length > 0.0 ? face_normal / length : glm::dvec3(0.0);
+
+			for (int j = 0; j < 3; j++) {
+				triangle.Error[j] = this->CalculateError(mesh, triangle.V[j], triangle.V[(j + 1) % 3], p, normal);
+			}
+			triangle.Error[3] = std::min(triangle.Error[0], std::min(triangle.Error[1], triangle.Error[2]));
+			mesh.References.push_back(reference);
+		}
+	}
+
+	bool MeshDecimator::IsLinkValid(const Mesh& mesh, unsigned int i0, unsigned int i1) const {
+		// Link condition：內部邊的兩個端點只能有兩個共同的鄰居，否則合併後會產生非流形邊。
+		std::vector<unsigned int> neighbors0, common;
+		const Vertex& v0 = mesh.Vertices[i0];
+		const Vertex& v1 = mesh.Vertices[i1];
+		for (unsigned int k = 0; k < v0.TriangleCount; k++) {
+			const Triangle& triangle = mesh.Triangles[mesh.References[v0.TriangleStart + k].Triangle];
+			if (!triangle.Deleted) {
+				neighbors0.insert(neighbors0.end(), triangle.V, triangle.V + 3);
+			}
+		}
+		for (unsigned int k = 0; k < v1.TriangleCount; k++) {
+			const Triangle& triangle = mesh.Triangles[mesh.References[v1.TriangleStart + k].Triangle];
+			if (triangle.Deleted) {
+				continue;
+			}
+			for (int j = 0; j < 3; j++) {
+				unsigned int id = triangle.V[j];
+				if (id != i0 && id != i1 && std::find(neighbors0.begin(), neighbors0.end(), id) != neighbors0.end() && std::find(common.begin(), common.end(), id) == common.end()) {
+					common.push_back(id);
+				}
+			}
+		}
+		return common.size() <= 2;
+	}
+
+	bool MeshDecimator::IsFlipped(const Mesh& mesh, const glm::dvec3& p, unsigned int i1, const Vertex& vertex, std::vector<char>& deleted) const {
+		for (unsigned int k = 0; k < vertex.TriangleCount; k++) {
+			const Reference& reference = mesh.References[vertex.TriangleStart + k];
+			const Triangle& triangle = mesh.Triangles[reference.Triangle];
+			if (triangle.Deleted) {
+				continue;
+			}
+
+			unsigned int id1 = triangle.V[(reference.Corner + 1) % 3];
+			unsigned int id2 = triangle.V[(reference.Corner + 2) % 3];
+			if (id1 == i1 || id2 == i1) {
+				// 同時包含這條邊兩個端點的三角形在合併後會消失。
+				deleted[k] = 1;
+				continue;
+			}
+
+			glm::dvec3 d1 = mesh.Vertices[id1].Position - p;
+			glm::dvec3 d2 = mesh.Vertices[id2].Position - p;
+			double length1 = glm::length(d1), length2 = glm::length(d2);
+			if (length1 <= 0.0 || length2 <= 0.0) {
+				return true;
+			}
+			d1 /= length1;
+			d2 /= length2;
+			if (std::abs(glm::dot(d1, d2)) > 0.999) {
+				return true;
+			}
+
+			deleted[k] = 0;
+			glm::dvec3 normal = glm::normalize(glm::cross(d1, d2));
+			if (glm::dot(triangle.Normal, triangle.Normal) > 0.0 && glm::dot(normal, triangle.Normal) < 0.2) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	double MeshDecimator::CalculateError(const Mesh& mesh, unsigned int id_v1, unsigned int id_v2, glm::dvec3& result, glm::vec3& normal) const {
+		const Vertex& a = mesh.Vertices[id_v1];
+		const Vertex& b = mesh.Vertices[id_v2];
+		if (a.Locked && b.Locked) {
+			result = a.Position;
+			normal = a.Normal;
+			return DBL_MAX;
+		}
+
+		SymmetricMatrix q = a.Q;
+		q += b.Q;
+
+		// 被鎖住的頂點不能移動，所以只能把另一個頂點合併過去。
+		if (a.Locked || b.Locked) {
+			const Vertex& locked = a.Locked ? a : b;
+			result = locked.Position;
+			normal = locked.Normal;
+			return q.Error(result);
+		}
+
+		glm::vec3 blended = a.Normal + b.Normal;
+		glm::vec3 middle_normal = glm::length(blended) > 1e-6f ? glm::normalize(blended) : a.Normal;
+		glm::dvec3 middle = (a.Position + b.Position) * 0.5;
+
+		// 平坦區域的 quadric 幾乎是奇異矩陣，解出來的最佳點可能跑得很遠，這時改用端點或中點。
+		double det = q.Determinant(0, 1, 2, 1, 4, 5, 2, 5, 7);
+		if (std::abs(det) > 1e-10) {
+			glm::dvec3 optimal(
+				-1.0 / det * q.Determinant(1, 2, 3, 4, 5, 6, 5, 7, 8),
+				1.0 / det * q.Determinant(0, 2, 3, 1, 5, 6, 2, 7, 8),
+				-1.0 / det * q.Determinant(0, 1, 3, 1, 4, 6, 2, 5, 8));
+			if (glm::length(optimal - middle) <= glm::length(a.Position - b.Position)) {
+				result = optimal;
+				normal = middle_normal;
+				return q.Error(result);
+			}
+		}
+
+		double error_a = q.Error(a.Position);
+		double error_b = q.Error(b.Position);
+		double error_middle = q.Error(middle);
+		double error = std::min(error_a, std::min(error_b, error_middle));
+		if (error == error_a) {
+			result = a.Position;
+			normal = a.Normal;
+		} else if (error == error_b) {
+			result = b.Position;
+			normal = b.Normal;
+		} else {
+			result = middle;
+			normal = middle_normal;
+		}
+		return error;
+	}
+}
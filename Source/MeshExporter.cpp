@@ -0,0 +1,249 @@
+#include "MeshExporter.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Nexus {
+
+	namespace {
+		// 每個區塊的元素數量，區塊會被平行地格式化到各自的緩衝區，再依序寫入檔案。
+		const unsigned int BLOCK_SIZE = 1 << 16;
+
+		template<typename Formatter>
+		bool WriteBlocks(std::ofstream& file, unsigned int count, Formatter format) {
+			ThreadPool& pool = ThreadPool::GetInstance();
+			unsigned int block_count = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			unsigned int batch_size = std::max(pool.GetThreadCount() * 2, 1u);
+
+			// 緩衝區在每一批之間重複使用，不會一直重新配置記憶體。
+			std::vector<std::vector<char>> buffers(std::min(batch_size, std::max(block_count, 1u)));
+			for (unsigned int first = 0; first < block_count; first += batch_size) {
+				unsigned int last = std::min(block_count, first + batch_size);
+				pool.ParallelFor(first, last, [&](unsigned int begin, unsigned int end) {
+					for (unsigned int block = begin; block < end; block++) {
+						std::vector<char>& buffer = buffers[block - first];
+						buffer.clear();
+						format(block * BLOCK_SIZE, std::min(count, (block + 1) * BLOCK_SIZE), buffer);
+					}
+				});
+				for (unsigned int block = first; block < last; block++) {
+					file.write(buffers[block - first].data(), (std::streamsize)buffers[block - first].size());
+				}
+				if (!file.good()) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		template<typename T>
+		void AppendBinary(std::vector<char>& buffer, const T& value) {
+			const char* bytes = reinterpret_cast<const char*>(&value);
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		template<typename T>
+		void AppendNumber(std::vector<char>& buffer, T value) {
+			char text[32];
+			std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+			buffer.insert(buffer.end(), text, result.ptr);
+		}
+
+		void AppendText(std::vector<char>& buffer, const char* text) {
+			buffer.insert(buffer.end(), text, text + std::strlen(text));
+		}
+
+		// 頂點法向量是 gradient 的方向（指向數值較高的一側），三角形的繞向則是朝向數值較低的一側，
+		// 也就是 iso value 以上區域的外側。輸出時把法向量反過來，讓它與繞向（以及 STL 的面法向量）一致。
+		glm::vec3 GetExportNormal(const float* vertex) {
+			return -glm::vec3(vertex[3], vertex[4], vertex[5]);
+		}
+
+		unsigned int GetTriangleCount(const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+			return indices.empty() ? (unsigned int)(vertices.size() / 18) : (unsigned int)(indices.size() / 3);
+		}
+
+		unsigned int GetCorner(const std::vector<unsigned int>& indices, unsigned int triangle, unsigned int corner) {
+			return indices.empty() ? triangle * 3 + corner : indices[static_cast<size_t>(triangle) * 3 + corner];
+		}
+	}
+
+	bool MeshExporter::Export(const std::string& path, const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+		return MeshExporter::Export(path, vertices, indices, MeshExporter::GetFormatFromPath(path));
+	}
+
+	bool MeshExporter::Export(const std::string& path, const std::vector<float>& vertices, const std::vector<unsigned int>& indices, MeshFileFormat format) {
+		if (format == MESH_FILE_FORMAT_UNKNOWN) {
+			Logger::Message(LOG_ERROR, "Unknown mesh file format: " + path + " (supported: .ply, .stl, .obj)");
+			return false;
+		}
+		if (vertices.empty()) {
+			Logger::Message(LOG_ERROR, "There is no mesh to export, extract the iso surface first (and keep the host copies).");
+			return false;
+		}
+
+		std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (file.fail()) {
+			Logger::Message(LOG_ERROR, "Failed to open the mesh file at: " + path);
+			return false;
+		}
+
+		auto start = std::chrono::system_clock::now();
+		bool success = false;
+		if (format == MESH_FILE_FORMAT_PLY) {
+			success = MeshExporter::WritePLY(file, vertices, indices);
+		} else if (format == MESH_FILE_FORMAT_STL) {
+			success = MeshExporter::WriteSTL(file, vertices, indices);
+		} else if (format == MESH_FILE_FORMAT_OBJ) {
+			success = MeshExporter::WriteOBJ(file, vertices, indices);
+		}
+		file.close();
+		std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - start;
+
+		if (!success || file.fail()) {
+			Logger::Message(LOG_ERROR, "Failed to write the mesh file at: " + path);
+			return false;
+		}
+		Logger::Message(LOG_INFO, "Exported " + std::to_string(GetTriangleCount(vertices, indices)) + " triangles to " + path + " in " + std::to_string(elapsed.count()) + " seconds.");
+		return true;
+	}
+
+	MeshFileFormat MeshExporter::GetFormatFromPath(const std::string& path) {
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+		if (extension == ".ply") {
+			return MESH_FILE_FORMAT_PLY;
+		} else if (extension == ".stl") {
+			return MESH_FILE_FORMAT_STL;
+		} else if (extension == ".obj") {
+			return MESH_FILE_FORMAT_OBJ;
+		}
+		return MESH_FILE_FORMAT_UNKNOWN;
+	}
+
+	bool MeshExporter::WritePLY(std::ofstream& file, const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+		unsigned int vertex_count = (unsigned int)(vertices.size() / 6);
+		unsigned int triangle_count = GetTriangleCount(vertices, indices);
+
+		std::string header = "ply\n"
+			"format binary_little_endian 1.0\n"
+			"comment Exported by Nexus\n"
+			"element vertex " + std::to_string(vertex_count) + "\n"
+			"property float x\nproperty float y\nproperty float z\n"
+			"property float nx\nproperty float ny\nproperty float nz\n"
+			"element face " + std::to_string(triangle_count) + "\n"
+			"property list uchar uint vertex_indices\n"
+			"end_header\n";
+		file.write(header.data(), (std::streamsize)header.size());
+
+		bool success = WriteBlocks(file, vertex_count, [&](unsigned int begin, unsigned int end, std::vector<char>& buffer) {
+			buffer.reserve(static_cast<size_t>(end - begin) * 6 * sizeof(float));
+			for (unsigned int i = begin; i < end; i++) {
+				const float* vertex = &vertices[static_cast<size_t>(i) * 6];
+				AppendBinary(buffer, glm::vec3(vertex[0], vertex[1], vertex[2]));
+				AppendBinary(buffer, GetExportNormal(vertex));
+			}
+		});
+		if (!success) {
+			return false;
+		}
+
+		return WriteBlocks(file, triangle_count, [&](unsigned int begin, unsigned int end, std::vector<char>& buffer) {
+			buffer.reserve(static_cast<size_t>(end - begin) * 13);
+			for (unsigned int t = begin; t < end; t++) {
+				AppendBinary(buffer, (uint8_t)3);
+				for (unsigned int corner = 0; corner < 3; corner++) {
+					AppendBinary(buffer, (uint32_t)GetCorner(indices, t, corner));
+				}
+			}
+		});
+	}
+
+	bool MeshExporter::WriteSTL(std::ofstream& file, const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+		unsigned int triangle_count = GetTriangleCount(vertices, indices);
+
+		char header[80] = {};
+		std::strncpy(header, "Binary STL exported by Nexus", sizeof(header) - 1);
+		file.write(header, sizeof(header));
+		uint32_t count = triangle_count;
+		file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+		return WriteBlocks(file, triangle_count, [&](unsigned int begin, unsigned int end, std::vector<char>& buffer) {
+			buffer.reserve(static_cast<size_t>(end - begin) * 50);
+			for (unsigned int t = begin; t < end; t++) {
+				glm::vec3 p[3];
+				for (unsigned int corner = 0; corner < 3; corner++) {
+					const float* vertex = &vertices[static_cast<size_t>(GetCorner(indices, t, corner)) * 6];
+					p[corner] = glm::vec3(vertex[0], vertex[1], vertex[2]);
+				}
+				// STL 只有面的法向量，由三角形本身算出來。
+				glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+				float length = glm::length(normal);
+				normal = length > 0.0f ? normal / length : glm::vec3(0.0f);
+
+				AppendBinary(buffer, normal);
+				AppendBinary(buffer, p[0]);
+				AppendBinary(buffer, p[1]);
+				AppendBinary(buffer, p[2]);
+				AppendBinary(buffer, (uint16_t)0);
+			}
+		});
+	}
+
+	bool MeshExporter::WriteOBJ(std::ofstream& file, const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+		unsigned int vertex_count = (unsigned int)(vertices.size() / 6);
+		unsigned int triangle_count = GetTriangleCount(vertices, indices);
+
+		std::string header = "# Exported by Nexus\n# " + std::to_string(vertex_count) + " vertices, " + std::to_string(triangle_count) + " triangles\n";
+		file.write(header.data(), (std::streamsize)header.size());
+
+		bool success = WriteBlocks(file, vertex_count, [&](unsigned int begin, unsigned int end, std::vector<char>& buffer) {
+			buffer.reserve(static_cast<size_t>(end - begin) * 80);
+			for (unsigned int i = begin; i < end; i++) {
+				const float* vertex = &vertices[static_cast<size_t>(i) * 6];
+				AppendText(buffer, "v ");
+				AppendNumber(buffer, vertex[0]);
+				buffer.push_back(' ');
+				AppendNumber(buffer, vertex[1]);
+				buffer.push_back(' ');
+				AppendNumber(buffer, vertex[2]);
+				glm::vec3 normal = GetExportNormal(vertex);
+				AppendText(buffer, "\nvn ");
+				AppendNumber(buffer, normal.x);
+				buffer.push_back(' ');
+				AppendNumber(buffer, normal.y);
+				buffer.push_back(' ');
+				AppendNumber(buffer, normal.z);
+				buffer.push_back('\n');
+			}
+		});
+		if (!success) {
+			return false;
+		}
+
+		// OBJ 的 index 從 1 開始，頂點與法向量使用同一個 index。
+		return WriteBlocks(file, triangle_count, [&](unsigned int begin, unsigned int end, std::vector<char>& buffer) {
+			buffer.reserve(static_cast<size_t>(end - begin) * 48);
+			for (unsigned int t = begin; t < end; t++) {
+				buffer.push_back('f');
+				for (unsigned int corner = 0; corner < 3; corner++) {
+					unsigned int index = GetCorner(indices, t, corner) + 1;
+					buffer.push_back(' ');
+					AppendNumber(buffer, index);
+					AppendText(buffer, "//");
+					AppendNumber(buffer, index);
+				}
+				buffer.push_back('\n');
+			}
+		});
+	}
+}
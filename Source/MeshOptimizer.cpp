@@ -0,0 +1,157 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Nexus {
+
+	void MeshOptimizer::Optimize(std::vector<float>& vertices, unsigned int stride, std::vector<unsigned int>& indices) {
+		const unsigned int vertex_count = (unsigned int)(vertices.size() / stride);
+		this->ACMRBefore = MeshOptimizer::ComputeACMR(indices, vertex_count, this->CacheSize);
+
+		this->OptimizeVertexCache(indices, vertex_count);
+		std::vector<unsigned int> remap;
+		MeshOptimizer::OptimizeVertexFetch(indices, vertex_count, remap);
+		MeshOptimizer::RemapVertices(vertices, stride, remap);
+
+		this->ACMRAfter = MeshOptimizer::ComputeACMR(indices, vertex_count, this->CacheSize);
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertex_count) const {
+		const unsigned int triangle_count = (unsigned int)(indices.size() / 3);
+		if (triangle_count == 0 || vertex_count == 0) {
+			return;
+		}
+
+		// 每個頂點相鄰的三角形（CSR 格式），live 是還沒有輸出的相鄰三角形數量。
+		std::vector<unsigned int> live(vertex_count, 0);
+		for (unsigned int index : indices) {
+			live[index]++;
+		}
+		std::vector<unsigned int> offsets(vertex_count + 1, 0);
+		for (unsigned int v = 0; v < vertex_count; v++) {
+			offsets[v + 1] = offsets[v] + live[v];
+		}
+		std::vector<unsigned int> adjacency(indices.size());
+		std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+		for (unsigned int t = 0; t < triangle_count; t++) {
+			for (int c = 0; c < 3; c++) {
+				adjacency[cursor[indices[static_cast<size_t>(t) * 3 + c]]++] = t;
+			}
+		}
+
+		// cache_time 是頂點最後一次進入 cache 的時間，time - cache_time[v] <= CacheSize 代表還在 cache 裡。
+		std::vector<unsigned int> cache_time(vertex_count, 0);
+		std::vector<uint8_t> is_emitted(triangle_count, 0);
+		std::vector<unsigned int> dead_end;
+		std::vector<unsigned int> candidates;
+		std::vector<unsigned int> output;
+		dead_end.reserve(indices.size());
+		output.reserve(indices.size());
+		unsigned int time = this->CacheSize + 1;
+		unsigned int scan = 0;
+
+		auto get_next_vertex = [&]() -> int64_t {
+			// 優先選擇還有三角形、而且把它的三角形全部輸出之後仍然會留在 cache 裡的頂點，越晚進入 cache 的越好。
+			int64_t best = -1;
+			int64_t best_priority = -1;
+			for (unsigned int v : candidates) {
+				if (live[v] == 0) {
+					continue;
+				}
+				int64_t priority = 0;
+				if (time - cache_time[v] + 2 * live[v] <= this->CacheSize) {
+					priority = time - cache_time[v];
+				}
+				if (priority > best_priority) {
+					best = v;
+					best_priority = priority;
+				}
+			}
+			if (best >= 0) {
+				return best;
+			}
+
+			// 走進死路時，先從最近輸出過的頂點往回找，再依照編號找下一個還有三角形的頂點。
+			while (!dead_end.empty()) {
+				unsigned int v = dead_end.back();
+				dead_end.pop_back();
+				if (live[v] > 0) {
+					return v;
+				}
+			}
+			for (; scan < vertex_count; scan++) {
+				if (live[scan] > 0) {
+					return scan;
+				}
+			}
+			return -1;
+		};
+
+		int64_t fanning = get_next_vertex();
+		while (fanning >= 0) {
+			candidates.clear();
+			for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+				unsigned int t = adjacency[a];
+				if (is_emitted[t]) {
+					continue;
+				}
+				is_emitted[t] = 1;
+				for (int c = 0; c < 3; c++) {
+					unsigned int v = indices[static_cast<size_t>(t) * 3 + c];
+					output.push_back(v);
+					dead_end.push_back(v);
+					candidates.push_back(v);
+					live[v]--;
+					if (time - cache_time[v] > this->CacheSize) {
+						cache_time[v] = time;
+						time++;
+					}
+				}
+			}
+			fanning = get_next_vertex();
+		}
+		indices.swap(output);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(std::vector<unsigned int>& indices, unsigned int vertex_count, std::vector<unsigned int>& remap) {
+		remap.assign(vertex_count, UINT32_MAX);
+		unsigned int next = 0;
+		for (unsigned int& index : indices) {
+			if (remap[index] == UINT32_MAX) {
+				remap[index] = next++;
+			}
+			index = remap[index];
+		}
+		for (unsigned int v = 0; v < vertex_count; v++) {
+			if (remap[v] == UINT32_MAX) {
+				remap[v] = next++;
+			}
+		}
+	}
+
+	void MeshOptimizer::RemapVertices(std::vector<float>& vertices, unsigned int stride, const std::vector<unsigned int>& remap) {
+		std::vector<float> reordered(vertices.size());
+		for (size_t v = 0; v < remap.size(); v++) {
+			std::copy(vertices.begin() + v * stride, vertices.begin() + (v + 1) * stride, reordered.begin() + static_cast<size_t>(remap[v]) * stride);
+		}
+		vertices.swap(reordered);
+	}
+
+	float MeshOptimizer::ComputeACMR(const std::vector<unsigned int>& indices, unsigned int vertex_count, unsigned int cache_size) {
+		if (indices.size() < 3) {
+			return 0.0f;
+		}
+
+		// FIFO cache：inserted[v] 是頂點 v 被放進 cache 時的序號，之後又放進 cache_size 個頂點就會被擠出去。
+		std::vector<unsigned int> inserted(vertex_count, 0);
+		unsigned int misses = 0;
+		for (unsigned int index : indices) {
+			if (inserted[index] == 0 || misses - inserted[index] >= cache_size) {
+				misses++;
+				inserted[index] = misses;
+			}
+		}
+		return (float)misses / (float)(indices.size() / 3);
+	}
+}
@@ -0,0 +1,115 @@
+#include "MinMaxOctree.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Nexus {
+
+	void MinMaxOctree::Build(const std::vector<float>& data, glm::ivec3 resolution, int brick_size) {
+		this->Clear();
+		this->BrickSize = std::max(brick_size, 1);
+
+		glm::ivec3 cells = resolution - glm::ivec3(1);
+		if (cells.x <= 0 || cells.y <= 0 || cells.z <= 0 || data.size() < static_cast<size_t>(resolution.x) * resolution.y * resolution.z) {
+			Logger::Message(LOG_WARNING, "Unable to build the min/max octree, the volume has no cells.");
+			return;
+		}
+
+		// 先把整個 volume 切成 BrickSize^3 個 cell 的 brick，並求出每個 brick 內所有 voxel 的最小值與最大值。
+		this->BrickGridSize = (cells + glm::ivec3(this->BrickSize - 1)) / this->BrickSize;
+		this->Bricks.resize(static_cast<size_t>(this->BrickGridSize.x) * this->BrickGridSize.y * this->BrickGridSize.z);
+
+		Level leaf;
+		leaf.Size = this->BrickGridSize;
+		leaf.Range.resize(this->Bricks.size());
+
+		size_t slice = static_cast<size_t>(resolution.x) * resolution.y;
+		for (int bz = 0; bz < this->BrickGridSize.z; bz++) {
+			for (int by = 0; by < this->BrickGridSize.y; by++) {
+				for (int bx = 0; bx < this->BrickGridSize.x; bx++) {
+					VolumeBrick brick;
+					brick.Origin = glm::ivec3(bx, by, bz) * this->BrickSize;
+					brick.Size = glm::min(glm::ivec3(this->BrickSize), cells - brick.Origin);
+
+					float min_value = std::numeric_limits<float>::max();
+					float max_value = std::numeric_limits<float>::lowest();
+					for (int z = brick.Origin.z; z <= brick.Origin.z + brick.Size.z; z++) {
+						for (int y = brick.Origin.y; y <= brick.Origin.y + brick.Size.y; y++) {
+							const float* row = data.data() + z * slice + static_cast<size_t>(y) * resolution.x;
+							auto range = std::minmax_element(row + brick.Origin.x, row + brick.Origin.x + brick.Size.x + 1);
+							min_value = std::min(min_value, *range.first);
+							max_value = std::max(max_value, *range.second);
+						}
+					}
+					brick.Min = min_value;
+					brick.Max = max_value;
+
+					unsigned int index = this->GetNodeIndex(leaf, bx, by, bz);
+					this->Bricks[index] = brick;
+					leaf.Range[index] = glm::vec2(min_value, max_value);
+				}
+			}
+		}
+		this->Levels.push_back(std::move(leaf));
+
+		// 往上每一層把下一層 2x2x2 個節點合併，直到只剩下一個根節點。
+		while (this->Levels.back().Range.size() > 1) {
+			const Level& child = this->Levels.back();
+			Level parent;
+			parent.Size = (child.Size + glm::ivec3(1)) / 2;
+			parent.Range.assign(static_cast<size_t>(parent.Size.x) * parent.Size.y * parent.Size.z,
+				glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()));
+
+			for (int z = 0; z < child.Size.z; z++) {
+				for (int y = 0; y < child.Size.y; y++) {
+					for (int x = 0; x < child.Size.x; x++) {
+						const glm::vec2& range = child.Range[this->GetNodeIndex(child, x, y, z)];
+						glm::vec2& merged = parent.Range[this->GetNodeIndex(parent, x / 2, y / 2, z / 2)];
+						merged.x = std::min(merged.x, range.x);
+						merged.y = std::max(merged.y, range.y);
+					}
+				}
+			}
+			this->Levels.push_back(std::move(parent));
+		}
+
+		Logger::Message(LOG_DEBUG, "Min/max octree built: " + std::to_string(this->Bricks.size()) + " bricks, " + std::to_string(this->Levels.size()) + " levels.");
+	}
+
+	void MinMaxOctree::Clear() {
+		this->BrickGridSize = glm::ivec3(0);
+		this->Bricks.clear();
+		this->Levels.clear();
+	}
+
+	void MinMaxOctree::GetActiveBricks(float iso_value, std::vector<unsigned int>& bricks) const {
+		bricks.clear();
+		if (this->Levels.empty()) {
+			return;
+		}
+		this->CollectActiveBricks((int)this->Levels.size() - 1, 0, 0, 0, iso_value, bricks);
+	}
+
+	void MinMaxOctree::CollectActiveBricks(int level, int x, int y, int z, float iso_value, std::vector<unsigned int>& bricks) const {
+		const Level& current = this->Levels[level];
+		if (x >= current.Size.x || y >= current.Size.y || z >= current.Size.z) {
+			return;
+		}
+
+		unsigned int index = this->GetNodeIndex(current, x, y, z);
+		const glm::vec2& range = current.Range[index];
+		if (!IsStraddling(range.x, range.y, iso_value)) {
+			return;
+		}
+
+		if (level == 0) {
+			bricks.push_back(index);
+			return;
+		}
+
+		for (int child = 0; child < 8; child++) {
+			this->CollectActiveBricks(level - 1, x * 2 + (child & 1), y * 2 + ((child >> 1) & 1), z * 2 + ((child >> 2) & 1), iso_value, bricks);
+		}
+	}
+}
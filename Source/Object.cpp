@@ -1,11 +1,14 @@
 #include "Object.h"
 
 #include "Logger.h"
+#include "MeshOptimizer.h"
 
 #include <iostream>
 
 namespace Nexus {
 
+	bool Object::EnableMeshOptimization = false;
+
 	VertexBuffer::VertexBuffer(void* vertices, std::size_t size) {
 		glGenBuffers(1, &this->ID);
 		this->Bind();
@@ -103,6 +106,8 @@ namespace Nexus {
 	}
 
 	void Object::BufferInitialize() {
+		this->OptimizeMesh();
+
 		this->VBO = std::make_unique<Nexus::VertexBuffer>(this->Vertices.data(), this->GetVertexCount() * sizeof(Vertex));
 		this->EBO = std::make_unique<Nexus::IndexBuffer>(this->Indices.data(), this->Indices.size() * sizeof(unsigned int));
 
@@ -110,6 +115,30 @@ namespace Nexus {
 		this->VAO = std::make_unique<Nexus::VertexArray>(this->VBO.get(), Attribs, 3, (GLsizei)sizeof(Vertex), this->EBO.get());
 	}
 
+	void Object::OptimizeMesh() {
+		// 只處理 Vertex 格式（position、normal、texcoord）的 indexed mesh，其他格式的物件維持原本的順序。
+		const unsigned int stride = sizeof(Vertex) / sizeof(float);
+		unsigned int vertex_count = this->GetPositionCount();
+		if (!Object::EnableMeshOptimization || this->Indices.empty() || this->Vertices.size() != static_cast<size_t>(vertex_count) * stride) {
+			return;
+		}
+
+		MeshOptimizer optimizer;
+		optimizer.Optimize(this->Vertices, stride, this->Indices);
+
+		// Position、Normal、TexCoord 跟著 Vertices 的新順序重建。
+		this->Position.clear();
+		this->Normal.clear();
+		this->TexCoord.clear();
+		for (unsigned int v = 0; v < vertex_count; v++) {
+			const float* vertex = &this->Vertices[static_cast<size_t>(v) * stride];
+			this->Position.insert(this->Position.end(), vertex, vertex + 3);
+			this->Normal.insert(this->Normal.end(), vertex + 3, vertex + 6);
+			this->TexCoord.insert(this->TexCoord.end(), vertex + 6, vertex + 8);
+		}
+		Logger::Message(LOG_DEBUG, this->ShapeName + " mesh optimization completed. ACMR: " + std::to_string(optimizer.GetACMRBefore()) + " -> " + std::to_string(optimizer.GetACMRAfter()));
+	}
+
 	void Object::AddPosition(float x, float y) {
 		this->Position.push_back(x);
 		this->Position.push_back(y);
@@ -0,0 +1,158 @@
+#include "OccupancyGrid.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace Nexus {
+
+	namespace {
+		// Distance map 以 8 bits 儲存，超過的距離一律當作 255。
+		const int MaxDistance = 255;
+	}
+
+	void OccupancyGrid::Build(const MinMaxOctree& octree, float value_max) {
+		this->Clear();
+		if (octree.IsEmpty()) {
+			return;
+		}
+
+		this->BrickSize = octree.GetBrickSize();
+		this->GridSize = octree.GetBrickGridSize();
+		float scale = value_max > 0.0f ? 1.0f / value_max : 1.0f;
+		this->BrickRanges.reserve(octree.GetBrickCount());
+		for (const VolumeBrick& brick : octree.GetBricks()) {
+			this->BrickRanges.push_back(glm::vec2(brick.Min, brick.Max) * scale);
+		}
+	}
+
+	void OccupancyGrid::Clear() {
+		this->GridSize = glm::ivec3(0);
+		this->BrickRanges.clear();
+		this->BrickBins.clear();
+		this->BinVisible.clear();
+		this->Occupied.clear();
+		this->Distances.clear();
+		this->OccupiedBrickCount = 0;
+	}
+
+	void OccupancyGrid::ComputeBrickBins(unsigned int bin_count) {
+		// Transfer function 以 linear filtering 取樣，數值 v 落在 bin v * N - 0.5 附近，前後兩個 bin 都要算進去。
+		this->BrickBins.resize(this->BrickRanges.size());
+		for (size_t b = 0; b < this->BrickRanges.size(); b++) {
+			float low = this->BrickRanges[b].x * bin_count - 0.5f;
+			float high = this->BrickRanges[b].y * bin_count - 0.5f;
+			this->BrickBins[b] = glm::ivec2(
+				glm::clamp((int)std::floor(low), 0, (int)bin_count - 1),
+				glm::clamp((int)std::ceil(high), 0, (int)bin_count - 1));
+		}
+	}
+
+	bool OccupancyGrid::Update(const std::vector<float>& transfer_function) {
+		const unsigned int bin_count = (unsigned int)(transfer_function.size() / 4);
+		if (this->BrickRanges.empty() || bin_count == 0) {
+			return false;
+		}
+
+		std::vector<uint8_t> bin_visible(bin_count);
+		for (unsigned int i = 0; i < bin_count; i++) {
+			bin_visible[i] = transfer_function[static_cast<size_t>(i) * 4 + 3] > this->OpacityThreshold ? 1 : 0;
+		}
+
+		// 第一次（或 bin 數量改變）時全部重新計算，否則只需要看可見狀態改變的 bin 範圍。
+		const bool is_full_rebuild = this->BinVisible.size() != bin_count;
+		int changed_first = 0;
+		int changed_last = (int)bin_count - 1;
+		if (is_full_rebuild) {
+			this->ComputeBrickBins(bin_count);
+			this->Occupied.assign(this->BrickBins.size(), 0);
+		} else {
+			changed_first = (int)bin_count;
+			changed_last = -1;
+			for (unsigned int i = 0; i < bin_count; i++) {
+				if (bin_visible[i] != this->BinVisible[i]) {
+					changed_first = std::min(changed_first, (int)i);
+					changed_last = (int)i;
+				}
+			}
+			if (changed_last < 0) {
+				return false;
+			}
+		}
+		this->BinVisible.swap(bin_visible);
+
+		// visible_prefix[i] 是前 i 個 bin 中可見的數量，brick 是否被佔用只需要比較兩個前綴和。
+		std::vector<unsigned int> visible_prefix(bin_count + 1, 0);
+		for (unsigned int i = 0; i < bin_count; i++) {
+			visible_prefix[i + 1] = visible_prefix[i] + this->BinVisible[i];
+		}
+
+		unsigned int changed_bricks = 0;
+		for (size_t b = 0; b < this->BrickBins.size(); b++) {
+			const glm::ivec2& bins = this->BrickBins[b];
+			if (bins.y < changed_first || bins.x > changed_last) {
+				continue;
+			}
+			uint8_t occupied = visible_prefix[bins.y + 1] - visible_prefix[bins.x] > 0 ? 1 : 0;
+			if (occupied != this->Occupied[b]) {
+				this->Occupied[b] = occupied;
+				changed_bricks++;
+			}
+		}
+		if (changed_bricks == 0 && !is_full_rebuild) {
+			return false;
+		}
+
+		this->OccupiedBrickCount = (unsigned int)std::count(this->Occupied.begin(), this->Occupied.end(), 1);
+		this->ComputeDistances();
+		Logger::Message(LOG_DEBUG, "Occupancy grid updated: " + std::to_string(changed_bricks) + " bricks changed, "
+			+ std::to_string(this->OccupiedBrickCount) + " / " + std::to_string(this->BrickBins.size()) + " bricks occupied.");
+		return true;
+	}
+
+	void OccupancyGrid::ComputeDistances() {
+		// Chebyshev 距離可以分成三個方向各做一次：先求 x 方向到最近被佔用 brick 的距離，
+		// 再沿 y、z 方向取 min(max(|dy|, d(y')))，每一次只看一條線。
+		const glm::ivec3 size = this->GridSize;
+		this->Distances.assign(this->Occupied.size(), (uint8_t)MaxDistance);
+		std::vector<int> distances(this->Occupied.size(), MaxDistance);
+		for (size_t i = 0; i < this->Occupied.size(); i++) {
+			distances[i] = this->Occupied[i] ? 0 : MaxDistance;
+		}
+
+		std::vector<int> line;
+		auto filter_line = [&](int count, auto index_of) {
+			line.resize(count);
+			for (int i = 0; i < count; i++) {
+				line[i] = distances[index_of(i)];
+			}
+			for (int i = 0; i < count; i++) {
+				int best = line[i];
+				for (int j = 0; j < count && best > 0; j++) {
+					best = std::min(best, std::max(std::abs(i - j), line[j]));
+				}
+				distances[index_of(i)] = std::min(best, MaxDistance);
+			}
+		};
+		for (int z = 0; z < size.z; z++) {
+			for (int y = 0; y < size.y; y++) {
+				filter_line(size.x, [&](int i) { return this->GetIndex(i, y, z); });
+			}
+		}
+		for (int z = 0; z < size.z; z++) {
+			for (int x = 0; x < size.x; x++) {
+				filter_line(size.y, [&](int i) { return this->GetIndex(x, i, z); });
+			}
+		}
+		for (int y = 0; y < size.y; y++) {
+			for (int x = 0; x < size.x; x++) {
+				filter_line(size.z, [&](int i) { return this->GetIndex(x, y, i); });
+			}
+		}
+
+		for (size_t i = 0; i < distances.size(); i++) {
+			this->Distances[i] = (uint8_t)distances[i];
+		}
+	}
+}
@@ -0,0 +1,246 @@
+#include "ProgressiveRenderer.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace Nexus {
+
+	namespace {
+		// Van der Corput 數列（以 2 為底），每一個累積的 frame 把光線起點放在上一層還沒取樣過的位置。
+		float GetRadicalInverse(unsigned int index) {
+			float result = 0.0f;
+			float base = 0.5f;
+			while (index > 0) {
+				if (index & 1) {
+					result += base;
+				}
+				index >>= 1;
+				base *= 0.5f;
+			}
+			return result;
+		}
+	}
+
+	ProgressiveRenderer::~ProgressiveRenderer() {
+		this->Release();
+	}
+
+	void ProgressiveRenderer::Update(const glm::mat4& model_view_projection) {
+		if (!this->HasLastMatrix || model_view_projection != this->LastMatrix) {
+			this->LastMatrix = model_view_projection;
+			this->HasLastMatrix = true;
+			this->StaticFrames = 0;
+			this->IsInteractive = true;
+			this->AccumulatedFrames = 0;
+			return;
+		}
+		this->StaticFrames++;
+		if (this->IsInteractive && this->StaticFrames >= this->Settings.SettleFrames) {
+			this->IsInteractive = false;
+			this->AccumulatedFrames = 0;
+		}
+	}
+
+	void ProgressiveRenderer::Invalidate() {
+		this->AccumulatedFrames = 0;
+	}
+
+	bool ProgressiveRenderer::BeginFrame() {
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &this->PreviousFramebuffer);
+		glGetIntegerv(GL_VIEWPORT, this->PreviousViewport);
+		this->Resize(glm::ivec2(this->PreviousViewport[2], this->PreviousViewport[3]));
+		this->PollTimerQuery();
+		this->IsRendering = false;
+		this->IsQueryRunning = false;
+		// 建立 offscreen target 失敗時直接畫在原本的 framebuffer 上，EndFrame 什麼都不做。
+		if (this->FrameTarget.Framebuffer == 0) {
+			this->RenderSize = glm::ivec2(this->PreviousViewport[2], this->PreviousViewport[3]);
+			this->RayOffset = 0.0f;
+			return true;
+		}
+
+		this->PreviousBlend = glIsEnabled(GL_BLEND);
+		this->PreviousDepthTest = glIsEnabled(GL_DEPTH_TEST);
+		glGetIntegerv(GL_BLEND_SRC_RGB, &this->PreviousBlendFunc[0]);
+		glGetIntegerv(GL_BLEND_DST_RGB, &this->PreviousBlendFunc[1]);
+		glGetIntegerv(GL_BLEND_SRC_ALPHA, &this->PreviousBlendFunc[2]);
+		glGetIntegerv(GL_BLEND_DST_ALPHA, &this->PreviousBlendFunc[3]);
+		if (this->GetIsConverged()) {
+			return false;
+		}
+
+		if (this->IsInteractive) {
+			this->Scale = glm::clamp(this->Scale, this->Settings.MinScale, std::max(this->Settings.MaxInteractiveScale, this->Settings.MinScale));
+			this->RenderSize = glm::max(glm::ivec2(glm::vec2(this->Size) * this->Scale + 0.5f), glm::ivec2(1));
+			this->RayOffset = 0.0f;
+		} else {
+			this->RenderSize = this->Size;
+			this->RayOffset = GetRadicalInverse((unsigned int)this->AccumulatedFrames);
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, this->FrameTarget.Framebuffer);
+		glViewport(0, 0, this->RenderSize.x, this->RenderSize.y);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glDisable(GL_DEPTH_TEST);
+		// 顏色照一般的 alpha blending，alpha 以 ONE 累加，清成 0 的 target 裡留下的就是 premultiplied 的結果。
+		glEnable(GL_BLEND);
+		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+		// 只量互動時的 pass，量到的時間對應到 QueryScale 這個解析度；上一個結果還沒拿到之前不開始新的 query。
+		if (this->IsInteractive && !this->IsQueryPending) {
+			if (this->TimerQuery == 0) {
+				glGenQueries(1, &this->TimerQuery);
+			}
+			glBeginQuery(GL_TIME_ELAPSED, this->TimerQuery);
+			this->QueryScale = this->Scale;
+			this->IsQueryPending = true;
+			this->IsQueryRunning = true;
+		}
+		this->IsRendering = true;
+		return true;
+	}
+
+	void ProgressiveRenderer::EndFrame(Nexus::Shader* composite_shader) {
+		if (this->FrameTarget.Framebuffer == 0) {
+			return;
+		}
+		if (this->IsQueryRunning) {
+			glEndQuery(GL_TIME_ELAPSED);
+			this->IsQueryRunning = false;
+		}
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+
+		if (this->IsRendering && !this->IsInteractive) {
+			// 第 n 個 frame 以 1 / n 的權重混合進去，累積的結果就是所有 frame 的平均；第一個 frame 的權重為 1，直接覆蓋舊的內容。
+			glBindFramebuffer(GL_FRAMEBUFFER, this->AccumulationTarget.Framebuffer);
+			glViewport(0, 0, this->Size.x, this->Size.y);
+			glBlendColor(0.0f, 0.0f, 0.0f, 1.0f / (this->AccumulatedFrames + 1));
+			glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+			this->Composite(composite_shader, this->FrameTarget.Texture, glm::vec2(1.0f));
+			this->AccumulatedFrames++;
+			if (this->AccumulatedFrames == this->Settings.AccumulationFrames) {
+				Logger::Message(LOG_DEBUG, "Progressive rendering converged after " + std::to_string(this->AccumulatedFrames) + " frames.");
+			}
+		}
+
+		// 兩個 target 都是 premultiplied，疊到原本的畫面上。
+		glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)this->PreviousFramebuffer);
+		glViewport(this->PreviousViewport[0], this->PreviousViewport[1], this->PreviousViewport[2], this->PreviousViewport[3]);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		if (this->IsInteractive) {
+			this->Composite(composite_shader, this->FrameTarget.Texture, glm::vec2(this->RenderSize) / glm::vec2(this->Size));
+		} else {
+			this->Composite(composite_shader, this->AccumulationTarget.Texture, glm::vec2(1.0f));
+		}
+
+		glBlendFuncSeparate(this->PreviousBlendFunc[0], this->PreviousBlendFunc[1], this->PreviousBlendFunc[2], this->PreviousBlendFunc[3]);
+		if (!this->PreviousBlend) {
+			glDisable(GL_BLEND);
+		}
+		if (this->PreviousDepthTest) {
+			glEnable(GL_DEPTH_TEST);
+		}
+		this->IsRendering = false;
+	}
+
+	void ProgressiveRenderer::Release() {
+		this->ReleaseTarget(this->FrameTarget);
+		this->ReleaseTarget(this->AccumulationTarget);
+		if (this->TimerQuery != 0) {
+			glDeleteQueries(1, &this->TimerQuery);
+			this->TimerQuery = 0;
+		}
+		this->IsQueryPending = false;
+		this->Quad.reset();
+		this->Size = glm::ivec2(0);
+		this->AccumulatedFrames = 0;
+	}
+
+	void ProgressiveRenderer::Resize(glm::ivec2 size) {
+		if (size == this->Size && this->FrameTarget.Framebuffer != 0) {
+			return;
+		}
+		this->ReleaseTarget(this->FrameTarget);
+		this->ReleaseTarget(this->AccumulationTarget);
+		this->Size = size;
+		this->AccumulatedFrames = 0;
+		if (size.x <= 0 || size.y <= 0) {
+			return;
+		}
+		if (!this->CreateTarget(this->FrameTarget, size) || !this->CreateTarget(this->AccumulationTarget, size)) {
+			Logger::Message(LOG_ERROR, "Failed to create the offscreen targets for progressive rendering.");
+			this->ReleaseTarget(this->FrameTarget);
+			this->ReleaseTarget(this->AccumulationTarget);
+			return;
+		}
+		if (!this->Quad) {
+			this->Quad = std::make_unique<NDCQuad>();
+		}
+	}
+
+	void ProgressiveRenderer::ReleaseTarget(RenderTarget& target) {
+		if (target.Framebuffer != 0) {
+			glDeleteFramebuffers(1, &target.Framebuffer);
+		}
+		if (target.Texture != 0) {
+			glDeleteTextures(1, &target.Texture);
+		}
+		target = RenderTarget();
+	}
+
+	bool ProgressiveRenderer::CreateTarget(RenderTarget& target, glm::ivec2 size) {
+		// RGBA16F：累積 16 個 frame 的平均時 8 bits 的精度不夠，會出現色階。
+		glGenTextures(1, &target.Texture);
+		glBindTexture(GL_TEXTURE_2D, target.Texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, size.x, size.y, 0, GL_RGBA, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		GLint previous_framebuffer = 0;
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+		glGenFramebuffers(1, &target.Framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.Texture, 0);
+		bool is_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+		glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previous_framebuffer);
+		return is_complete;
+	}
+
+	void ProgressiveRenderer::Composite(Nexus::Shader* composite_shader, GLuint texture, glm::vec2 texcoord_scale) {
+		composite_shader->Use();
+		composite_shader->SetInt("progressive_image", 0);
+		composite_shader->SetVec2("texcoord_scale", texcoord_scale);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		this->Quad->Draw(composite_shader);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void ProgressiveRenderer::PollTimerQuery() {
+		if (!this->IsQueryPending) {
+			return;
+		}
+		GLint is_available = 0;
+		glGetQueryObjectiv(this->TimerQuery, GL_QUERY_RESULT_AVAILABLE, &is_available);
+		if (!is_available) {
+			return;
+		}
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(this->TimerQuery, GL_QUERY_RESULT, &nanoseconds);
+		this->IsQueryPending = false;
+		this->LastPassMilliseconds = (float)(nanoseconds / 1.0e6);
+		if (this->LastPassMilliseconds <= 0.0f) {
+			return;
+		}
+		// 成本大約與像素數量（Scale 的平方）成正比；只往目標移動一半（開根號後再取幾何平均），避免來回震盪。
+		float target_scale = this->QueryScale * std::sqrt(this->Settings.TargetFrameMilliseconds / this->LastPassMilliseconds);
+		this->Scale = glm::clamp(std::sqrt(this->Scale * target_scale), this->Settings.MinScale, std::max(this->Settings.MaxInteractiveScale, this->Settings.MinScale));
+	}
+}
@@ -0,0 +1,300 @@
+#include "SoftwareRayCaster.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define NEXUS_RAYCAST_SSE
+#endif
+
+namespace Nexus {
+
+	SoftwareRayCaster::SoftwareRayCaster(const std::vector<float>& data, glm::ivec3 resolution, glm::vec3 ratio, float max_value, const SoftwareRayCasterSettings& settings)
+		: Data(data), Resolution(resolution), Ratio(ratio), Settings(settings) {
+		this->ValueScale = max_value > 0.0f ? 1.0f / max_value : 1.0f;
+	}
+
+	void SoftwareRayCaster::Render(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, int width, int height, std::vector<uint8_t>& image) {
+		image.assign(static_cast<size_t>(std::max(width, 0)) * std::max(height, 0) * 4, 0);
+		this->SampleCount = 0;
+		this->SkippedBrickCount = 0;
+		this->RenderSeconds = 0.0;
+		if (width <= 0 || height <= 0) {
+			return;
+		}
+		if (this->Resolution.x < 2 || this->Resolution.y < 2 || this->Resolution.z < 2 || this->Data.size() < static_cast<size_t>(this->Resolution.x) * this->Resolution.y * this->Resolution.z) {
+			Logger::Message(LOG_ERROR, "The software ray caster needs a volume with at least 2 voxels in every direction.");
+			return;
+		}
+		if (this->TransferFunction2DTable != nullptr && (this->GradientMagnitudes == nullptr || this->GradientMagnitudes->size() < this->Data.size())) {
+			Logger::Message(LOG_ERROR, "The 2D transfer function needs a gradient magnitude for every voxel.");
+			return;
+		}
+		if (this->Projection == INTENSITY_PROJECTION_NONE && this->TransferFunction.size() < 4 && (this->PreIntegration == nullptr || this->PreIntegration->IsEmpty()) && this->TransferFunction2DTable == nullptr) {
+			Logger::Message(LOG_WARNING, "The software ray caster has no transfer function, every sample is transparent.");
+		}
+
+		auto start = std::chrono::system_clock::now();
+
+		// 把 NDC 的點轉回 bounding box 的 model space，光線在 model space 中前進。
+		const glm::mat4 inverse = glm::inverse(projection * view * model);
+		const int tile_size = std::max(this->Settings.TileSize, 1);
+		const int tiles_x = (width + tile_size - 1) / tile_size;
+		const int tiles_y = (height + tile_size - 1) / tile_size;
+		std::atomic<uint64_t> total_samples(0);
+		std::atomic<uint64_t> total_skipped_bricks(0);
+
+		ThreadPool::GetInstance().ParallelFor(0, (unsigned int)(tiles_x * tiles_y), [&](unsigned int begin, unsigned int end) {
+			uint64_t samples = 0;
+			uint64_t skipped_bricks = 0;
+			for (unsigned int tile = begin; tile < end; tile++) {
+				int x0 = (int)(tile % tiles_x) * tile_size;
+				int y0 = (int)(tile / tiles_x) * tile_size;
+				for (int y = y0; y < std::min(y0 + tile_size, height); y++) {
+					for (int x = x0; x < std::min(x0 + tile_size, width); x++) {
+						glm::vec2 ndc((x + 0.5f) / width * 2.0f - 1.0f, (y + 0.5f) / height * 2.0f - 1.0f);
+						glm::vec4 near_point = inverse * glm::vec4(ndc.x, ndc.y, -1.0f, 1.0f);
+						glm::vec4 far_point = inverse * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+						glm::vec3 origin = glm::vec3(near_point) / near_point.w;
+						glm::vec3 direction = glm::normalize(glm::vec3(far_point) / far_point.w - origin);
+
+						glm::vec4 color = this->CastRay(origin, direction, samples, skipped_bricks);
+						// 前往後合成的結果是 premultiplied，剩下的穿透率給背景。
+						color += (1.0f - color.a) * glm::vec4(glm::vec3(this->Settings.Background) * this->Settings.Background.a, this->Settings.Background.a);
+
+						uint8_t* pixel = &image[(static_cast<size_t>(y) * width + x) * 4];
+						for (int c = 0; c < 4; c++) {
+							pixel[c] = static_cast<uint8_t>(glm::clamp(color[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+						}
+					}
+				}
+			}
+			total_samples += samples;
+			total_skipped_bricks += skipped_bricks;
+		}, 1);
+
+		this->SampleCount = total_samples.load();
+		this->SkippedBrickCount = total_skipped_bricks.load();
+		this->RenderSeconds = std::chrono::duration<double>(std::chrono::system_clock::now() - start).count();
+		Logger::Message(LOG_DEBUG, "Software ray casting completed. " + std::to_string(width) + "x" + std::to_string(height) + ", "
+			+ std::to_string(this->SampleCount) + " samples, " + (this->SkippedBrickCount > 0 ? std::to_string(this->SkippedBrickCount) + " bricks skipped, " : std::string()) + std::to_string(this->GetSamplesPerSecond() / 1.0e6) + " M samples / second.");
+	}
+
+	glm::vec4 SoftwareRayCaster::CastRay(glm::vec3 origin, glm::vec3 direction, uint64_t& samples, uint64_t& skipped_bricks) const {
+		// 與 bounding box 的交點（slab method）。
+		const glm::vec3 box_max = glm::vec3(this->Resolution) * this->Ratio;
+		glm::vec3 inverse_direction = 1.0f / direction;
+		glm::vec3 t0 = (glm::vec3(0.0f) - origin) * inverse_direction;
+		glm::vec3 t1 = (box_max - origin) * inverse_direction;
+		glm::vec3 t_min = glm::min(t0, t1);
+		glm::vec3 t_max = glm::max(t0, t1);
+		float t_enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+		float t_exit = std::min(std::min(t_max.x, t_max.y), t_max.z);
+		glm::vec4 color(0.0f);
+		if (!(t_enter < t_exit)) {
+			return color;
+		}
+		if (this->Projection != INTENSITY_PROJECTION_NONE) {
+			// 投影的結果是不透明的灰階，光線有穿過 volume 的像素都會蓋住背景。
+			return glm::vec4(glm::vec3(this->CastProjection(origin, direction, t_enter, t_exit, samples, skipped_bricks)), 1.0f);
+		}
+
+		// 不透明度以 1 個 voxel 的距離為基準，取樣間距不同時修正：alpha' = 1 - (1 - alpha)^step。
+		const bool is_2d = this->TransferFunction2DTable != nullptr;
+		const bool is_pre_integrated = !is_2d && this->PreIntegration != nullptr && !this->PreIntegration->IsEmpty();
+		const float voxel = std::min(std::min(this->Ratio.x, this->Ratio.y), this->Ratio.z);
+		const float step_size = is_pre_integrated ? this->PreIntegration->GetStepSize() : this->Settings.StepSize;
+		const float step = step_size * voxel;
+		const float opacity_exponent = step_size;
+		// 與 GL_LINEAR 的 3D texture 相同：texture 座標 tc 對應到 voxel 座標 tc * Resolution - 0.5。
+		const glm::vec3 to_voxel = glm::vec3(this->Resolution) / box_max;
+
+		if (is_pre_integrated) {
+			// 每一段以前後兩個樣本查表，表格中已經是這一段的 premultiplied 顏色與不透明度。
+			float front = this->Sample(this->Data.data(), (origin + t_enter * direction) * to_voxel - 0.5f) * this->ValueScale;
+			samples++;
+			for (float t = t_enter + step; t <= t_exit; t += step) {
+				float back = this->Sample(this->Data.data(), (origin + t * direction) * to_voxel - 0.5f) * this->ValueScale;
+				samples++;
+				glm::vec4 segment = this->PreIntegration->Lookup(front, back);
+				color += (1.0f - color.a) * segment;
+				if (color.a >= this->Settings.EarlyTermination) {
+					break;
+				}
+				front = back;
+			}
+			return color;
+		}
+
+		for (float t = t_enter + 0.5f * step; t < t_exit; t += step) {
+			glm::vec3 voxel = (origin + t * direction) * to_voxel - 0.5f;
+			float value = this->Sample(this->Data.data(), voxel) * this->ValueScale;
+			glm::vec4 sample = is_2d ? this->TransferFunction2DTable->Lookup(value, this->Sample(this->GradientMagnitudes->data(), voxel) * this->GradientScale) : this->Classify(value);
+			samples++;
+			if (sample.a <= 0.0f) {
+				continue;
+			}
+			float alpha = 1.0f - std::pow(1.0f - std::min(sample.a, 0.999999f), opacity_exponent);
+			color += (1.0f - color.a) * glm::vec4(glm::vec3(sample) * alpha, alpha);
+			if (color.a >= this->Settings.EarlyTermination) {
+				break;
+			}
+		}
+		return color;
+	}
+
+	float SoftwareRayCaster::CastProjection(glm::vec3 origin, glm::vec3 direction, float t_enter, float t_exit, uint64_t& samples, uint64_t& skipped_bricks) const {
+		const glm::vec3 box_max = glm::vec3(this->Resolution) * this->Ratio;
+		const float step = this->Settings.StepSize * std::min(std::min(this->Ratio.x, this->Ratio.y), this->Ratio.z);
+		// 取樣點的 voxel 座標是 t 的線性函數，穿過 brick 邊界的 t 可以直接算出來。
+		const glm::vec3 to_voxel = glm::vec3(this->Resolution) / box_max;
+		const glm::vec3 voxel_origin = origin * to_voxel - 0.5f;
+		const glm::vec3 voxel_direction = direction * to_voxel;
+		const float first = t_enter + 0.5f * step;
+		// 第 i 個樣本在 first + i * step，last 之前（不含）的樣本都在 volume 內。
+		const int last = std::max((int)std::ceil((t_exit - first) / step), 0);
+
+		const bool is_maximum = this->Projection == INTENSITY_PROJECTION_MAXIMUM;
+		const bool is_minimum = this->Projection == INTENSITY_PROJECTION_MINIMUM;
+		// 數值以最大值正規化，沒有 brick 資訊時最大值一定是 1，最小值則不知道。
+		const BrickRangeGrid* bricks = (is_maximum || is_minimum) && this->ProjectionBricks != nullptr && !this->ProjectionBricks->IsEmpty() ? this->ProjectionBricks : nullptr;
+		const glm::vec2 volume_range = bricks != nullptr ? bricks->GetVolumeRange() : glm::vec2(0.0f, 1.0f);
+
+		float result = is_maximum ? std::numeric_limits<float>::lowest() : (is_minimum ? std::numeric_limits<float>::max() : 0.0f);
+		// 取樣 [begin, end) 的樣本；結果已經不可能再改變（到達 limit）時回傳 false。
+		auto sample_range = [&](int begin, int end, float limit) {
+			for (int i = begin; i < end; i++) {
+				const float value = this->Sample(this->Data.data(), voxel_origin + (first + i * step) * voxel_direction) * this->ValueScale;
+				samples++;
+				if (is_maximum) {
+					result = std::max(result, value);
+					if (result >= limit) {
+						return false;
+					}
+				} else if (is_minimum) {
+					result = std::min(result, value);
+					if (result <= limit) {
+						return false;
+					}
+				} else {
+					result += value;
+				}
+			}
+			return true;
+		};
+
+		if (last == 0) {
+			return 0.0f;
+		}
+		if (bricks == nullptr) {
+			// 平均值需要每一個樣本，沒有 brick 資訊時也只能逐點取樣。
+			sample_range(0, last, is_maximum ? volume_range.y : volume_range.x);
+			return glm::clamp(this->Projection == INTENSITY_PROJECTION_AVERAGE ? result / last : result, 0.0f, 1.0f);
+		}
+
+		// 以 3D DDA 一個 brick 一個 brick 地前進，每個 brick 只查一次範圍。位於 volume 邊界的 brick 往外延伸到無限遠，
+		// 所以光線不會走出 grid。
+		const int brick_size = bricks->GetBrickSize();
+		const glm::ivec3 grid_size = bricks->GetGridSize();
+		glm::ivec3 brick = bricks->GetBrick(voxel_origin + first * voxel_direction);
+		glm::ivec3 brick_step(0);
+		glm::vec3 t_next(std::numeric_limits<float>::infinity());
+		glm::vec3 t_delta(0.0f);
+		for (int axis = 0; axis < 3; axis++) {
+			if (voxel_direction[axis] > 0.0f) {
+				brick_step[axis] = 1;
+				t_delta[axis] = brick_size / voxel_direction[axis];
+				if (brick[axis] < grid_size[axis] - 1) {
+					t_next[axis] = ((brick[axis] + 1) * brick_size - voxel_origin[axis]) / voxel_direction[axis];
+				}
+			} else if (voxel_direction[axis] < 0.0f) {
+				brick_step[axis] = -1;
+				t_delta[axis] = -brick_size / voxel_direction[axis];
+				if (brick[axis] > 0) {
+					t_next[axis] = (brick[axis] * brick_size - voxel_origin[axis]) / voxel_direction[axis];
+				}
+			}
+		}
+
+		int i = 0;
+		while (i < last) {
+			// 最後一個 brick 的出口是無限遠，以 t_exit 為上限，轉成 int 才不會溢位。
+			const float t_leave = std::min(std::min(std::min(t_next.x, t_next.y), t_next.z), t_exit);
+			const int end = std::min(std::max((int)std::ceil((t_leave - first) / step), i), last);
+			const glm::vec2 range = bricks->GetRange(bricks->GetBrickIndex(brick));
+			// Brick 的範圍已經不會改變結果時整個跳過；取樣到一半到達 brick 的上限（下限）時剩下的樣本也跳過。
+			const float brick_limit = is_maximum ? range.y : range.x;
+			if (is_maximum ? range.y <= result : range.x >= result) {
+				skipped_bricks++;
+			} else if (!sample_range(i, end, brick_limit)) {
+				if (result == (is_maximum ? volume_range.y : volume_range.x)) {
+					break;
+				}
+				skipped_bricks += end > i ? 1 : 0;
+			}
+			i = end;
+
+			const int axis = t_next.x <= t_next.y && t_next.x <= t_next.z ? 0 : (t_next.y <= t_next.z ? 1 : 2);
+			if (t_next[axis] == std::numeric_limits<float>::infinity()) {
+				break;
+			}
+			brick[axis] += brick_step[axis];
+			const bool is_boundary = brick_step[axis] > 0 ? brick[axis] == grid_size[axis] - 1 : brick[axis] == 0;
+			t_next[axis] = is_boundary ? std::numeric_limits<float>::infinity() : t_next[axis] + t_delta[axis];
+		}
+		return glm::clamp(result, 0.0f, 1.0f);
+	}
+
+	float SoftwareRayCaster::Sample(const float* data, glm::vec3 voxel) const {
+		// Clamp to edge：超出範圍的座標使用邊界的 voxel，基準點最多到倒數第二個 voxel，讓 +1 的鄰居一定存在。
+		voxel = glm::clamp(voxel, glm::vec3(0.0f), glm::vec3(this->Resolution - glm::ivec3(1)));
+		glm::ivec3 base = glm::min(glm::ivec3(voxel), this->Resolution - glm::ivec3(2));
+		glm::vec3 f = voxel - glm::vec3(base);
+
+		const size_t row = static_cast<size_t>(this->Resolution.x);
+		const size_t slice = row * this->Resolution.y;
+		const float* p = data + static_cast<size_t>(base.z) * slice + static_cast<size_t>(base.y) * row + base.x;
+#ifdef NEXUS_RAYCAST_SSE
+		// 兩次 64-bit 載入就能拿到同一個 z 平面的四個角：(x, y)、(x + 1, y)、(x, y + 1)、(x + 1, y + 1)。
+		__m128 low = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p)), reinterpret_cast<const __m64*>(p + row));
+		__m128 high = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p + slice)), reinterpret_cast<const __m64*>(p + slice + row));
+		__m128 z = _mm_add_ps(low, _mm_mul_ps(_mm_sub_ps(high, low), _mm_set1_ps(f.z)));
+		__m128 x0 = _mm_shuffle_ps(z, z, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 x1 = _mm_shuffle_ps(z, z, _MM_SHUFFLE(3, 1, 3, 1));
+		__m128 x = _mm_add_ps(x0, _mm_mul_ps(_mm_sub_ps(x1, x0), _mm_set1_ps(f.x)));
+		float y0 = _mm_cvtss_f32(x);
+		float y1 = _mm_cvtss_f32(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1)));
+		return y0 + (y1 - y0) * f.y;
+#else
+		float c00 = p[0] + (p[slice] - p[0]) * f.z;
+		float c10 = p[1] + (p[slice + 1] - p[1]) * f.z;
+		float c01 = p[row] + (p[slice + row] - p[row]) * f.z;
+		float c11 = p[row + 1] + (p[slice + row + 1] - p[row + 1]) * f.z;
+		float y0 = c00 + (c10 - c00) * f.x;
+		float y1 = c01 + (c11 - c01) * f.x;
+		return y0 + (y1 - y0) * f.y;
+#endif
+	}
+
+	glm::vec4 SoftwareRayCaster::Classify(float value) const {
+		// 與 1D texture 的 GL_LINEAR 相同：數值 v 落在 bin v * N - 0.5，兩端 clamp。
+		const int bin_count = (int)(this->TransferFunction.size() / 4);
+		if (bin_count == 0) {
+			return glm::vec4(0.0f);
+		}
+		float position = glm::clamp(value * bin_count - 0.5f, 0.0f, (float)(bin_count - 1));
+		int bin = std::min((int)position, bin_count - 1);
+		int next = std::min(bin + 1, bin_count - 1);
+		float f = position - bin;
+		const float* a = &this->TransferFunction[static_cast<size_t>(bin) * 4];
+		const float* b = &this->TransferFunction[static_cast<size_t>(next) * 4];
+		return glm::vec4(a[0], a[1], a[2], a[3]) * (1.0f - f) + glm::vec4(b[0], b[1], b[2], b[3]) * f;
+	}
+}
@@ -0,0 +1,107 @@
+#include "SpanSpaceIndex.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <string>
+
+namespace Nexus {
+
+	void SpanSpaceIndex::Build(const MinMaxOctree& octree) {
+		std::vector<SpanInterval> intervals;
+		intervals.reserve(octree.GetBrickCount());
+		for (unsigned int i = 0; i < octree.GetBrickCount(); i++) {
+			const VolumeBrick& brick = octree.GetBrick(i);
+			intervals.push_back({ brick.Min, brick.Max, i });
+		}
+		this->Build(std::move(intervals));
+	}
+
+	void SpanSpaceIndex::Build(std::vector<SpanInterval> intervals) {
+		this->Clear();
+
+		// Min == Max 的區間（完全均勻的 brick）不可能跨越任何 iso value，不需要放進索引。
+		intervals.erase(std::remove_if(intervals.begin(), intervals.end(), [](const SpanInterval& interval) {
+			return !(interval.Min < interval.Max);
+		}), intervals.end());
+
+		this->ByMin.reserve(intervals.size());
+		this->ByMax.reserve(intervals.size());
+		this->BuildNode(intervals);
+
+		Logger::Message(LOG_DEBUG, "Span-space index built: " + std::to_string(this->ByMin.size()) + " intervals, " + std::to_string(this->Nodes.size()) + " nodes.");
+	}
+
+	void SpanSpaceIndex::Clear() {
+		this->Nodes.clear();
+		this->ByMin.clear();
+		this->ByMax.clear();
+	}
+
+	int SpanSpaceIndex::BuildNode(std::vector<SpanInterval>& intervals) {
+		if (intervals.empty()) {
+			return -1;
+		}
+
+		// 以所有區間中點的中位數作為分割點。中點必須落在 [Min, Max) 內，這個區間才會留在此節點，遞迴一定會結束；
+		// Min 與 Max 是相鄰的 float 時中點可能捨入成 Max，這時改用 Min。
+		std::vector<float> centers(intervals.size());
+		for (size_t i = 0; i < intervals.size(); i++) {
+			float center = intervals[i].Min + (intervals[i].Max - intervals[i].Min) * 0.5f;
+			centers[i] = center < intervals[i].Max ? center : intervals[i].Min;
+		}
+		std::nth_element(centers.begin(), centers.begin() + centers.size() / 2, centers.end());
+		float center = centers[centers.size() / 2];
+
+		std::vector<SpanInterval> left, right, overlap;
+		for (const SpanInterval& interval : intervals) {
+			if (interval.Max <= center) {
+				left.push_back(interval);
+			} else if (interval.Min > center) {
+				right.push_back(interval);
+			} else {
+				overlap.push_back(interval);
+			}
+		}
+		intervals.clear();
+		intervals.shrink_to_fit();
+
+		int index = (int)this->Nodes.size();
+		this->Nodes.push_back(Node());
+		this->Nodes[index].Center = center;
+		this->Nodes[index].First = (unsigned int)this->ByMin.size();
+		this->Nodes[index].Count = (unsigned int)overlap.size();
+
+		// 跨越中心的區間分別依照 Min 遞增、Max 遞減排序，查詢時只需要掃到第一個不符合的區間就能停止。
+		std::sort(overlap.begin(), overlap.end(), [](const SpanInterval& a, const SpanInterval& b) { return a.Min < b.Min; });
+		this->ByMin.insert(this->ByMin.end(), overlap.begin(), overlap.end());
+		std::sort(overlap.begin(), overlap.end(), [](const SpanInterval& a, const SpanInterval& b) { return a.Max > b.Max; });
+		this->ByMax.insert(this->ByMax.end(), overlap.begin(), overlap.end());
+
+		int left_index = this->BuildNode(left);
+		int right_index = this->BuildNode(right);
+		this->Nodes[index].Left = left_index;
+		this->Nodes[index].Right = right_index;
+
+		return index;
+	}
+
+	void SpanSpaceIndex::Query(float iso_value, std::vector<unsigned int>& result) const {
+		result.clear();
+
+		int node_index = this->Nodes.empty() ? -1 : 0;
+		while (node_index != -1) {
+			const Node& node = this->Nodes[node_index];
+			if (iso_value < node.Center) {
+				for (unsigned int i = node.First; i < node.First + node.Count && this->ByMin[i].Min <= iso_value; i++) {
+					result.push_back(this->ByMin[i].ID);
+				}
+				node_index = node.Left;
+			} else {
+				for (unsigned int i = node.First; i < node.First + node.Count && this->ByMax[i].Max > iso_value; i++) {
+					result.push_back(this->ByMax[i].ID);
+				}
+				node_index = node.Right;
+			}
+		}
+	}
+}
@@ -0,0 +1,226 @@
+#include "SurfaceNets.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Nexus {
+
+	namespace {
+		// 與 MarchingCubesTable 相同的角點順序與邊的定義。
+		const glm::ivec3 CornerOffsets[8] = {
+			glm::ivec3(0, 0, 0), glm::ivec3(1, 0, 0), glm::ivec3(1, 0, 1), glm::ivec3(0, 0, 1),
+			glm::ivec3(0, 1, 0), glm::ivec3(1, 1, 0), glm::ivec3(1, 1, 1), glm::ivec3(0, 1, 1)
+		};
+
+		const int EdgeCorners[12][2] = {
+			{ 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+			{ 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 },
+			{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+		};
+
+		unsigned int CountBits(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+			return (unsigned int)__builtin_popcountll(bits);
+#else
+			bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+			bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+			bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+			return (unsigned int)((bits * 0x0101010101010101ull) >> 56);
+#endif
+		}
+
+		void WriteQuad(unsigned int* indices, unsigned int a, unsigned int b, unsigned int c, unsigned int d, bool flip) {
+			if (flip) {
+				std::swap(b, d);
+			}
+			indices[0] = a;
+			indices[1] = b;
+			indices[2] = c;
+			indices[3] = a;
+			indices[4] = c;
+			indices[5] = d;
+		}
+	}
+
+	SurfaceNets::SurfaceNets(const std::vector<float>& data, const std::vector<glm::vec3>& normals, glm::ivec3 resolution, glm::vec3 ratio)
+		: Data(data), Normals(normals), Resolution(resolution), Ratio(ratio), Size(resolution) {
+	}
+
+	void SurfaceNets::SetRegion(glm::ivec3 voxel_min, glm::ivec3 voxel_max) {
+		this->Origin = glm::clamp(voxel_min, glm::ivec3(0), this->Resolution - glm::ivec3(1));
+		voxel_max = glm::clamp(voxel_max, glm::ivec3(0), this->Resolution - glm::ivec3(1));
+		this->Size = glm::max(voxel_max - this->Origin + glm::ivec3(1), glm::ivec3(0));
+	}
+
+	void SurfaceNets::Extract(float iso_value, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+		vertices.clear();
+		indices.clear();
+
+		const glm::ivec3 cells = this->Size - glm::ivec3(1);
+		if (cells.x < 1 || cells.y < 1 || cells.z < 1) {
+			return;
+		}
+
+		this->IsoValue = iso_value;
+		this->Classifier.Classify(this->Data, this->Resolution, this->Origin, this->Origin + cells, iso_value);
+		this->WordsPerRow = (unsigned int)(cells.x + 63) / 64;
+		this->ActiveCells.assign(static_cast<size_t>(cells.y) * cells.z * this->WordsPerRow, 0ull);
+		this->CellRows.assign(static_cast<size_t>(cells.y) * cells.z, CellRowMeta());
+
+		ThreadPool& pool = ThreadPool::GetInstance();
+
+		// Pass 1: 由 sign bitmask 組出每一列 cell 的 cube index，記錄跨越 iso value 的 cell，並計算頂點與四邊形的數量。
+		pool.ParallelFor(0, cells.z, [this, cells](unsigned int begin, unsigned int end) {
+			std::vector<uint8_t> cube_indices(cells.x);
+			for (unsigned int k = begin; k < end; k++) {
+				if (!this->Classifier.IsSliceActive((int)k)) {
+					continue;
+				}
+				for (int j = 0; j < cells.y; j++) {
+					this->CountCellRow(j, k, cube_indices.data());
+				}
+			}
+		});
+
+		// Pass 2: 前綴和，得到每一列的頂點與四邊形在輸出陣列中的起始位置。
+		unsigned int vertex_count = 0;
+		unsigned int quad_count = 0;
+		for (CellRowMeta& cell_row : this->CellRows) {
+			cell_row.VertexOffset = vertex_count;
+			cell_row.QuadOffset = quad_count;
+			vertex_count += cell_row.Vertices;
+			quad_count += cell_row.Quads;
+		}
+		vertices.resize(static_cast<size_t>(vertex_count) * 6);
+		indices.resize(static_cast<size_t>(quad_count) * 6);
+
+		// Pass 3: 各列直接把頂點與四邊形寫進自己的範圍，鄰居 cell 的頂點編號由 pass 1 的 bitmask 算出來，不需要同步。
+		float* vertex_data = vertices.data();
+		unsigned int* index_data = indices.data();
+		pool.ParallelFor(0, cells.z, [this, cells, vertex_data, index_data](unsigned int begin, unsigned int end) {
+			std::vector<uint8_t> cube_indices(cells.x);
+			for (unsigned int k = begin; k < end; k++) {
+				for (int j = 0; j < cells.y; j++) {
+					this->GenerateCellRow(j, k, cube_indices.data(), vertex_data, index_data);
+				}
+			}
+		});
+
+		this->ActiveCells.clear();
+		this->ActiveCells.shrink_to_fit();
+	}
+
+	void SurfaceNets::CountCellRow(int y, int z, uint8_t* cube_indices) {
+		if (!this->Classifier.GetCubeIndices(y, z, cube_indices)) {
+			return;
+		}
+
+		// 每個 cell 負責從它的 v0 角出發的三條邊（+x、+y、+z），圍繞這條邊的另外三個 cell 都在範圍內時才輸出四邊形。
+		CellRowMeta& meta = this->CellRows[this->GetCellRowIndex(y, z)];
+		uint64_t* active = &this->ActiveCells[static_cast<size_t>(this->GetCellRowIndex(y, z)) * this->WordsPerRow];
+		const bool has_z_edges = z > 0 || !this->SharedFirstSlice;
+		for (int x = 0; x < this->Size.x - 1; x++) {
+			uint8_t cube_index = cube_indices[x];
+			if (cube_index == 0 || cube_index == 255) {
+				continue;
+			}
+			active[x >> 6] |= 1ull << (x & 63);
+			meta.Vertices++;
+			meta.Quads += this->HasQuad(cube_index, 1, y > 0 && z > 0) + this->HasQuad(cube_index, 4, x > 0 && z > 0) + this->HasQuad(cube_index, 3, x > 0 && y > 0 && has_z_edges);
+		}
+	}
+
+	void SurfaceNets::GenerateCellRow(int y, int z, uint8_t* cube_indices, float* vertices, unsigned int* indices) const {
+		const CellRowMeta& meta = this->CellRows[this->GetCellRowIndex(y, z)];
+		if (meta.Vertices == 0) {
+			return;
+		}
+		this->Classifier.GetCubeIndices(y, z, cube_indices);
+
+		// 三角形的繞向朝向數值較低的一側（與 marching cubes 相同）：v0 在 iso value 以上時，四邊形朝向邊的正方向。
+		unsigned int vertex = meta.VertexOffset;
+		unsigned int* quad = indices + static_cast<size_t>(meta.QuadOffset) * 6;
+		const bool has_z_edges = z > 0 || !this->SharedFirstSlice;
+		for (int x = 0; x < this->Size.x - 1; x++) {
+			uint8_t cube_index = cube_indices[x];
+			if (cube_index == 0 || cube_index == 255) {
+				continue;
+			}
+			this->GenerateVertex(glm::ivec3(x, y, z), cube_index, vertices + static_cast<size_t>(vertex) * 6);
+			vertex++;
+
+			const bool flip = (cube_index & 1) == 0;
+			if (this->HasQuad(cube_index, 1, y > 0 && z > 0)) {
+				WriteQuad(quad, this->GetVertexIndex(x, y - 1, z - 1), this->GetVertexIndex(x, y, z - 1), this->GetVertexIndex(x, y, z), this->GetVertexIndex(x, y - 1, z), flip);
+				quad += 6;
+			}
+			if (this->HasQuad(cube_index, 4, x > 0 && z > 0)) {
+				WriteQuad(quad, this->GetVertexIndex(x - 1, y, z - 1), this->GetVertexIndex(x - 1, y, z), this->GetVertexIndex(x, y, z), this->GetVertexIndex(x, y, z - 1), flip);
+				quad += 6;
+			}
+			if (this->HasQuad(cube_index, 3, x > 0 && y > 0 && has_z_edges)) {
+				WriteQuad(quad, this->GetVertexIndex(x - 1, y - 1, z), this->GetVertexIndex(x, y - 1, z), this->GetVertexIndex(x, y, z), this->GetVertexIndex(x - 1, y, z), flip);
+				quad += 6;
+			}
+		}
+	}
+
+	unsigned int SurfaceNets::GetVertexIndex(int x, int y, int z) const {
+		// 頂點編號 = 該列的起始位置 + 這個 cell 之前有幾個跨越 iso value 的 cell。
+		unsigned int row = this->GetCellRowIndex(y, z);
+		const uint64_t* active = &this->ActiveCells[static_cast<size_t>(row) * this->WordsPerRow];
+		unsigned int rank = 0;
+		for (int w = 0; w < (x >> 6); w++) {
+			rank += CountBits(active[w]);
+		}
+		rank += CountBits(active[x >> 6] & ((1ull << (x & 63)) - 1));
+		return this->CellRows[row].VertexOffset + rank;
+	}
+
+	void SurfaceNets::GenerateVertex(glm::ivec3 cell, uint8_t cube_index, float* vertex) const {
+		// 頂點放在 cell 所有相交邊的交點平均，法向量同樣取平均；交點的內插方式與 FlyingEdges::GeneratePoint 相同。
+		glm::vec3 position(0.0f);
+		glm::vec3 normal(0.0f);
+		int count = 0;
+		for (int edge = 0; edge < 12; edge++) {
+			int corner_a = EdgeCorners[edge][0];
+			int corner_b = EdgeCorners[edge][1];
+			if (((cube_index >> corner_a) & 1) == ((cube_index >> corner_b) & 1)) {
+				continue;
+			}
+			glm::ivec3 a = cell + CornerOffsets[corner_a];
+			glm::ivec3 b = cell + CornerOffsets[corner_b];
+			if (b.x + b.y + b.z < a.x + a.y + a.z) {
+				std::swap(a, b);
+			}
+			size_t index_a = this->GetVoxelIndex(a);
+			size_t index_b = this->GetVoxelIndex(b);
+			float value_a = this->Data[index_a];
+			float value_b = this->Data[index_b];
+
+			float proportion = 0.0f;
+			if (std::abs(this->IsoValue - value_a) < 0.00001f) {
+				proportion = 0.0f;
+			} else if (std::abs(this->IsoValue - value_b) < 0.00001f) {
+				proportion = 1.0f;
+			} else if (std::abs(value_a - value_b) >= 0.00001f) {
+				proportion = (this->IsoValue - value_a) / (value_b - value_a);
+			}
+			position += glm::vec3(a) + proportion * glm::vec3(b - a);
+			normal += this->Normals[index_a] + proportion * (this->Normals[index_b] - this->Normals[index_a]);
+			count++;
+		}
+
+		position = (position / (float)count + glm::vec3(this->Origin)) * this->Ratio;
+		float length = glm::length(normal);
+		normal = length > 0.0f ? normal / length : glm::vec3(0.0f);
+
+		vertex[0] = position.x;
+		vertex[1] = position.y;
+		vertex[2] = position.z;
+		vertex[3] = normal.x;
+		vertex[4] = normal.y;
+		vertex[5] = normal.z;
+	}
+}
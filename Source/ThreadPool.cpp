@@ -0,0 +1,101 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Nexus {
+
+	ThreadPool::ThreadPool(unsigned int thread_count) {
+		thread_count = std::max(thread_count, 1u);
+		for (unsigned int i = 0; i < thread_count; i++) {
+			this->Workers.emplace_back([this]() {
+				while (true) {
+					std::function<void()> task;
+					{
+						std::unique_lock<std::mutex> lock(this->QueueMutex);
+						this->Condition.wait(lock, [this]() { return this->IsStopping || !this->Tasks.empty(); });
+						if (this->IsStopping && this->Tasks.empty()) {
+							return;
+						}
+						task = std::move(this->Tasks.front());
+						this->Tasks.pop();
+					}
+					task();
+				}
+			});
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::unique_lock<std::mutex> lock(this->QueueMutex);
+			this->IsStopping = true;
+		}
+		this->Condition.notify_all();
+		for (std::thread& worker : this->Workers) {
+			worker.join();
+		}
+	}
+
+	ThreadPool& ThreadPool::GetInstance() {
+		static ThreadPool instance;
+		return instance;
+	}
+
+	void ThreadPool::ParallelFor(unsigned int begin, unsigned int end, const std::function<void(unsigned int, unsigned int)>& body, unsigned int grain_size) {
+		if (begin >= end) {
+			return;
+		}
+
+		// 每個執行緒大約分到 4 個 chunk，讓負載不均的工作（例如每個 brick 的三角形數量不同）也能平衡。
+		unsigned int total = end - begin;
+		unsigned int chunk_size = std::max(std::max(grain_size, 1u), total / (this->GetThreadCount() * 4) + 1);
+		unsigned int chunk_count = (total + chunk_size - 1) / chunk_size;
+		if (chunk_count == 1) {
+			body(begin, end);
+			return;
+		}
+
+		struct SharedState {
+			std::atomic<unsigned int> NextChunk{ 0 };
+			std::atomic<unsigned int> FinishedChunks{ 0 };
+			std::mutex Mutex;
+			std::condition_variable Finished;
+			std::exception_ptr Exception;
+		};
+		auto state = std::make_shared<SharedState>();
+
+		auto run_chunks = [state, begin, end, chunk_size, chunk_count, &body]() {
+			unsigned int chunk;
+			while ((chunk = state->NextChunk.fetch_add(1)) < chunk_count) {
+				unsigned int chunk_begin = begin + chunk * chunk_size;
+				unsigned int chunk_end = std::min(end, chunk_begin + chunk_size);
+				try {
+					body(chunk_begin, chunk_end);
+				} catch (...) {
+					std::unique_lock<std::mutex> lock(state->Mutex);
+					if (!state->Exception) {
+						state->Exception = std::current_exception();
+					}
+				}
+				if (state->FinishedChunks.fetch_add(1) + 1 == chunk_count) {
+					std::unique_lock<std::mutex> lock(state->Mutex);
+					state->Finished.notify_all();
+				}
+			}
+		};
+
+		// 工作執行緒開始時 chunk 可能已經被領完，這時只會直接返回，不會再碰到 body。
+		unsigned int helper_count = std::min(this->GetThreadCount(), chunk_count - 1);
+		for (unsigned int i = 0; i < helper_count; i++) {
+			this->Enqueue(run_chunks);
+		}
+		run_chunks();
+
+		std::unique_lock<std::mutex> lock(state->Mutex);
+		state->Finished.wait(lock, [&state, chunk_count]() { return state->FinishedChunks.load() == chunk_count; });
+		if (state->Exception) {
+			std::rethrow_exception(state->Exception);
+		}
+	}
+}
@@ -0,0 +1,136 @@
+#include "TransferFunction2D.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace Nexus {
+
+	unsigned int TransferFunction2D::AddRegion(const TransferFunction2DRegion& region) {
+		this->Regions.push_back(region);
+		this->IsDirty = true;
+		return (unsigned int)this->Regions.size() - 1;
+	}
+
+	void TransferFunction2D::SetRegion(unsigned int index, const TransferFunction2DRegion& region) {
+		if (index >= this->Regions.size()) {
+			Logger::Message(LOG_WARNING, "Transfer function region " + std::to_string(index) + " does not exist.");
+			return;
+		}
+		this->Regions[index] = region;
+		this->IsDirty = true;
+	}
+
+	void TransferFunction2D::RemoveRegion(unsigned int index) {
+		if (index >= this->Regions.size()) {
+			Logger::Message(LOG_WARNING, "Transfer function region " + std::to_string(index) + " does not exist.");
+			return;
+		}
+		this->Regions.erase(this->Regions.begin() + index);
+		this->IsDirty = true;
+	}
+
+	void TransferFunction2D::ClearRegions() {
+		this->Regions.clear();
+		this->IsDirty = true;
+	}
+
+	bool TransferFunction2D::Update() {
+		if (!this->IsDirty) {
+			return false;
+		}
+		this->IsDirty = false;
+
+		const int size = this->Size;
+		this->Table.assign(static_cast<size_t>(size) * size, glm::vec4(0.0f));
+		// 每個 texel 取中心點，後面的 region 疊在前面的上面（over）。
+		ThreadPool::GetInstance().ParallelFor(0, (unsigned int)size, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int y = begin; y < end; y++) {
+				for (int x = 0; x < size; x++) {
+					glm::vec2 point((x + 0.5f) / size, (y + 0.5f) / size);
+					glm::vec3 color(0.0f);
+					float alpha = 0.0f;
+					for (const TransferFunction2DRegion& region : this->Regions) {
+						float a = region.Color.a * GetCoverage(region, point);
+						if (a <= 0.0f) {
+							continue;
+						}
+						color = color * (1.0f - a) + glm::vec3(region.Color) * a;
+						alpha = alpha * (1.0f - a) + a;
+					}
+					// 表格與 1D transfer function 相同，存的是沒有乘上 alpha 的顏色。
+					this->Table[static_cast<size_t>(y) * size + x] = alpha > 0.0f ? glm::vec4(color / alpha, alpha) : glm::vec4(0.0f);
+				}
+			}
+		}, 8);
+
+		this->ValueProjection.assign(static_cast<size_t>(size) * 4, 0.0f);
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				const glm::vec4& texel = this->Table[static_cast<size_t>(y) * size + x];
+				float* projection = &this->ValueProjection[static_cast<size_t>(x) * 4];
+				if (texel.a > projection[3]) {
+					projection[0] = texel.r;
+					projection[1] = texel.g;
+					projection[2] = texel.b;
+					projection[3] = texel.a;
+				}
+			}
+		}
+		Logger::Message(LOG_DEBUG, "2D transfer function updated: " + std::to_string(this->Regions.size()) + " regions, " + std::to_string(size) + "x" + std::to_string(size) + ".");
+		return true;
+	}
+
+	glm::vec4 TransferFunction2D::Lookup(float value, float gradient) const {
+		if (this->Table.empty()) {
+			return glm::vec4(0.0f);
+		}
+		const int size = this->Size;
+		float x = glm::clamp(value * size - 0.5f, 0.0f, (float)(size - 1));
+		float y = glm::clamp(gradient * size - 0.5f, 0.0f, (float)(size - 1));
+		int x0 = std::min((int)x, size - 1);
+		int y0 = std::min((int)y, size - 1);
+		int x1 = std::min(x0 + 1, size - 1);
+		int y1 = std::min(y0 + 1, size - 1);
+		float fx = x - x0;
+		float fy = y - y0;
+		const glm::vec4* row0 = &this->Table[static_cast<size_t>(y0) * size];
+		const glm::vec4* row1 = &this->Table[static_cast<size_t>(y1) * size];
+		glm::vec4 a = row0[x0] + (row0[x1] - row0[x0]) * fx;
+		glm::vec4 b = row1[x0] + (row1[x1] - row1[x0]) * fx;
+		return a + (b - a) * fy;
+	}
+
+	float TransferFunction2D::GetCoverage(const TransferFunction2DRegion& region, glm::vec2 point) {
+		// distance 是正規化的距離：1 在區域的邊界上，區域內小於 1。
+		const glm::vec2 extent = glm::max(region.Extent, glm::vec2(0.000001f));
+		const glm::vec2 offset = point - region.Center;
+		float distance = 0.0f;
+		switch (region.Shape) {
+		case TRANSFER_FUNCTION_2D_SHAPE_ELLIPSE:
+			distance = std::sqrt((offset.x / extent.x) * (offset.x / extent.x) + (offset.y / extent.y) * (offset.y / extent.y));
+			break;
+		case TRANSFER_FUNCTION_2D_SHAPE_TRIANGLE: {
+			// t = 0 在頂點（Center.y - Extent.y），t = 1 在底邊；高度 t 處的半寬是 Extent.x * t。
+			float t = (offset.y + extent.y) / (2.0f * extent.y);
+			if (t <= 0.0f) {
+				return 0.0f;
+			}
+			distance = std::max(std::abs(offset.x) / (extent.x * t), std::abs(offset.y) / extent.y);
+			break;
+		}
+		default:
+			distance = std::max(std::abs(offset.x) / extent.x, std::abs(offset.y) / extent.y);
+			break;
+		}
+		if (distance >= 1.0f) {
+			return 0.0f;
+		}
+		if (region.Softness <= 0.0f) {
+			return 1.0f;
+		}
+		return glm::clamp((1.0f - distance) / region.Softness, 0.0f, 1.0f);
+	}
+}
@@ -0,0 +1,118 @@
+#include "VolumeSlicer.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Nexus {
+
+	void VolumeSlicer::SetVolume(const std::vector<float>* data, glm::ivec3 resolution, float value_max) {
+		this->Clear();
+		if (data == nullptr || data->size() < static_cast<size_t>(resolution.x) * resolution.y * resolution.z) {
+			Logger::Message(LOG_ERROR, "The volume slicer needs a value for every voxel.");
+			return;
+		}
+		this->Data = data;
+		this->Resolution = resolution;
+		this->ValueMax = value_max;
+	}
+
+	void VolumeSlicer::Clear() {
+		this->Data = nullptr;
+		this->Resolution = glm::ivec3(0);
+		this->ValueMax = 0.0f;
+		this->Slab.clear();
+		this->Slab.shrink_to_fit();
+		this->SlabBegin = -1;
+	}
+
+	glm::ivec2 VolumeSlicer::GetSliceSize(glm::ivec3 resolution, int axis) {
+		if (axis == SLICE_AXIS_X) {
+			return glm::ivec2(resolution.y, resolution.z);
+		} else if (axis == SLICE_AXIS_Y) {
+			return glm::ivec2(resolution.x, resolution.z);
+		}
+		return glm::ivec2(resolution.x, resolution.y);
+	}
+
+	bool VolumeSlicer::Extract(int axis, int index, const SliceWindowLevel& window_level, std::vector<uint8_t>& slice) {
+		if (this->Data == nullptr || axis < SLICE_AXIS_X || axis > SLICE_AXIS_Z || this->Resolution[axis] <= 0) {
+			slice.clear();
+			return false;
+		}
+		auto start = std::chrono::system_clock::now();
+
+		index = glm::clamp(index, 0, this->Resolution[axis] - 1);
+		const glm::ivec2 size = this->GetSliceSize(axis);
+		slice.resize(static_cast<size_t>(size.x) * size.y);
+
+		// byte = (value - low) * scale，window 為 0 時整張只有黑白兩色。
+		float low = 0.0f;
+		float scale = this->ValueMax > 0.0f ? 255.0f / this->ValueMax : 0.0f;
+		if (window_level.Enable) {
+			low = window_level.Level - 0.5f * window_level.Window;
+			scale = window_level.Window > 0.0f ? 255.0f / window_level.Window : 1.0e30f;
+		}
+		auto map_row = [low, scale](const float* values, uint8_t* bytes, int count) {
+			for (int i = 0; i < count; i++) {
+				bytes[i] = static_cast<uint8_t>(glm::clamp((values[i] - low) * scale + 0.5f, 0.0f, 255.0f));
+			}
+		};
+
+		const float* data = this->Data->data();
+		const size_t row_stride = static_cast<size_t>(this->Resolution.x);
+		const size_t plane_stride = row_stride * this->Resolution.y;
+		const unsigned int grain = std::max(1, 4096 / std::max(size.x, 1));
+		if (axis == SLICE_AXIS_X) {
+			// 每張 x slice 在 slab 中已經是連續的 (y, z) 平面。
+			if (this->SlabBegin < 0 || index < this->SlabBegin || index >= this->SlabBegin + SlabWidth) {
+				this->FillSlab(index - index % SlabWidth);
+			} else {
+				this->SlabHitCount++;
+			}
+			const float* plane = this->Slab.data() + static_cast<size_t>(index - this->SlabBegin) * size.x * size.y;
+			ThreadPool::GetInstance().ParallelFor(0, (unsigned int)size.y, [&](unsigned int begin, unsigned int end) {
+				for (unsigned int v = begin; v < end; v++) {
+					map_row(plane + static_cast<size_t>(v) * size.x, slice.data() + static_cast<size_t>(v) * size.x, size.x);
+				}
+			}, grain);
+		} else {
+			// y slice 的每一列（固定 z）與 z slice 的每一列（固定 y）在 volume 中都是連續的 x。
+			ThreadPool::GetInstance().ParallelFor(0, (unsigned int)size.y, [&](unsigned int begin, unsigned int end) {
+				for (unsigned int v = begin; v < end; v++) {
+					const float* row = axis == SLICE_AXIS_Y ? data + v * plane_stride + index * row_stride : data + static_cast<size_t>(index) * plane_stride + v * row_stride;
+					map_row(row, slice.data() + static_cast<size_t>(v) * size.x, size.x);
+				}
+			}, grain);
+		}
+
+		this->ExtractSeconds = std::chrono::duration<double>(std::chrono::system_clock::now() - start).count();
+		return true;
+	}
+
+	void VolumeSlicer::FillSlab(int x_begin) {
+		const int width = std::min(SlabWidth, this->Resolution.x - x_begin);
+		const size_t plane_size = static_cast<size_t>(this->Resolution.y) * this->Resolution.z;
+		this->Slab.resize(plane_size * SlabWidth);
+		this->SlabBegin = x_begin;
+		this->SlabFillCount++;
+
+		// 每個 (y, z) 讀一次 cache line 上連續的 width 個數值，分別寫到 width 張 slice 的同一個位置。
+		const float* data = this->Data->data();
+		const size_t row_stride = static_cast<size_t>(this->Resolution.x);
+		const size_t plane_stride = row_stride * this->Resolution.y;
+		const int size_y = this->Resolution.y;
+		ThreadPool::GetInstance().ParallelFor(0, (unsigned int)this->Resolution.z, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int z = begin; z < end; z++) {
+				for (int y = 0; y < size_y; y++) {
+					const float* row = data + z * plane_stride + y * row_stride + x_begin;
+					float* target = this->Slab.data() + static_cast<size_t>(z) * size_y + y;
+					for (int k = 0; k < width; k++) {
+						target[k * plane_size] = row[k];
+					}
+				}
+			}
+		}, 1);
+	}
+}
@@ -0,0 +1,227 @@
+#include "VolumeTextureStreamer.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <string>
+
+namespace Nexus {
+
+	VolumeTextureStreamer::~VolumeTextureStreamer() {
+		this->Release();
+	}
+
+	void VolumeTextureStreamer::Start(glm::ivec3 volume_size, const std::vector<VolumeStreamChannel>& channels) {
+		this->Cancel();
+		if (channels.empty() || volume_size.x <= 0 || volume_size.y <= 0 || volume_size.z <= 0) {
+			return;
+		}
+		this->StreamStart = std::chrono::system_clock::now();
+		this->VolumeSize = volume_size;
+		this->Channels = channels;
+		this->GridSize = (volume_size + glm::ivec3(this->BrickSize - 1)) / this->BrickSize;
+
+		// 從中心往外上傳，資料集換掉之後最先看到的是通常最重要的中間部分。
+		const unsigned int brick_count = (unsigned int)(this->GridSize.x * this->GridSize.y * this->GridSize.z);
+		const glm::vec3 center = glm::vec3(this->GridSize) * 0.5f;
+		std::vector<float> distances(brick_count);
+		this->BrickOrder.resize(brick_count);
+		for (unsigned int b = 0; b < brick_count; b++) {
+			glm::vec3 origin = glm::vec3(this->GetBrickOrigin(b) / this->BrickSize) + 0.5f;
+			glm::vec3 offset = origin - center;
+			distances[b] = glm::dot(offset, offset);
+			this->BrickOrder[b] = b;
+		}
+		std::stable_sort(this->BrickOrder.begin(), this->BrickOrder.end(), [&](unsigned int a, unsigned int b) { return distances[a] < distances[b]; });
+
+		// Ring 中每個 slot 要放得下最大的 brick（包含兩側各一個 voxel 的 apron）。
+		size_t capacity = 0;
+		const size_t slot_voxels = static_cast<size_t>(this->BrickSize + 2) * (this->BrickSize + 2) * (this->BrickSize + 2);
+		for (const VolumeStreamChannel& channel : this->Channels) {
+			capacity = std::max(capacity, slot_voxels * channel.BytesPerVoxel);
+		}
+		if (capacity != this->SlotCapacity) {
+			for (RingSlot& slot : this->Ring) {
+				this->AcquireSlot(slot, true);
+				if (slot.Buffer == 0) {
+					glGenBuffers(1, &slot.Buffer);
+				}
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.Buffer);
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			this->SlotCapacity = capacity;
+		}
+
+		this->Residency.assign(brick_count, 0);
+		this->ClearTextures();
+		this->UploadResidency();
+		Logger::Message(LOG_DEBUG, "Volume texture streaming started: " + std::to_string(brick_count) + " bricks of " + std::to_string(this->BrickSize) + "^3, "
+			+ std::to_string(this->Channels.size()) + " texture(s).");
+	}
+
+	bool VolumeTextureStreamer::Update() {
+		if (!this->GetIsStreaming()) {
+			return false;
+		}
+
+		auto start = std::chrono::system_clock::now();
+		const size_t first_brick = this->BrickCursor;
+		unsigned int upload_count = 0;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		while (this->BrickCursor < this->BrickOrder.size()) {
+			// 每個 frame 至少上傳一次，之後超過預算就留到下一個 frame。
+			if (upload_count > 0) {
+				double elapsed = std::chrono::duration<double, std::milli>(std::chrono::system_clock::now() - start).count();
+				if (elapsed >= this->BudgetMilliseconds) {
+					break;
+				}
+			}
+			RingSlot& slot = this->Ring[this->NextSlot];
+			if (!this->AcquireSlot(slot, false)) {
+				// GPU 還沒用完這個 slot，不等待，下一個 frame 再繼續。
+				break;
+			}
+
+			const VolumeStreamChannel& channel = this->Channels[this->ChannelCursor];
+			// 連同六個方向的鄰近 voxel 一起上傳，brick 內的 trilinear 取樣不需要還沒到的鄰居。
+			glm::ivec3 origin, extent;
+			this->GetBrickRegion(this->GetBrickOrigin(this->BrickOrder[this->BrickCursor]), 1, origin, extent);
+			const size_t bytes = static_cast<size_t>(extent.x) * extent.y * extent.z * channel.BytesPerVoxel;
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.Buffer);
+			// Fence 已經保證 GPU 不再讀取這個 slot，INVALIDATE 讓 driver 不必保留舊的內容。
+			void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+			if (destination == nullptr) {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				Logger::Message(LOG_ERROR, "Failed to map the pixel buffer for volume texture streaming.");
+				this->Cancel();
+				return false;
+			}
+			channel.Fill(origin, extent, static_cast<uint8_t*>(destination));
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+			glBindTexture(GL_TEXTURE_3D, channel.Texture);
+			glTexSubImage3D(GL_TEXTURE_3D, 0, origin.x, origin.y, origin.z, extent.x, extent.y, extent.z, channel.Format, channel.Type, (const void*)0);
+			glBindTexture(GL_TEXTURE_3D, 0);
+			slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			this->NextSlot = (this->NextSlot + 1) % RingSize;
+			upload_count++;
+
+			// 同一個 brick 的所有 texture 都送出之後才算完成；之後的 draw call 一定看得到這些資料，不需要等 fence。
+			if (++this->ChannelCursor == this->Channels.size()) {
+				this->Residency[this->BrickOrder[this->BrickCursor]] = 255;
+				this->ChannelCursor = 0;
+				this->BrickCursor++;
+			}
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		if (this->BrickCursor == first_brick) {
+			return false;
+		}
+		this->UploadResidency();
+		if (this->BrickCursor == this->BrickOrder.size()) {
+			this->StreamSeconds = std::chrono::duration<double>(std::chrono::system_clock::now() - this->StreamStart).count();
+			Logger::Message(LOG_DEBUG, "Volume texture streaming completed in " + std::to_string(this->StreamSeconds) + " seconds.");
+		}
+		return true;
+	}
+
+	void VolumeTextureStreamer::Cancel() {
+		// 已經送出的 glTexSubImage3D 仍然會完成，slot 的 fence 保留到下一次使用時再檢查。
+		this->Channels.clear();
+		this->BrickOrder.clear();
+		this->BrickCursor = 0;
+		this->ChannelCursor = 0;
+	}
+
+	void VolumeTextureStreamer::Release() {
+		this->Cancel();
+		for (RingSlot& slot : this->Ring) {
+			if (slot.Fence != 0) {
+				glDeleteSync(slot.Fence);
+			}
+			if (slot.Buffer != 0) {
+				glDeleteBuffers(1, &slot.Buffer);
+			}
+			slot = RingSlot();
+		}
+		this->SlotCapacity = 0;
+		if (this->ResidencyTexture != 0) {
+			glDeleteTextures(1, &this->ResidencyTexture);
+			this->ResidencyTexture = 0;
+			this->ResidencyTextureSize = glm::ivec3(0);
+		}
+	}
+
+	glm::ivec3 VolumeTextureStreamer::GetBrickOrigin(unsigned int brick) const {
+		int x = (int)(brick % this->GridSize.x);
+		int y = (int)((brick / this->GridSize.x) % this->GridSize.y);
+		int z = (int)(brick / (this->GridSize.x * this->GridSize.y));
+		return glm::ivec3(x, y, z) * this->BrickSize;
+	}
+
+	void VolumeTextureStreamer::GetBrickRegion(glm::ivec3 origin, int apron, glm::ivec3& region_origin, glm::ivec3& region_size) const {
+		region_origin = glm::max(origin - apron, glm::ivec3(0));
+		region_size = glm::min(origin + this->BrickSize + apron, this->VolumeSize) - region_origin;
+	}
+
+	bool VolumeTextureStreamer::AcquireSlot(RingSlot& slot, bool wait) {
+		if (slot.Fence == 0) {
+			return true;
+		}
+		GLenum result = glClientWaitSync(slot.Fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+		if (result == GL_TIMEOUT_EXPIRED) {
+			return false;
+		}
+		glDeleteSync(slot.Fence);
+		slot.Fence = 0;
+		return true;
+	}
+
+	void VolumeTextureStreamer::ClearTextures() {
+		// GL 3.3 沒有 glClearTexImage：把一個 slot 填成 0，所有 brick 都從它複製，整個過程只在 GPU 上進行。
+		RingSlot& slot = this->Ring[this->NextSlot];
+		this->AcquireSlot(slot, true);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.Buffer);
+		void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, this->SlotCapacity, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (destination != nullptr) {
+			std::memset(destination, 0, this->SlotCapacity);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			for (const VolumeStreamChannel& channel : this->Channels) {
+				glBindTexture(GL_TEXTURE_3D, channel.Texture);
+				for (unsigned int b = 0; b < this->BrickOrder.size(); b++) {
+					glm::ivec3 origin, extent;
+					this->GetBrickRegion(this->GetBrickOrigin(b), 0, origin, extent);
+					glTexSubImage3D(GL_TEXTURE_3D, 0, origin.x, origin.y, origin.z, extent.x, extent.y, extent.z, channel.Format, channel.Type, (const void*)0);
+				}
+			}
+			glBindTexture(GL_TEXTURE_3D, 0);
+			slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			this->NextSlot = (this->NextSlot + 1) % RingSize;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	void VolumeTextureStreamer::UploadResidency() {
+		if (this->ResidencyTexture == 0) {
+			glGenTextures(1, &this->ResidencyTexture);
+			this->ResidencyTextureSize = glm::ivec3(0);
+		}
+		glBindTexture(GL_TEXTURE_3D, this->ResidencyTexture);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		if (this->ResidencyTextureSize == this->GridSize) {
+			glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, this->GridSize.x, this->GridSize.y, this->GridSize.z, GL_RED, GL_UNSIGNED_BYTE, this->Residency.data());
+		} else {
+			glTexImage3D(GL_TEXTURE_3D, 0, GL_R8, this->GridSize.x, this->GridSize.y, this->GridSize.z, 0, GL_RED, GL_UNSIGNED_BYTE, this->Residency.data());
+			this->ResidencyTextureSize = this->GridSize;
+		}
+		glBindTexture(GL_TEXTURE_3D, 0);
+	}
+}